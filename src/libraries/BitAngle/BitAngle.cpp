@@ -0,0 +1,147 @@
+#include "BitAngle.h"
+
+/**
+ * BitAngle engine implementation
+ */
+
+// Single engine - there is only one Timer2
+BitAngleEngine BitAngle;
+
+// Estimated interrupt entry/exit cost not seen by measureIsr():
+// 4 response + 3 vector jump + register push/pop + 4 reti
+const uint16_t BAM_ISR_OVERHEAD_CYCLES = 40;
+
+// Shortest slot (1 tick at prescaler 256) and a whole frame, in CPU cycles
+const uint16_t BAM_TICK_CYCLES = 256;
+const uint32_t BAM_FRAME_CYCLES = 255UL * BAM_TICK_CYCLES;
+
+ISR(TIMER2_COMPA_vect) {
+  BitAngle.tick();
+}
+
+BitAngleEngine::BitAngleEngine() {
+  channelCount = 0;
+  activePlanes = 0;
+  swapPending = false;
+  currentBit = 0;
+  memset(portMask, 0, sizeof(portMask));
+  memset(level, 0, sizeof(level));
+  memset(planes, 0, sizeof(planes));
+}
+
+// Attach pins and start Timer2
+void BitAngleEngine::begin(const byte* pins, byte count) {
+  end();
+
+  channelCount = (count > BAM_MAX_CHANNELS) ? BAM_MAX_CHANNELS : count;
+  memset(portMask, 0, sizeof(portMask));
+  for (byte i = 0; i < channelCount; i++) {
+    channelPin[i] = pins[i];
+    level[i] = 0;
+    FastPort port = fastPinPort(pins[i]);
+    if (port != FAST_PORT_NONE) {
+      portMask[port] |= fastPinMask(pins[i]);
+    }
+  }
+
+  // Start dark
+  memset(planes, 0, sizeof(planes));
+  currentBit = BAM_BITS - 1;   // First tick shows slot 0
+  swapPending = false;
+
+  uint8_t oldSREG = SREG;
+  cli();
+  DDRB |= portMask[FAST_PORT_B];
+  DDRC |= portMask[FAST_PORT_C];
+  DDRD |= portMask[FAST_PORT_D];
+
+  // Timer2: CTC mode, prescaler 256 (16 us per tick)
+  TCCR2A = (1 << WGM21);
+  TCCR2B = (1 << CS22) | (1 << CS21);
+  TCNT2 = 0;
+  OCR2A = 0;
+  TIMSK2 |= (1 << OCIE2A);
+  SREG = oldSREG;
+}
+
+// Stop the timer and turn every attached pin off
+void BitAngleEngine::end() {
+  uint8_t oldSREG = SREG;
+  cli();
+  TIMSK2 &= ~(1 << OCIE2A);
+  PORTB &= ~portMask[FAST_PORT_B];
+  PORTC &= ~portMask[FAST_PORT_C];
+  PORTD &= ~portMask[FAST_PORT_D];
+  SREG = oldSREG;
+}
+
+void BitAngleEngine::setLevel(byte channel, byte value) {
+  if (channel < channelCount) {
+    level[channel] = value;
+  }
+}
+
+byte BitAngleEngine::getLevel(byte channel) {
+  return (channel < channelCount) ? level[channel] : 0;
+}
+
+byte BitAngleEngine::count() {
+  return channelCount;
+}
+
+// Rebuild the bit planes - O(channels x bits), runs in the main loop
+void BitAngleEngine::commit() {
+  // Claim the spare buffer: if an earlier commit has not been shown
+  // yet, cancel it so the ISR cannot swap while we rewrite it
+  uint8_t oldSREG = SREG;
+  cli();
+  swapPending = false;
+  byte target = activePlanes ^ 1;
+  SREG = oldSREG;
+
+  byte (*plane)[BAM_PORTS] = planes[target];
+  memset(plane, 0, sizeof(planes[0]));
+
+  for (byte i = 0; i < channelCount; i++) {
+    FastPort port = fastPinPort(channelPin[i]);
+    if (port == FAST_PORT_NONE) {
+      continue;
+    }
+    byte mask = fastPinMask(channelPin[i]);
+    byte value = level[i];
+    for (byte b = 0; value != 0; b++, value >>= 1) {
+      if (value & 1) {
+        plane[b][port] |= mask;
+      }
+    }
+  }
+
+  // cli() doubles as a memory barrier: the planes are fully written
+  // before the ISR can see the flag
+  oldSREG = SREG;
+  cli();
+  swapPending = true;
+  SREG = oldSREG;
+}
+
+// Run the ISR body many times with the timer interrupt masked and time it
+BamIsrStats BitAngleEngine::measureIsr() {
+  const uint16_t RUNS = 1000;
+
+  uint8_t oldMask = TIMSK2;
+  TIMSK2 &= ~(1 << OCIE2A);
+
+  unsigned long start = micros();
+  for (uint16_t i = 0; i < RUNS; i++) {
+    tick();
+  }
+  unsigned long elapsed = micros() - start;
+
+  TIMSK2 = oldMask;
+
+  BamIsrStats stats;
+  stats.isrCycles = (uint16_t)((elapsed * (F_CPU / 1000000UL)) / RUNS) + BAM_ISR_OVERHEAD_CYCLES;
+  stats.slotCycles = BAM_TICK_CYCLES;
+  stats.loadPermille = (uint16_t)(((uint32_t)stats.isrCycles * BAM_BITS * 1000UL) / BAM_FRAME_CYCLES);
+  return stats;
+}
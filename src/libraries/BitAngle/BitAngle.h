@@ -0,0 +1,93 @@
+#ifndef BIT_ANGLE_H
+#define BIT_ANGLE_H
+
+#include <Arduino.h>
+#include <FastPins.h>
+
+/**
+ * BitAngle - Timer2 bit-angle modulation (BAM) for brightness on any pin
+ *
+ * analogWrite() only works on the 6 hardware PWM pins. BAM gives every
+ * output pin 8-bit brightness in software:
+ * - Each frame is split into 8 time slots, slot b lasting 2^b ticks
+ * - During slot b a pin is on if bit b of its brightness is set
+ * - Bit planes (one byte per port per bit) are prepared in the main
+ *   loop, so the ISR only copies 3 bytes to the ports and reloads the
+ *   timer: its cost depends on the number of bits, not on the number
+ *   of LEDs or brightness levels
+ *
+ * Timing (16 MHz, Timer2 prescaler 256):
+ * - 1 tick = 16 us = 256 CPU cycles (shortest slot)
+ * - 1 frame = 255 ticks = 4.08 ms (~245 Hz refresh, no visible flicker)
+ * - 8 interrupts per frame
+ *
+ * Uses Timer2, so analogWrite() on pins 3/11 and tone() are unavailable.
+ */
+
+const byte BAM_BITS = 8;
+const byte BAM_MAX_CHANNELS = 20;   // Every UNO header pin
+const byte BAM_PORTS = 3;           // Indexed by FastPort (B, C, D)
+
+// ISR cost measurement returned by measureIsr()
+struct BamIsrStats {
+  uint16_t isrCycles;     // Measured cycles per interrupt (body + entry/exit estimate)
+  uint16_t slotCycles;    // Cycles in the shortest slot (the hard budget)
+  uint16_t loadPermille;  // Share of CPU time spent in the ISR (per mille)
+};
+
+class BitAngleEngine {
+  private:
+    // Channel configuration
+    byte channelPin[BAM_MAX_CHANNELS];
+    byte level[BAM_MAX_CHANNELS];
+    byte channelCount;
+    byte portMask[BAM_PORTS];   // Port bits owned by the engine
+
+    // Double-buffered bit planes: the ISR shows one, commit() fills the other
+    byte planes[2][BAM_BITS][BAM_PORTS];
+    volatile byte activePlanes;   // Buffer the ISR is reading
+    volatile bool swapPending;    // Other buffer is ready to show
+    volatile byte currentBit;     // Slot being shown
+
+  public:
+    BitAngleEngine();
+
+    // Attach pins (channel i = pins[i]), configure Timer2 and start
+    void begin(const byte* pins, byte count);
+    void end();
+
+    // Brightness of one channel (0-255), shown after the next commit()
+    void setLevel(byte channel, byte value);
+    byte getLevel(byte channel);
+    byte count();
+
+    // Rebuild the bit planes from the levels and hand them to the ISR
+    void commit();
+
+    // Time the ISR body and report it against the slot budget
+    BamIsrStats measureIsr();
+
+    // Called from the Timer2 compare interrupt - advance to the next slot
+    inline void tick() {
+      byte b = (currentBit + 1) & (BAM_BITS - 1);
+      currentBit = b;
+
+      // Swap buffers only at a frame boundary so a frame is never torn
+      if (b == 0 && swapPending) {
+        activePlanes ^= 1;
+        swapPending = false;
+      }
+
+      const byte* plane = planes[activePlanes][b];
+      PORTB = (PORTB & (byte)~portMask[FAST_PORT_B]) | plane[FAST_PORT_B];
+      PORTC = (PORTC & (byte)~portMask[FAST_PORT_C]) | plane[FAST_PORT_C];
+      PORTD = (PORTD & (byte)~portMask[FAST_PORT_D]) | plane[FAST_PORT_D];
+
+      // Slot b lasts 2^b ticks (CTC period is OCR2A + 1)
+      OCR2A = (1 << b) - 1;
+    }
+};
+
+extern BitAngleEngine BitAngle;
+
+#endif
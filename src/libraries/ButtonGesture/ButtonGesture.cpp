@@ -0,0 +1,87 @@
+#include "ButtonGesture.h"
+
+/**
+ * ButtonGesture state machine
+ */
+
+ButtonGesture::ButtonGesture(const GestureTiming& buttonTiming) {
+  timing = buttonTiming;
+  reset();
+}
+
+void ButtonGesture::reset() {
+  state = IDLE;
+  since = 0;
+  nextRepeat = 0;
+}
+
+GestureEvent ButtonGesture::update(bool pressed, uint32_t now) {
+  uint32_t elapsed = now - since;
+
+  switch (state) {
+    case IDLE:
+      if (pressed) {
+        state = PRESSED;
+        since = now;
+      }
+      break;
+
+    case PRESSED:
+      if (!pressed) {
+        // Short press: a click now, or wait to see if a second one follows
+        since = now;
+        if (timing.doubleClickMs == 0) {
+          state = IDLE;
+          return GESTURE_CLICK;
+        }
+        state = CLICK_PENDING;
+      } else if (timing.longPressMs != 0 && elapsed >= timing.longPressMs) {
+        state = HELD;
+        nextRepeat = now + timing.repeatDelayMs;
+        return GESTURE_LONG_PRESS;
+      }
+      break;
+
+    case CLICK_PENDING:
+      if (elapsed >= timing.doubleClickMs) {
+        // Too late for a double-click; a press now starts a new gesture
+        state = pressed ? PRESSED : IDLE;
+        since = now;
+        return GESTURE_CLICK;
+      }
+      if (pressed) {
+        state = WAIT_RELEASE;
+        return GESTURE_DOUBLE_CLICK;
+      }
+      break;
+
+    case HELD:
+      if (!pressed) {
+        state = IDLE;
+      } else if (timing.repeatDelayMs != 0 && timing.repeatIntervalMs != 0 &&
+                 (int32_t)(now - nextRepeat) >= 0) {
+        nextRepeat += timing.repeatIntervalMs;
+        return GESTURE_REPEAT;
+      }
+      break;
+
+    case WAIT_RELEASE:
+      if (!pressed) {
+        state = IDLE;
+      }
+      break;
+  }
+  return GESTURE_NONE;
+}
+
+void ButtonGesture::setTiming(const GestureTiming& buttonTiming) {
+  timing = buttonTiming;
+}
+
+const GestureTiming& ButtonGesture::getTiming() const {
+  return timing;
+}
+
+bool ButtonGesture::isHeld() const {
+  return state == PRESSED || state == HELD || state == WAIT_RELEASE;
+}
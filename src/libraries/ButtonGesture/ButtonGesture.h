@@ -0,0 +1,87 @@
+#ifndef BUTTON_GESTURE_H
+#define BUTTON_GESTURE_H
+
+#include <Arduino.h>
+
+/**
+ * ButtonGesture - Click, double-click, long-press and auto-repeat
+ *
+ * Turns a debounced button state into gestures without ever waiting for
+ * the button: poll it every pass of loop() with the current state and
+ * millis(), and act on whatever it returns:
+ *
+ *   ButtonGesture button;                  // Default timing
+ *   ...
+ *   switch (button.update(buttonState == LOW, millis())) {
+ *     case GESTURE_CLICK:        ...
+ *     case GESTURE_DOUBLE_CLICK: ...
+ *     case GESTURE_LONG_PRESS:   ...   // Held for longPressMs
+ *     case GESTURE_REPEAT:       ...   // Still held, every repeatIntervalMs
+ *     default: break;
+ *   }
+ *
+ * Each update() is a single state machine step: a few comparisons, the
+ * same cost whatever the button is doing. It reports at most one
+ * gesture per call.
+ *
+ * A click is only reported once doubleClickMs has passed without a
+ * second press (otherwise it might be the first half of a double-click).
+ * Set doubleClickMs to 0 for buttons that do not need double-clicks and
+ * clicks are reported on release. A press that has become a long press
+ * never also reports a click.
+ *
+ * Input should already be debounced; feed the debouncer's state, not the
+ * raw pin.
+ */
+
+// Per-button timing (milliseconds); 0 disables that gesture (either
+// repeat time at 0 turns auto-repeat off)
+struct GestureTiming {
+  uint16_t doubleClickMs;     // Longest gap between the clicks of a double-click
+  uint16_t longPressMs;       // Hold time for a long press
+  uint16_t repeatDelayMs;     // From the long press to the first repeat
+  uint16_t repeatIntervalMs;  // Between repeats while still held
+};
+
+const GestureTiming GESTURE_DEFAULT_TIMING = {300, 1000, 500, 200};
+
+enum GestureEvent : byte {
+  GESTURE_NONE,
+  GESTURE_CLICK,
+  GESTURE_DOUBLE_CLICK,
+  GESTURE_LONG_PRESS,
+  GESTURE_REPEAT
+};
+
+class ButtonGesture {
+  private:
+    enum State : byte {
+      IDLE,           // Released, nothing pending
+      PRESSED,        // First press down, not yet long
+      CLICK_PENDING,  // Released after a short press; waiting for a second
+      HELD,           // Long press reported, repeating while held
+      WAIT_RELEASE    // Gesture reported, ignore until released
+    };
+
+    GestureTiming timing;
+    State state;
+    uint32_t since;       // When the current state started (ms)
+    uint32_t nextRepeat;  // Next auto-repeat (ms)
+
+  public:
+    explicit ButtonGesture(const GestureTiming& buttonTiming = GESTURE_DEFAULT_TIMING);
+
+    // One step: pressed = debounced button state, now = millis()
+    GestureEvent update(bool pressed, uint32_t now);
+
+    void setTiming(const GestureTiming& buttonTiming);
+    const GestureTiming& getTiming() const;
+
+    // Drop anything in progress (the next press starts fresh)
+    void reset();
+
+    // Button is down as far as the recognizer knows
+    bool isHeld() const;
+};
+
+#endif
@@ -0,0 +1,265 @@
+#ifndef COOP_SCHEDULER_H
+#define COOP_SCHEDULER_H
+
+#include <Arduino.h>
+
+/**
+ * CoopScheduler - Deadline-ordered cooperative task scheduler
+ *
+ * Instead of every part of a sketch checking millis() on every loop()
+ * pass, tasks are registered once with a period (or a single delay) and
+ * run() calls only the ones that are due:
+ *
+ *   void blink(void* context) { ... }
+ *   CoopScheduler<4> scheduler;
+ *   TaskId blinkTask = scheduler.every(500, blink);
+ *   ...
+ *   void loop() {
+ *     uint32_t idleMs = scheduler.run();   // ms until the next deadline
+ *   }
+ *
+ * Pending deadlines are kept in a fixed-size binary min-heap, so finding
+ * the next one is O(1) and (re)scheduling is O(log n) with no dynamic
+ * memory. Deadlines are compared as signed differences, so millis()
+ * rolling over after ~49.7 days is harmless as long as no delay exceeds
+ * 2^31 ms.
+ *
+ * Periodic tasks keep their phase (the next deadline is the previous
+ * one plus the period); a task that falls more than a period behind is
+ * moved to now + period instead of running several times to catch up.
+ * Tasks run from loop(), never from an interrupt, and may schedule,
+ * reschedule or cancel any task (including themselves).
+ */
+
+typedef void (*TaskCallback)(void* context);
+
+typedef byte TaskId;
+const TaskId TASK_NONE = 0xFF;
+
+// run() result when nothing is scheduled
+const uint32_t SCHEDULER_IDLE_FOREVER = 0xFFFFFFFFUL;
+
+template <byte MaxTasks>
+class CoopScheduler {
+  static_assert(MaxTasks >= 1 && MaxTasks < TASK_NONE,
+                "CoopScheduler supports 1 to 254 tasks");
+
+  private:
+    struct Task {
+      TaskCallback callback;
+      void* context;
+      uint32_t deadline;    // millis() value the task is due at
+      uint32_t period;      // 0 = one-shot
+      bool used;            // Slot holds a task (scheduled or not)
+    };
+
+    Task tasks[MaxTasks];
+    byte heap[MaxTasks];       // Task ids ordered by deadline (heap[0] is next)
+    byte heapIndex[MaxTasks];  // Position of each task in heap (TASK_NONE if not queued)
+    byte heapSize;
+    uint16_t lateRuns;         // Periodic runs that had fallen a whole period behind
+
+    // a is due no later than b (rollover-safe)
+    static bool before(uint32_t a, uint32_t b) {
+      return (int32_t)(a - b) < 0;
+    }
+
+    static bool due(uint32_t deadline, uint32_t now) {
+      return (int32_t)(deadline - now) <= 0;
+    }
+
+    void place(byte position, byte id) {
+      heap[position] = id;
+      heapIndex[id] = position;
+    }
+
+    void siftUp(byte position) {
+      byte id = heap[position];
+      while (position > 0) {
+        byte parent = (position - 1) / 2;
+        if (!before(tasks[id].deadline, tasks[heap[parent]].deadline)) {
+          break;
+        }
+        place(position, heap[parent]);
+        position = parent;
+      }
+      place(position, id);
+    }
+
+    void siftDown(byte position) {
+      byte id = heap[position];
+      while (true) {
+        byte child = 2 * position + 1;
+        if (child >= heapSize) {
+          break;
+        }
+        if (child + 1 < heapSize &&
+            before(tasks[heap[child + 1]].deadline, tasks[heap[child]].deadline)) {
+          child++;
+        }
+        if (!before(tasks[heap[child]].deadline, tasks[id].deadline)) {
+          break;
+        }
+        place(position, heap[child]);
+        position = child;
+      }
+      place(position, id);
+    }
+
+    void enqueue(TaskId id) {
+      place(heapSize, id);
+      heapSize++;
+      siftUp(heapSize - 1);
+    }
+
+    void dequeue(TaskId id) {
+      byte position = heapIndex[id];
+      if (position == TASK_NONE) {
+        return;
+      }
+      heapIndex[id] = TASK_NONE;
+      heapSize--;
+      if (position == heapSize) {
+        return;
+      }
+      // Move the last entry into the hole and restore the order
+      byte moved = heap[heapSize];
+      place(position, moved);
+      siftDown(position);
+      siftUp(heapIndex[moved]);
+    }
+
+    TaskId add(uint32_t delayMs, uint32_t periodMs, TaskCallback callback, void* context) {
+      if (callback == NULL) {
+        return TASK_NONE;
+      }
+      for (TaskId id = 0; id < MaxTasks; id++) {
+        if (!tasks[id].used) {
+          tasks[id].callback = callback;
+          tasks[id].context = context;
+          tasks[id].period = periodMs;
+          tasks[id].deadline = millis() + delayMs;
+          tasks[id].used = true;
+          enqueue(id);
+          return id;
+        }
+      }
+      return TASK_NONE;
+    }
+
+  public:
+    CoopScheduler() {
+      heapSize = 0;
+      lateRuns = 0;
+      for (TaskId id = 0; id < MaxTasks; id++) {
+        tasks[id].used = false;
+        heapIndex[id] = TASK_NONE;
+      }
+    }
+
+    // Run callback every periodMs, first after firstDelayMs
+    TaskId every(uint32_t periodMs, TaskCallback callback, void* context = NULL,
+                 uint32_t firstDelayMs = 0) {
+      if (periodMs == 0) {
+        return TASK_NONE;
+      }
+      return add(firstDelayMs, periodMs, callback, context);
+    }
+
+    // Run callback once, delayMs from now (the slot is freed when it runs)
+    TaskId after(uint32_t delayMs, TaskCallback callback, void* context = NULL) {
+      return add(delayMs, 0, callback, context);
+    }
+
+    // Move a task's next run to delayMs from now (re-arms a finished one-shot)
+    bool reschedule(TaskId id, uint32_t delayMs) {
+      if (id >= MaxTasks || !tasks[id].used) {
+        return false;
+      }
+      dequeue(id);
+      tasks[id].deadline = millis() + delayMs;
+      enqueue(id);
+      return true;
+    }
+
+    // Change the period; takes effect from the next run
+    bool setPeriod(TaskId id, uint32_t periodMs) {
+      if (id >= MaxTasks || !tasks[id].used || periodMs == 0) {
+        return false;
+      }
+      tasks[id].period = periodMs;
+      return true;
+    }
+
+    // Remove a task and free its slot
+    bool cancel(TaskId id) {
+      if (id >= MaxTasks || !tasks[id].used) {
+        return false;
+      }
+      dequeue(id);
+      tasks[id].used = false;
+      return true;
+    }
+
+    bool isScheduled(TaskId id) {
+      return id < MaxTasks && tasks[id].used && heapIndex[id] != TASK_NONE;
+    }
+
+    // Run every task that is due, then return the milliseconds until the
+    // next deadline (0 if something is already due again,
+    // SCHEDULER_IDLE_FOREVER if nothing is scheduled)
+    uint32_t run() {
+      uint32_t now = millis();
+
+      // Bounded so a task that keeps re-arming itself with a zero delay
+      // cannot hold loop() here
+      for (byte ran = 0; ran < MaxTasks && heapSize > 0; ran++) {
+        TaskId id = heap[0];
+        Task& task = tasks[id];
+        if (!due(task.deadline, now)) {
+          break;
+        }
+
+        // Update the schedule before the callback, so the callback sees
+        // (and may change) its own next run
+        TaskCallback callback = task.callback;
+        void* context = task.context;
+        if (task.period > 0) {
+          task.deadline += task.period;
+          if (due(task.deadline, now)) {
+            task.deadline = now + task.period;
+            lateRuns++;
+          }
+          siftDown(0);
+        } else {
+          dequeue(id);
+          task.used = false;
+        }
+
+        callback(context);
+      }
+
+      return nextDeadlineIn();
+    }
+
+    // Milliseconds until the earliest deadline
+    uint32_t nextDeadlineIn() {
+      if (heapSize == 0) {
+        return SCHEDULER_IDLE_FOREVER;
+      }
+      int32_t remaining = (int32_t)(tasks[heap[0]].deadline - millis());
+      return (remaining > 0) ? (uint32_t)remaining : 0;
+    }
+
+    // Tasks currently queued
+    byte pending() {
+      return heapSize;
+    }
+
+    // Periodic runs pushed back because they were a whole period late
+    uint16_t lateCount() {
+      return lateRuns;
+    }
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef CYCLE_MARKER_H
+#define CYCLE_MARKER_H
+
+#include <Arduino.h>
+
+/**
+ * CycleMarker - Marker points for cycle-exact benchmarks in simavr
+ *
+ * Marks the start and end of a hot path by writing a marker id to
+ * GPIOR0, a general purpose I/O register nothing else uses:
+ *
+ *   void updateLeds() {
+ *     CYCLE_MARK_SCOPE(MARK_UPDATE_LEDS);
+ *     ...
+ *   }
+ *
+ * tools/avrbench runs the firmware in simavr, watches GPIOR0 writes and
+ * counts the CPU cycles between the begin (id) and end (id | 0x80)
+ * writes of each marker. A marker write is one OUT instruction (plus
+ * loading the id), and CYCLE_MARK_CALIBRATE() in setup() lets the
+ * harness measure and subtract that cost.
+ *
+ * Markers only exist when the firmware is built with -DCYCLE_MARKERS=1
+ * (the uno_bench environments); otherwise every macro compiles to
+ * nothing. Ids are 1-127 and only need to be unique within a sketch;
+ * id 0 is the calibration marker.
+ */
+
+#ifndef CYCLE_MARKERS
+#define CYCLE_MARKERS 0
+#endif
+
+const byte CYCLE_MARK_END_FLAG = 0x80;
+
+#if CYCLE_MARKERS
+
+// The empty asm statements stop the compiler moving memory accesses
+// across a marker
+inline void cycleMarkBegin(byte id) {
+  asm volatile("" ::: "memory");
+  GPIOR0 = id;
+  asm volatile("" ::: "memory");
+}
+
+inline void cycleMarkEnd(byte id) {
+  asm volatile("" ::: "memory");
+  GPIOR0 = id | CYCLE_MARK_END_FLAG;
+  asm volatile("" ::: "memory");
+}
+
+// Marks from construction to the end of the enclosing block
+class CycleMarkScope {
+  private:
+    byte id;
+
+  public:
+    explicit CycleMarkScope(byte markerId) : id(markerId) {
+      cycleMarkBegin(id);
+    }
+
+    ~CycleMarkScope() {
+      cycleMarkEnd(id);
+    }
+};
+
+#define CYCLE_MARK_BEGIN(id) cycleMarkBegin(id)
+#define CYCLE_MARK_END(id) cycleMarkEnd(id)
+#define CYCLE_MARK_SCOPE(id) CycleMarkScope cycleMarkScope_##id(id)
+#define CYCLE_MARK_CALIBRATE() do { cycleMarkBegin(0); cycleMarkEnd(0); } while (0)
+
+#else
+
+#define CYCLE_MARK_BEGIN(id) do {} while (0)
+#define CYCLE_MARK_END(id) do {} while (0)
+#define CYCLE_MARK_SCOPE(id) do {} while (0)
+#define CYCLE_MARK_CALIBRATE() do {} while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,311 @@
+#ifndef DEBOUNCER_H
+#define DEBOUNCER_H
+
+#include <Arduino.h>
+#include <FastPins.h>
+
+/**
+ * Debouncer - One debounced button, fixed at compile time
+ *
+ * The sketches each carried their own copy of the lastButtonState /
+ * lastDebounceTime / debounceDelay block, with a full digitalRead() per
+ * poll and the state spread over several ints. This template takes the
+ * pin and the strategy as parameters instead:
+ *
+ *   Debouncer<BUTTON_PIN> button;                              // 50 ms window
+ *   Debouncer<BUTTON_PIN, DebounceIntegrator<10> > button;     // 10 polls
+ *
+ *   button.begin();                          // INPUT_PULLUP
+ *   if (button.update() == DEBOUNCE_PRESSED) { ... }
+ *
+ * - The pin's port and bit are worked out by the compiler (FastPins), so
+ *   a read is one load of PINB/PINC/PIND and a bit test
+ * - Each strategy keeps its state packed: 3 bytes for the time window,
+ *   1 byte for the integrator and the vertical counter
+ * - millis() is only read by strategies that need it
+ *
+ * Strategies:
+ * - DebounceTimeWindow<Ms>: accept a level once the reading has not
+ *   changed for more than Ms milliseconds. Works at any polling rate
+ * - DebounceIntegrator<N>: accept after N readings in a row that differ
+ *   from the debounced level. Poll at a fixed rate (N x period = window)
+ * - DebounceVerticalCounter: PortDebouncer's 2-bit counter for a single
+ *   pin (accepts after 4 readings). For several buttons on one port use
+ *   PortDebouncer, which runs 8 of these in parallel
+ *
+ * The first two are thin wrappers over DebounceWindow and DebounceCount,
+ * which take the window or count at run time and can be used on their
+ * own with any tick source.
+ *
+ * Buttons are wired with the pull-up: LOW is pressed.
+ */
+
+enum DebounceEdge : byte {
+  DEBOUNCE_NONE,
+  DEBOUNCE_PRESSED,
+  DEBOUNCE_RELEASED
+};
+
+// Time-window logic with the window passed in at each update, for
+// callers that change it at run time (button_debouncing's TimeDebouncer).
+// Time is the tick type; uint16_t (the low bits of millis() or a sample
+// tick) is enough as long as update() runs at least every 32768
+// ticks, and keeps the state and the comparison narrow on the AVR
+template <typename Time>
+class DebounceWindow {
+  private:
+    static const byte LEVEL = 0x01;     // Debounced level
+    static const byte READING = 0x02;   // Last raw reading
+
+    byte flags;
+    Time lastChange;                    // Tick of the last raw change
+
+  public:
+    void reset(bool level) {
+      flags = level ? (LEVEL | READING) : 0;
+      lastChange = 0;
+    }
+
+    // Feed one reading; true when the debounced level changes
+    inline bool update(bool reading, Time now, Time window) {
+      byte differs = flags ^ (reading ? (LEVEL | READING) : 0);
+      if (differs & READING) {
+        flags ^= READING;
+        lastChange = now;
+      }
+      if ((differs & LEVEL) && (Time)(now - lastChange) > window) {
+        flags ^= LEVEL;
+        return true;
+      }
+      return false;
+    }
+
+    inline bool level() const {
+      return flags & LEVEL;
+    }
+
+    // Nothing pending: the last reading matches the debounced level
+    inline bool isSettled() const {
+      return (bool)(flags & READING) == level();
+    }
+
+    // Ticks until a pending change can be accepted (0 if due or settled)
+    Time remaining(Time now, Time window) const {
+      Time elapsed = now - lastChange;
+      return (isSettled() || elapsed > window) ? 0 : window + 1 - elapsed;
+    }
+};
+
+// Accept a level after the reading has been stable for more than WindowMs
+template <uint16_t WindowMs = 50>
+class DebounceTimeWindow {
+  static_assert(WindowMs < 0x8000, "Debounce window must fit 16-bit millis()");
+
+  private:
+    DebounceWindow<uint16_t> window;    // millis() (low 16 bits)
+
+  public:
+    static const bool USES_TIME = true;
+
+    void reset(bool level) {
+      window.reset(level);
+    }
+
+    inline bool update(bool reading, uint16_t now) {
+      return window.update(reading, now, WindowMs);
+    }
+
+    inline bool level() const {
+      return window.level();
+    }
+
+    inline bool isSettled() const {
+      return window.isSettled();
+    }
+
+    // Milliseconds until a pending change can be accepted (0 if due or settled)
+    uint16_t remaining(uint16_t now) const {
+      return window.remaining(now, WindowMs);
+    }
+};
+
+// Integrator logic with the count passed in at each update (1-127), for
+// callers that choose it at run time (button_debouncing's CounterDebouncer)
+class DebounceCount {
+  private:
+    static const byte LEVEL = 0x01;     // Debounced level; bits 1-7 count
+    static const byte COUNT_ONE = 0x02;
+
+    byte packed;
+
+  public:
+    static const byte MAX_SAMPLES = 127;
+
+    void reset(bool level) {
+      packed = level;
+    }
+
+    // reading is 0 or 1 (LOW/HIGH or a bool)
+    inline bool update(byte reading, byte samples) {
+      byte next = reading;
+      if (reading != level()) {
+        next = packed + COUNT_ONE;
+        if ((next >> 1) >= samples) {
+          packed = reading;
+          return true;
+        }
+      }
+      packed = next;
+      return false;
+    }
+
+    inline bool level() const {
+      return packed & LEVEL;
+    }
+
+    inline bool isSettled() const {
+      return packed < COUNT_ONE;
+    }
+};
+
+// Accept after Samples readings in a row that differ from the level
+template <byte Samples = 5>
+class DebounceIntegrator {
+  static_assert(Samples >= 1 && Samples <= DebounceCount::MAX_SAMPLES,
+                "Integrator counts 1-127 readings");
+
+  private:
+    DebounceCount count;
+
+  public:
+    static const bool USES_TIME = false;
+
+    void reset(bool level) {
+      count.reset(level);
+    }
+
+    inline bool update(bool reading, uint16_t) {
+      return count.update(reading, Samples);
+    }
+
+    inline bool level() const {
+      return count.level();
+    }
+
+    inline bool isSettled() const {
+      return count.isSettled();
+    }
+};
+
+// PortDebouncer's vertical counter for one pin: a 2-bit counter that
+// advances on each disagreeing reading and accepts when it wraps (4)
+class DebounceVerticalCounter {
+  private:
+    static const byte LEVEL = 0x01;
+    static const byte COUNT0 = 0x02;
+    static const byte COUNT1 = 0x04;
+
+    byte bits;
+
+  public:
+    static const bool USES_TIME = false;
+
+    void reset(bool level) {
+      bits = level ? LEVEL : 0;
+    }
+
+    inline bool update(bool reading, uint16_t) {
+      // All 0 or all 1: does the reading disagree with the level?
+      byte delta = (reading != level()) ? 0xFF : 0x00;
+      byte count0 = (bits & COUNT0) ? 0xFF : 0x00;
+      byte count1 = (bits & COUNT1) ? 0xFF : 0x00;
+
+      count1 = (count1 ^ count0) & delta;
+      count0 = (byte)~count0 & delta;
+      bool toggle = delta & (byte)~(count0 | count1);
+
+      bits = (bits & LEVEL) ^ (toggle ? LEVEL : 0);
+      bits |= (count0 & COUNT0) | (count1 & COUNT1);
+      return toggle;
+    }
+
+    inline bool level() const {
+      return bits & LEVEL;
+    }
+
+    inline bool isSettled() const {
+      return (bits & (COUNT0 | COUNT1)) == 0;
+    }
+};
+
+template <byte Pin, class Strategy = DebounceTimeWindow<50> >
+class Debouncer {
+  static_assert(fastPinPort(Pin) != FAST_PORT_NONE, "Debouncer pin must be 0-19");
+
+  private:
+    static const FastPort PORT = fastPinPort(Pin);
+    static const byte MASK = fastPinMask(Pin);
+
+    Strategy strategy;
+
+  public:
+    Debouncer() {
+      strategy.reset(HIGH);
+    }
+
+    // Input with pull-up. The debounced state starts released, so a
+    // button already held at power-up reports a press once it is stable
+    // (the pull-up also needs a moment before the pin reads HIGH).
+    void begin() {
+      uint8_t oldSREG = SREG;
+      cli();
+      if (PORT == FAST_PORT_B) {
+        DDRB &= (byte)~MASK;
+        PORTB |= MASK;
+      } else if (PORT == FAST_PORT_C) {
+        DDRC &= (byte)~MASK;
+        PORTC |= MASK;
+      } else {
+        DDRD &= (byte)~MASK;
+        PORTD |= MASK;
+      }
+      SREG = oldSREG;
+      strategy.reset(HIGH);
+    }
+
+    // Raw pin level (one register read)
+    static inline bool read() {
+      return (PORT == FAST_PORT_B ? PINB : PORT == FAST_PORT_C ? PINC : PIND) & MASK;
+    }
+
+    // Poll once; reports a debounced press or release
+    inline DebounceEdge update() {
+      bool reading = read();
+      uint16_t now = Strategy::USES_TIME ? (uint16_t)millis() : 0;
+      if (!strategy.update(reading, now)) {
+        return DEBOUNCE_NONE;
+      }
+      return strategy.level() ? DEBOUNCE_RELEASED : DEBOUNCE_PRESSED;
+    }
+
+    // Debounced state
+    inline bool isPressed() const {
+      return !strategy.level();
+    }
+
+    inline bool level() const {
+      return strategy.level();
+    }
+
+    // No change in progress (safe to sleep until the pin changes)
+    inline bool isSettled() const {
+      return strategy.isSettled();
+    }
+
+    // Time-window strategy only: ms until a pending change is due
+    uint16_t remainingMs() const {
+      return strategy.remaining((uint16_t)millis());
+    }
+};
+
+#endif
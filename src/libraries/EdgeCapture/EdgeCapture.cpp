@@ -0,0 +1,123 @@
+#include "EdgeCapture.h"
+
+/**
+ * EdgeCapture implementation
+ */
+
+EdgeCaptureEngine EdgeCapture;
+
+ISR(INT0_vect) {
+  EdgeCapture.handleExternal(2);
+}
+
+ISR(INT1_vect) {
+  EdgeCapture.handleExternal(3);
+}
+
+ISR(PCINT0_vect) {
+  EdgeCapture.handlePinChange(FAST_PORT_B, PINB);
+}
+
+ISR(PCINT1_vect) {
+  EdgeCapture.handlePinChange(FAST_PORT_C, PINC);
+}
+
+ISR(PCINT2_vect) {
+  EdgeCapture.handlePinChange(FAST_PORT_D, PIND);
+}
+
+EdgeCaptureEngine::EdgeCaptureEngine() {
+  memset(watchMask, 0, sizeof(watchMask));
+  memset(lastLevels, 0, sizeof(lastLevels));
+}
+
+bool EdgeCaptureEngine::begin(byte pin) {
+  FastPort port = fastPinPort(pin);
+  if (port == FAST_PORT_NONE) {
+    return false;
+  }
+
+  uint8_t oldSREG = SREG;
+  cli();
+  if (pin == 2) {
+    // INT0 on any logical change
+    EICRA = (EICRA & ~(1 << ISC01)) | (1 << ISC00);
+    EIFR = (1 << INTF0);
+    EIMSK |= (1 << INT0);
+  } else if (pin == 3) {
+    // INT1 on any logical change
+    EICRA = (EICRA & ~(1 << ISC11)) | (1 << ISC10);
+    EIFR = (1 << INTF1);
+    EIMSK |= (1 << INT1);
+  } else {
+    byte mask = fastPinMask(pin);
+    watchMask[port] |= mask;
+    switch (port) {
+      case FAST_PORT_B:
+        lastLevels[port] = PINB;
+        PCMSK0 |= mask;
+        PCIFR = (1 << PCIF0);
+        PCICR |= (1 << PCIE0);
+        break;
+      case FAST_PORT_C:
+        lastLevels[port] = PINC;
+        PCMSK1 |= mask;
+        PCIFR = (1 << PCIF1);
+        PCICR |= (1 << PCIE1);
+        break;
+      default:
+        lastLevels[port] = PIND;
+        PCMSK2 |= mask;
+        PCIFR = (1 << PCIF2);
+        PCICR |= (1 << PCIE2);
+        break;
+    }
+  }
+  SREG = oldSREG;
+  return true;
+}
+
+void EdgeCaptureEngine::end() {
+  uint8_t oldSREG = SREG;
+  cli();
+  EIMSK &= ~((1 << INT0) | (1 << INT1));
+  PCMSK0 &= ~watchMask[FAST_PORT_B];
+  PCMSK1 &= ~watchMask[FAST_PORT_C];
+  PCMSK2 &= ~watchMask[FAST_PORT_D];
+  memset(watchMask, 0, sizeof(watchMask));
+  SREG = oldSREG;
+}
+
+bool EdgeCaptureEngine::read(CapturedEdge& edge) {
+  return ring.pop(edge);
+}
+
+uint16_t EdgeCaptureEngine::dropped() {
+  return ring.dropped();
+}
+
+// INT0/INT1 - one pin, read its level straight away
+void EdgeCaptureEngine::handleExternal(byte pin) {
+  CapturedEdge edge;
+  edge.time = micros();
+  edge.pin = pin;
+  edge.level = (PIND & fastPinMask(pin)) ? HIGH : LOW;
+  ring.push(edge);
+}
+
+// PCINT - work out which watched pins on the port changed
+void EdgeCaptureEngine::handlePinChange(FastPort port, byte levels) {
+  uint32_t now = micros();
+  byte changed = (levels ^ lastLevels[port]) & watchMask[port];
+  lastLevels[port] = levels;
+
+  for (byte bit = 0; changed != 0; bit++, changed >>= 1) {
+    if (changed & 1) {
+      CapturedEdge edge;
+      edge.time = now;
+      edge.pin = fastPortPin(port, bit);
+      edge.level = (levels & (1 << bit)) ? HIGH : LOW;
+      ring.push(edge);
+    }
+  }
+}
@@ -0,0 +1,64 @@
+#ifndef EDGE_CAPTURE_H
+#define EDGE_CAPTURE_H
+
+#include <Arduino.h>
+#include <FastPins.h>
+#include <SpscRing.h>
+
+/**
+ * EdgeCapture - Timestamp every edge on chosen input pins
+ *
+ * Polling only sees a bouncing contact as often as it samples. This
+ * module instead takes an interrupt on every change of a watched pin
+ * and records the new level with its micros() timestamp:
+ * - Pin 2 uses INT0 and pin 3 uses INT1 (lowest latency)
+ * - Any other pin uses the pin-change interrupt (PCINT) of its port
+ *
+ * Edges go into a lock-free SpscRing, so loop() drains them with read()
+ * without ever turning interrupts off. micros() counts in 4 us steps on
+ * a 16 MHz board, which sets the timestamp resolution.
+ *
+ * Defines the INT0, INT1 and PCINT0-2 interrupt handlers.
+ */
+
+// Ring size (power of two); override with -DEDGE_CAPTURE_SIZE=...
+#ifndef EDGE_CAPTURE_SIZE
+#define EDGE_CAPTURE_SIZE 64
+#endif
+
+// One captured edge
+struct CapturedEdge {
+  uint32_t time;     // micros() when the interrupt ran
+  byte pin;          // Arduino pin that changed
+  byte level;        // New level (HIGH or LOW)
+};
+
+class EdgeCaptureEngine {
+  private:
+    SpscRing<CapturedEdge, EDGE_CAPTURE_SIZE> ring;
+    byte watchMask[3];    // Watched PCINT pins per port (indexed by FastPort)
+    byte lastLevels[3];   // Port levels at the last pin-change interrupt
+
+  public:
+    EdgeCaptureEngine();
+
+    // Start capturing edges on a pin (call once per pin)
+    bool begin(byte pin);
+
+    // Stop capturing on every pin
+    void end();
+
+    // Take the oldest captured edge; false when none are waiting
+    bool read(CapturedEdge& edge);
+
+    // Edges lost because loop() did not drain the ring in time
+    uint16_t dropped();
+
+    // Interrupt handlers
+    void handleExternal(byte pin);
+    void handlePinChange(FastPort port, byte levels);
+};
+
+extern EdgeCaptureEngine EdgeCapture;
+
+#endif
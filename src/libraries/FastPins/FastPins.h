@@ -0,0 +1,57 @@
+#ifndef FAST_PINS_H
+#define FAST_PINS_H
+
+#include <Arduino.h>
+
+/**
+ * FastPins - Compile-time Arduino pin to AVR port mapping (UNO / ATmega328P)
+ *
+ * digitalWrite() looks the pin up in flash tables and checks for PWM on
+ * every call. When the pin number is known at compile time, all of that
+ * can be resolved by the compiler instead:
+ * - Pins 0-7   -> PORTD bits 0-7
+ * - Pins 8-13  -> PORTB bits 0-5
+ * - Pins 14-19 -> PORTC bits 0-5 (A0-A5)
+ */
+
+#if defined(__AVR__) && !defined(__AVR_ATmega328P__)
+#error "FastPins pin map is written for the ATmega328P (Arduino UNO)"
+#endif
+
+// AVR I/O ports used by the UNO header pins
+enum FastPort : byte {
+  FAST_PORT_B,
+  FAST_PORT_C,
+  FAST_PORT_D,
+  FAST_PORT_NONE   // Pin number out of range
+};
+
+// Which port a pin belongs to
+constexpr FastPort fastPinPort(byte pin) {
+  return pin < 8 ? FAST_PORT_D : pin < 14 ? FAST_PORT_B : pin < 20 ? FAST_PORT_C : FAST_PORT_NONE;
+}
+
+// Bit position of a pin within its port
+constexpr byte fastPinBit(byte pin) {
+  return pin < 8 ? pin : pin < 14 ? pin - 8 : pin - 14;
+}
+
+// Single-bit mask of a pin within its port
+constexpr byte fastPinMask(byte pin) {
+  return fastPinPort(pin) == FAST_PORT_NONE ? 0 : (byte)(1 << fastPinBit(pin));
+}
+
+// Arduino pin number for a port and bit (inverse of the two above)
+constexpr byte fastPortPin(FastPort port, byte bit) {
+  return port == FAST_PORT_D ? bit : port == FAST_PORT_B ? 8 + bit : 14 + bit;
+}
+
+// OR of the masks of every pin in `pins` that lives on `port`
+template <byte N>
+constexpr byte fastPortMask(const byte (&pins)[N], FastPort port, byte i = 0) {
+  return i >= N ? 0 :
+         (byte)((fastPinPort(pins[i]) == port ? fastPinMask(pins[i]) : 0) |
+                fastPortMask(pins, port, i + 1));
+}
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef PIN_SET_H
+#define PIN_SET_H
+
+#include <Arduino.h>
+#include "FastPins.h"
+
+/**
+ * PinSet - A group of output pins written together with direct port access
+ *
+ * Built at compile time from a constexpr pin list:
+ *
+ *   constexpr byte LED_PINS[] = {9, 10, 11};
+ *   typedef PinSet<sizeof(LED_PINS), LED_PINS> LedPins;
+ *   LedPins::write(0b101);   // pins 9 and 11 on, 10 off
+ *
+ * Bit i of the state word controls Pins[i]. The pins are grouped by port
+ * and write() does one masked read-modify-write per port that is
+ * actually used, with interrupts held off so every LED changes together.
+ * write(state, which) does the same for a subset of the pins.
+ */
+
+template <byte N, const byte (&Pins)[N]>
+class PinSet {
+  static_assert(N <= 16, "PinSet state word holds at most 16 pins");
+
+  private:
+    // Gather the state bits of pins on one port into that port's layout.
+    // Unrolled by the compiler: each term is a constant bit test and OR.
+    template <FastPort Port, byte I, bool Done = (I >= N)>
+    struct Gather {
+      static inline byte bits(uint16_t state) {
+        return ((fastPinPort(Pins[I]) == Port && (state & (1U << I))) ? fastPinMask(Pins[I]) : 0) |
+               Gather<Port, I + 1>::bits(state);
+      }
+    };
+
+    template <FastPort Port, byte I>
+    struct Gather<Port, I, true> {
+      static inline byte bits(uint16_t) {
+        return 0;
+      }
+    };
+
+  public:
+    // Port masks covered by this set (0 when a port is unused)
+    static constexpr byte MASK_B = fastPortMask(Pins, FAST_PORT_B);
+    static constexpr byte MASK_C = fastPortMask(Pins, FAST_PORT_C);
+    static constexpr byte MASK_D = fastPortMask(Pins, FAST_PORT_D);
+
+    // Number of pins in the set
+    static constexpr byte count() {
+      return N;
+    }
+
+    // Arduino pin number of entry i
+    static byte pin(byte i) {
+      return Pins[i];
+    }
+
+    // Make every pin in the set an output
+    static void begin() {
+      uint8_t oldSREG = SREG;
+      cli();
+      if (MASK_B) DDRB |= MASK_B;
+      if (MASK_C) DDRC |= MASK_C;
+      if (MASK_D) DDRD |= MASK_D;
+      SREG = oldSREG;
+    }
+
+    // Write the whole set: bit i of state drives Pins[i]
+    static void write(uint16_t state) {
+      // Compute the new port bits before touching any port, so the
+      // stores below happen back to back
+      byte b = Gather<FAST_PORT_B, 0>::bits(state);
+      byte c = Gather<FAST_PORT_C, 0>::bits(state);
+      byte d = Gather<FAST_PORT_D, 0>::bits(state);
+
+      uint8_t oldSREG = SREG;
+      cli();
+      if (MASK_B) PORTB = (PORTB & (byte)~MASK_B) | b;
+      if (MASK_C) PORTC = (PORTC & (byte)~MASK_C) | c;
+      if (MASK_D) PORTD = (PORTD & (byte)~MASK_D) | d;
+      SREG = oldSREG;
+    }
+
+    // Write only the pins selected by `which`; the others keep their level
+    static void write(uint16_t state, uint16_t which) {
+      byte b = Gather<FAST_PORT_B, 0>::bits(state & which);
+      byte c = Gather<FAST_PORT_C, 0>::bits(state & which);
+      byte d = Gather<FAST_PORT_D, 0>::bits(state & which);
+      byte maskB = Gather<FAST_PORT_B, 0>::bits(which);
+      byte maskC = Gather<FAST_PORT_C, 0>::bits(which);
+      byte maskD = Gather<FAST_PORT_D, 0>::bits(which);
+
+      uint8_t oldSREG = SREG;
+      cli();
+      if (MASK_B && maskB) PORTB = (PORTB & (byte)~maskB) | b;
+      if (MASK_C && maskC) PORTC = (PORTC & (byte)~maskC) | c;
+      if (MASK_D && maskD) PORTD = (PORTD & (byte)~maskD) | d;
+      SREG = oldSREG;
+    }
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "FastRandom.h"
+
+/**
+ * FastRandom implementation
+ */
+
+// Shared generator for the sketch
+FastRandomEngine FastRandom;
+
+FastRandomEngine::FastRandomEngine() {
+  seed(1);
+}
+
+void FastRandomEngine::seed(uint32_t value) {
+  state = value != 0 ? value : 0x2545F491UL;
+  pool = 0;
+  poolBytes = 0;
+}
+
+void FastRandomEngine::seedFromNoise(byte analogPin) {
+  // Only the bottom bit or two of a reading is noise, so take 32
+  // readings and rotate each one in
+  uint32_t value = micros();
+  for (byte i = 0; i < 32; i++) {
+    value = (value << 3 | value >> 29) ^ (uint32_t)analogRead(analogPin);
+  }
+  seed(value);
+
+  // Mix the readings through the generator before the first output
+  for (byte i = 0; i < 8; i++) {
+    step();
+  }
+}
+
+void FastRandomEngine::fill(byte* data, byte bytes) {
+  byte i = 0;
+  // Whole outputs first, then the leftover bytes from the pool
+  for (; bytes - i >= 4; i += 4) {
+    uint32_t value = step();
+    data[i] = (byte)value;
+    data[i + 1] = (byte)(value >> 8);
+    data[i + 2] = (byte)(value >> 16);
+    data[i + 3] = (byte)(value >> 24);
+  }
+  for (; i < bytes; i++) {
+    data[i] = nextByte();
+  }
+}
+
+// fillBits() for more than one byte
+void FastRandomEngine::fillBitsLong(byte* data, uint16_t bits) {
+  uint16_t bytes = (bits + 7) / 8;
+  while (bytes > 255) {
+    fill(data, 255);
+    data += 255;
+    bytes -= 255;
+  }
+  fill(data, (byte)bytes);
+  if (bits & 7) {
+    data[bytes - 1] &= (1 << (bits & 7)) - 1;
+  }
+}
@@ -0,0 +1,99 @@
+#ifndef FAST_RANDOM_H
+#define FAST_RANDOM_H
+
+#include <Arduino.h>
+
+/**
+ * FastRandom - xorshift random numbers for LED patterns
+ *
+ * random(n) runs avr-libc's 32-bit multiply/divide generator and then a
+ * 32-bit modulo, hundreds of cycles per call, and the patterns keep only
+ * 1-8 bits of it. FastRandom is a 32-bit xorshift generator (Marsaglia,
+ * shifts 13/17/5: a linear feedback generator with period 2^32 - 1) made
+ * of shifts and XORs only, handed out a byte or a word at a time:
+ *
+ *   FastRandom.seedFromNoise(A0);       // once, in setup()
+ *   mask = FastRandom.nextWord() & allLeds;
+ *   FastRandom.fillBits(ledState, 64);  // 64 random LEDs
+ *
+ * - nextByte()/nextWord() take their bits from the last 32-bit output,
+ *   so the generator steps once per 4 bytes
+ * - Every output bit is on with probability 1/2, which is what a random
+ *   on/off LED needs; no modulo is done anywhere
+ * - Not for anything that must be unpredictable
+ *
+ * Sketches share the FastRandom instance; make another FastRandomEngine
+ * for a stream that must not be disturbed by other code.
+ */
+
+class FastRandomEngine {
+  private:
+    uint32_t state;        // Never 0
+    uint32_t pool;         // Unused bits of the last output
+    byte poolBytes;        // Bytes left in pool
+
+    inline uint32_t step() {
+      uint32_t x = state;
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      state = x;
+      return x;
+    }
+
+    void fillBitsLong(byte* data, uint16_t bits);
+
+  public:
+    FastRandomEngine();
+
+    // Restart the sequence (0 is replaced, xorshift needs a bit set)
+    void seed(uint32_t value);
+
+    // Seed from the low bits of ADC readings of a floating analog pin
+    // (and the clock), so every boot starts somewhere else
+    void seedFromNoise(byte analogPin);
+
+    inline byte nextByte() {
+      if (poolBytes == 0) {
+        pool = step();
+        poolBytes = 4;
+      }
+      byte value = (byte)pool;
+      pool >>= 8;
+      poolBytes--;
+      return value;
+    }
+
+    inline uint16_t nextWord() {
+      if (poolBytes < 2) {
+        pool = step();
+        poolBytes = 4;
+      }
+      uint16_t value = (uint16_t)pool;
+      pool >>= 16;
+      poolBytes -= 2;
+      return value;
+    }
+
+    inline uint32_t nextLong() {
+      return step();
+    }
+
+    // Random bytes
+    void fill(byte* data, byte bytes);
+
+    // `bits` random bits from bit 0 of data[0] up (bit i = LED i); the
+    // unused high bits of the last byte are cleared. Up to 8 bits is one
+    // nextByte(), inline, so an 8-LED frame costs no more than a byte
+    inline void fillBits(byte* data, uint16_t bits) {
+      if (bits > 8) {
+        fillBitsLong(data, bits);
+      } else if (bits != 0) {
+        data[0] = nextByte() & (byte)((1 << bits) - 1);
+      }
+    }
+};
+
+extern FastRandomEngine FastRandom;
+
+#endif
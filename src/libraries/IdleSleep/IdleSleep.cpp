@@ -0,0 +1,310 @@
+#include "IdleSleep.h"
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+
+/**
+ * IdleSleep implementation
+ */
+
+IdleSleepEngine IdleSleep;
+
+// millis()/micros() state kept by the Arduino core (wiring.c); moved
+// forward by hand after power-down, when Timer0 is stopped
+extern volatile unsigned long timer0_millis;
+extern volatile unsigned long timer0_overflow_count;
+
+// Shortest watchdog period (prescaler 0); prescaler p lasts 16 << p ms
+const uint16_t WDT_BASE_MS = 16;
+const byte WDT_MAX_PRESCALER = 9;   // 8 s
+
+// Timer0 runs at clk/64: one count is 4 us at 16 MHz
+const uint16_t TIMER0_TICK_US = 64 / (F_CPU / 1000000UL);
+
+ISR(PCINT0_vect) {
+  IdleSleep.handlePinChange();
+}
+
+ISR(PCINT1_vect) {
+  IdleSleep.handlePinChange();
+}
+
+ISR(PCINT2_vect) {
+  IdleSleep.handlePinChange();
+}
+
+ISR(WDT_vect) {
+  IdleSleep.handleWatchdog();
+}
+
+IdleSleepEngine::IdleSleepEngine() {
+  memset(wakeMask, 0, sizeof(wakeMask));
+  powerDown = false;
+  pinWoke = false;
+  sleeping = false;
+  stampValid = false;
+  wakeStamp = 0;
+  watchdogFired = false;
+  resetStats();
+}
+
+bool IdleSleepEngine::wakeOnPin(byte pin) {
+  FastPort port = fastPinPort(pin);
+  if (port == FAST_PORT_NONE) {
+    return false;
+  }
+
+  byte mask = fastPinMask(pin);
+  wakeMask[port] |= mask;
+
+  uint8_t oldSREG = SREG;
+  cli();
+  switch (port) {
+    case FAST_PORT_B:
+      PCMSK0 |= mask;
+      PCIFR = (1 << PCIF0);
+      PCICR |= (1 << PCIE0);
+      break;
+    case FAST_PORT_C:
+      PCMSK1 |= mask;
+      PCIFR = (1 << PCIF1);
+      PCICR |= (1 << PCIE1);
+      break;
+    default:
+      PCMSK2 |= mask;
+      PCIFR = (1 << PCIF2);
+      PCICR |= (1 << PCIE2);
+      break;
+  }
+  SREG = oldSREG;
+  return true;
+}
+
+void IdleSleepEngine::end() {
+  uint8_t oldSREG = SREG;
+  cli();
+  PCMSK0 &= ~wakeMask[FAST_PORT_B];
+  PCMSK1 &= ~wakeMask[FAST_PORT_C];
+  PCMSK2 &= ~wakeMask[FAST_PORT_D];
+  memset(wakeMask, 0, sizeof(wakeMask));
+  SREG = oldSREG;
+}
+
+void IdleSleepEngine::setPowerDown(bool enable) {
+  powerDown = enable;
+}
+
+bool IdleSleepEngine::isPowerDown() {
+  return powerDown;
+}
+
+IdleWake IdleSleepEngine::sleepFor(uint32_t ms) {
+  bool forever = (ms == IDLE_SLEEP_FOREVER);
+  IdleWake reason = IDLE_WAKE_TIMER;
+
+  if (ms > 0 && !pinWoke) {
+    uint32_t start = millis();
+    sleepCount++;
+    stampValid = false;
+
+    // Power-down needs the watchdog, which cannot time less than 16 ms;
+    // whatever is left (or everything, in idle mode) is slept in idle
+    if (powerDown && (forever || ms >= WDT_BASE_MS)) {
+      sleepPowerDown(ms, forever);
+      if (pinWoke) {
+        recordPinWake(true);
+      }
+    }
+    if (!pinWoke) {
+      sleepIdle(start, ms, forever);
+      if (pinWoke) {
+        recordPinWake(false);
+      }
+    }
+    sleptMillis += millis() - start;
+  }
+
+  uint8_t oldSREG = SREG;
+  cli();
+  if (pinWoke) {
+    reason = IDLE_WAKE_PIN;
+    pinWoke = false;
+    pinWakes++;
+  } else {
+    timerWakes++;
+  }
+  SREG = oldSREG;
+  return reason;
+}
+
+// Sleep once in the given mode; any interrupt wakes the CPU. Interrupts
+// are off between the pinWoke check and the sleep instruction (sei takes
+// effect one instruction late), so a pin change cannot slip in between.
+void IdleSleepEngine::sleepOnce(byte mode) {
+  set_sleep_mode(mode);
+  cli();
+  if (!pinWoke) {
+    sleeping = true;
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+    sleeping = false;
+  }
+  sei();
+}
+
+// Idle until the deadline or a pin change (Timer0 wakes us every ms)
+void IdleSleepEngine::sleepIdle(uint32_t start, uint32_t ms, bool forever) {
+  while (!pinWoke && (forever || millis() - start < ms)) {
+    sleepOnce(SLEEP_MODE_IDLE);
+  }
+}
+
+// Power down in watchdog-timed chunks, crediting millis() for each one
+void IdleSleepEngine::sleepPowerDown(uint32_t ms, bool forever) {
+  uint32_t remaining = ms;
+
+  while (!pinWoke && (forever || remaining >= WDT_BASE_MS)) {
+    if (forever) {
+      // Only a pin change can end this sleep
+      stopWatchdog();
+      sleepOnce(SLEEP_MODE_PWR_DOWN);
+      continue;
+    }
+
+    // Longest watchdog period that fits
+    byte prescaler = 0;
+    while (prescaler < WDT_MAX_PRESCALER &&
+           ((uint32_t)WDT_BASE_MS << (prescaler + 1)) <= remaining) {
+      prescaler++;
+    }
+    uint32_t period = (uint32_t)WDT_BASE_MS << prescaler;
+
+    watchdogFired = false;
+    startWatchdog(prescaler);
+    while (!watchdogFired && !pinWoke) {
+      sleepOnce(SLEEP_MODE_PWR_DOWN);
+    }
+    stopWatchdog();
+
+    if (!watchdogFired) {
+      break;
+    }
+
+    // Timer0 was stopped for the whole period
+    uint8_t oldSREG = SREG;
+    cli();
+    timer0_millis += period;
+    timer0_overflow_count += (period * 1000UL) / (TIMER0_TICK_US * 256UL);
+    SREG = oldSREG;
+    remaining -= period;
+  }
+}
+
+// Watchdog in interrupt-only mode (no reset)
+void IdleSleepEngine::startWatchdog(byte prescaler) {
+  byte bits = (prescaler & 0x07) | ((prescaler & 0x08) ? (1 << WDP3) : 0);
+  uint8_t oldSREG = SREG;
+  cli();
+  wdt_reset();
+  MCUSR &= ~(1 << WDRF);
+  WDTCSR = (1 << WDCE) | (1 << WDE);
+  WDTCSR = (1 << WDIE) | bits;
+  SREG = oldSREG;
+}
+
+void IdleSleepEngine::stopWatchdog() {
+  uint8_t oldSREG = SREG;
+  cli();
+  wdt_reset();
+  MCUSR &= ~(1 << WDRF);
+  WDTCSR = (1 << WDCE) | (1 << WDE);
+  WDTCSR = 0;
+  SREG = oldSREG;
+}
+
+// Interrupt-to-resume time of a pin wake (Timer0 counts wrap every 1 ms)
+void IdleSleepEngine::recordPinWake(bool fromPowerDown) {
+  if (!stampValid) {
+    return;
+  }
+  byte elapsed = TCNT0 - wakeStamp;
+  uint16_t latency = elapsed * TIMER0_TICK_US;
+  if (fromPowerDown) {
+    powerDownWakes++;
+  }
+
+  if (latencyCount == 0 || latency < latencyMin) {
+    latencyMin = latency;
+  }
+  if (latency > latencyMax) {
+    latencyMax = latency;
+  }
+  latencyCount++;
+  latencyTotal += latency;
+}
+
+uint32_t IdleSleepEngine::sleeps() {
+  return sleepCount;
+}
+
+uint32_t IdleSleepEngine::wakesByPin() {
+  return pinWakes;
+}
+
+uint32_t IdleSleepEngine::wakesByTimer() {
+  return timerWakes;
+}
+
+uint32_t IdleSleepEngine::millisAsleep() {
+  return sleptMillis;
+}
+
+uint16_t IdleSleepEngine::minWakeLatency() {
+  return latencyMin;
+}
+
+uint16_t IdleSleepEngine::maxWakeLatency() {
+  return latencyMax;
+}
+
+uint16_t IdleSleepEngine::meanWakeLatency() {
+  return latencyCount ? latencyTotal / latencyCount : 0;
+}
+
+void IdleSleepEngine::resetStats() {
+  sleepCount = 0;
+  pinWakes = 0;
+  timerWakes = 0;
+  powerDownWakes = 0;
+  latencyCount = 0;
+  latencyTotal = 0;
+  latencyMin = 0;
+  latencyMax = 0;
+  sleptMillis = 0;
+}
+
+void IdleSleepEngine::report(Print& out) {
+  out.print(F("Sleep: "));
+  out.print(sleepCount);
+  out.print(F(" sleeps, "));
+  out.print(sleptMillis);
+  out.print(F(" ms asleep, wakes pin/timer "));
+  out.print(pinWakes);
+  out.print('/');
+  out.println(timerWakes);
+  out.print(F("Pin wake latency (us): min "));
+  out.print(latencyMin);
+  out.print(F(" mean "));
+  out.print(meanWakeLatency());
+  out.print(F(" max "));
+  out.print(latencyMax);
+  if (powerDownWakes > 0) {
+    out.print(F(", +"));
+    out.print(IDLE_SLEEP_STARTUP_US);
+    out.print(F(" oscillator start on "));
+    out.print(powerDownWakes);
+    out.print(F(" power-down wakes"));
+  }
+  out.println();
+}
@@ -0,0 +1,132 @@
+#ifndef IDLE_SLEEP_H
+#define IDLE_SLEEP_H
+
+#include <Arduino.h>
+#include <FastPins.h>
+
+/**
+ * IdleSleep - Sleep between events, wake on a pin change or a deadline
+ *
+ * A loop() that spins flat out while waiting for a button burns full
+ * power for nothing. Once loop() has done its work it tells IdleSleep
+ * how long until the next thing is due:
+ *
+ *   IdleSleep.wakeOnPin(BUTTON_PIN);
+ *   ...
+ *   IdleSleep.sleepFor(msUntilNextDeadline);   // or IDLE_SLEEP_FOREVER
+ *
+ * and the CPU sleeps until that deadline passes or a wake pin changes.
+ * Two depths:
+ * - Idle (default): only the CPU clock stops. Timers, PWM and the UART
+ *   keep running and millis() stays exact. Timer0 still interrupts every
+ *   1.024 ms to keep millis(); sleepFor() goes straight back to sleep
+ *   after those, so loop() itself only runs at the deadline
+ * - Power-down (setPowerDown(true)): every clock stops, so PWM outputs
+ *   freeze and a byte being sent on Serial is cut off (flush first).
+ *   Deadlines are timed by the watchdog (16 ms steps, about +-10%) and
+ *   millis() is moved forward by each watchdog period slept. A pin wake
+ *   ends the sleep early; the part of the period already slept is then
+ *   not added to millis()
+ *
+ * Pin changes use the pin-change interrupts (PCINT), which can wake the
+ * CPU from power-down on either edge; INT0/INT1 only can on a low level.
+ *
+ * Wake-up latency for pin wakes is measured from the interrupt to the
+ * return from sleepFor() using Timer0 (4 us steps). Waking from
+ * power-down also waits IDLE_SLEEP_STARTUP_US for the oscillator to
+ * start (16K clocks with the UNO fuses) before the interrupt runs.
+ *
+ * Defines the PCINT0-2 and watchdog interrupt handlers, so it cannot be
+ * used together with EdgeCapture.
+ */
+
+// Oscillator start-up after power-down (SUT/CKSEL fuses; 16K CK at 16 MHz)
+#ifndef IDLE_SLEEP_STARTUP_US
+#define IDLE_SLEEP_STARTUP_US 1024
+#endif
+
+// sleepFor() argument: no deadline, wake only on a pin change
+const uint32_t IDLE_SLEEP_FOREVER = 0xFFFFFFFFUL;
+
+// Why sleepFor() returned
+enum IdleWake : byte {
+  IDLE_WAKE_TIMER,    // Deadline reached
+  IDLE_WAKE_PIN       // A wake pin changed
+};
+
+class IdleSleepEngine {
+  private:
+    byte wakeMask[3];             // PCINT wake pins per port (indexed by FastPort)
+    bool powerDown;               // Use power-down instead of idle
+    volatile bool pinWoke;        // A wake pin changed since sleepFor() last returned
+    volatile bool sleeping;       // CPU is (about to be) asleep in sleepFor()
+    volatile bool stampValid;     // wakeStamp belongs to the current sleep
+    volatile byte wakeStamp;      // TCNT0 when the pin-change interrupt ran
+    volatile bool watchdogFired;  // Set by the watchdog interrupt
+
+    // Statistics
+    uint32_t sleepCount;          // sleepFor() calls that slept
+    uint32_t pinWakes;
+    uint32_t timerWakes;
+    uint32_t powerDownWakes;      // Pin wakes that came out of power-down
+    uint32_t latencyCount;        // Pin wakes with a measured latency
+    uint32_t latencyTotal;        // Sum of those latencies (us)
+    uint16_t latencyMin;
+    uint16_t latencyMax;
+    uint32_t sleptMillis;         // Time spent inside sleepFor()
+
+    void sleepOnce(byte mode);
+    void sleepPowerDown(uint32_t ms, bool forever);
+    void sleepIdle(uint32_t start, uint32_t ms, bool forever);
+    void recordPinWake(bool fromPowerDown);
+    void startWatchdog(byte prescaler);
+    void stopWatchdog();
+
+  public:
+    IdleSleepEngine();
+
+    // Let a pin change end a sleep (call once per pin)
+    bool wakeOnPin(byte pin);
+
+    // Stop waking on every pin
+    void end();
+
+    // Sleep in power-down rather than idle (see the notes above)
+    void setPowerDown(bool enable);
+    bool isPowerDown();
+
+    // Sleep until ms have passed or a wake pin changes. A change that
+    // happened since the last call returns at once, so an edge that
+    // arrives just after loop() read the pin is never slept through.
+    IdleWake sleepFor(uint32_t ms);
+
+    // Statistics
+    uint32_t sleeps();
+    uint32_t wakesByPin();
+    uint32_t wakesByTimer();
+    uint32_t millisAsleep();
+    uint16_t minWakeLatency();     // us, 0 until the first pin wake
+    uint16_t maxWakeLatency();
+    uint16_t meanWakeLatency();
+    void resetStats();
+
+    // Print the statistics
+    void report(Print& out);
+
+    // Interrupt handlers
+    inline void handlePinChange() {
+      if (sleeping && !stampValid) {
+        wakeStamp = TCNT0;
+        stampValid = true;
+      }
+      pinWoke = true;
+    }
+
+    inline void handleWatchdog() {
+      watchdogFired = true;
+    }
+};
+
+extern IdleSleepEngine IdleSleep;
+
+#endif
@@ -0,0 +1,90 @@
+#include "InputSampler.h"
+
+/**
+ * InputSampler implementation - Timer2 in CTC mode
+ */
+
+InputSamplerEngine InputSampler;
+
+ISR(TIMER2_COMPA_vect) {
+  InputSampler.tick();
+}
+
+// Timer2 prescalers, smallest first, with their clock-select bits
+struct SamplerPrescale {
+  uint16_t divider;
+  byte clockSelect;
+};
+
+const SamplerPrescale SAMPLER_PRESCALES[] = {
+  {8,    (1 << CS21)},
+  {32,   (1 << CS21) | (1 << CS20)},
+  {64,   (1 << CS22)},
+  {128,  (1 << CS22) | (1 << CS20)},
+  {256,  (1 << CS22) | (1 << CS21)},
+  {1024, (1 << CS22) | (1 << CS21) | (1 << CS20)}
+};
+const byte SAMPLER_PRESCALE_COUNT = sizeof(SAMPLER_PRESCALES) / sizeof(SAMPLER_PRESCALES[0]);
+
+InputSamplerEngine::InputSamplerEngine() {
+  handler = 0;
+  tickCount = 0;
+  actualRate = 0;
+}
+
+bool InputSamplerEngine::begin(uint16_t rateHz, SampleHandler sampleHandler) {
+  if (rateHz == 0) {
+    return false;
+  }
+
+  // Pick the smallest prescaler whose period fits in 8 bits, which
+  // gives the closest achievable rate
+  for (byte i = 0; i < SAMPLER_PRESCALE_COUNT; i++) {
+    uint32_t timerClock = F_CPU / SAMPLER_PRESCALES[i].divider;
+    uint32_t period = (timerClock + rateHz / 2) / rateHz;
+    if (period >= 2 && period <= 256) {
+      end();
+      handler = sampleHandler;
+      tickCount = 0;
+      actualRate = (uint16_t)(timerClock / period);
+
+      uint8_t oldSREG = SREG;
+      cli();
+      TCCR2A = (1 << WGM21);                 // CTC mode
+      TCCR2B = SAMPLER_PRESCALES[i].clockSelect;
+      TCNT2 = 0;
+      OCR2A = (byte)(period - 1);
+      TIFR2 = (1 << OCF2A);                  // Drop any stale compare flag
+      TIMSK2 |= (1 << OCIE2A);
+      SREG = oldSREG;
+      return true;
+    }
+  }
+  return false;
+}
+
+void InputSamplerEngine::end() {
+  TIMSK2 &= ~(1 << OCIE2A);
+}
+
+uint16_t InputSamplerEngine::rate() {
+  return actualRate;
+}
+
+uint32_t InputSamplerEngine::ticks() {
+  uint8_t oldSREG = SREG;
+  cli();
+  uint32_t count = tickCount;
+  SREG = oldSREG;
+  return count;
+}
+
+uint32_t InputSamplerEngine::ticksToMicros(uint32_t tickSpan) {
+  if (actualRate == 0) {
+    return 0;
+  }
+  // Split into whole and remainder parts to stay within 32-bit math
+  uint32_t wholeMicros = 1000000UL / actualRate;
+  uint32_t remainder = 1000000UL % actualRate;
+  return tickSpan * wholeMicros + (tickSpan * remainder) / actualRate;
+}
@@ -0,0 +1,78 @@
+#ifndef INPUT_SAMPLER_H
+#define INPUT_SAMPLER_H
+
+#include <Arduino.h>
+#include <FastPins.h>
+
+/**
+ * InputSampler - Read the input ports at a fixed rate from a timer interrupt
+ *
+ * Polling a button from loop() means the time between samples depends
+ * on whatever else loop() is doing (Serial output, delays...). The
+ * sampler reads PINB, PINC and PIND from a Timer2 compare interrupt at
+ * a fixed, configurable rate (for example 1-4 kHz) and hands each
+ * sample to a handler that runs inside the ISR:
+ *
+ *   void onSample(const InputSample& sample) {
+ *     byte level = samplePin(sample, BUTTON_PIN);
+ *     ...   // Debounce, push events to a queue for loop()
+ *   }
+ *   InputSampler.begin(1000, onSample);
+ *
+ * The handler must be short and must not use Serial or delay().
+ * Uses Timer2, so it cannot run together with BitAngle, tone() or
+ * analogWrite() on pins 3/11.
+ */
+
+// One snapshot of all three input ports
+struct InputSample {
+  byte port[3];      // PINB, PINC, PIND (indexed by FastPort)
+  uint32_t tick;     // Sample number since begin()
+};
+
+typedef void (*SampleHandler)(const InputSample& sample);
+
+// Level of one Arduino pin within a sample
+inline byte samplePin(const InputSample& sample, byte pin) {
+  return (sample.port[fastPinPort(pin)] & fastPinMask(pin)) ? HIGH : LOW;
+}
+
+class InputSamplerEngine {
+  private:
+    SampleHandler handler;
+    volatile uint32_t tickCount;
+    uint16_t actualRate;    // Rate achieved after rounding the timer period
+
+  public:
+    InputSamplerEngine();
+
+    // Start sampling at roughly rateHz (31 Hz - 20 kHz); false if out of range
+    bool begin(uint16_t rateHz, SampleHandler sampleHandler);
+    void end();
+
+    // Sample rate actually running
+    uint16_t rate();
+
+    // Samples taken so far (safe to call from loop())
+    uint32_t ticks();
+
+    // Convert a tick count into microseconds at the running rate
+    uint32_t ticksToMicros(uint32_t tickSpan);
+
+    // Called from the Timer2 compare interrupt
+    inline void tick() {
+      InputSample sample;
+      sample.port[FAST_PORT_B] = PINB;
+      sample.port[FAST_PORT_C] = PINC;
+      sample.port[FAST_PORT_D] = PIND;
+      sample.tick = tickCount;
+      tickCount = sample.tick + 1;
+      if (handler) {
+        handler(sample);
+      }
+    }
+};
+
+extern InputSamplerEngine InputSampler;
+
+#endif
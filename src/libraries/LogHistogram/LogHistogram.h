@@ -0,0 +1,171 @@
+#ifndef LOG_HISTOGRAM_H
+#define LOG_HISTOGRAM_H
+
+#include <Arduino.h>
+
+/**
+ * LogHistogram - Fixed-size log2 histogram of 32-bit measurements
+ *
+ * Timings span several orders of magnitude (a few cycles for a quiet
+ * loop pass, tens of thousands when Serial output happens), so buckets
+ * double in width:
+ * - Bucket 0 counts zeros, bucket b counts values 2^(b-1) .. 2^b - 1
+ * - The last bucket also collects everything larger
+ *
+ * Alongside the buckets it keeps count, min, max and a running mean, so
+ * RAM use is fixed: 2 bytes per bucket plus 20 bytes. Bucket counters
+ * saturate instead of wrapping. Percentiles come from the buckets, so
+ * they are upper bounds within a factor of two (clamped to min/max).
+ */
+
+template <byte Buckets>
+class LogHistogram {
+  static_assert(Buckets >= 2 && Buckets <= 33,
+                "LogHistogram needs between 2 and 33 buckets");
+
+  private:
+    uint16_t buckets[Buckets];
+    uint32_t samples;
+    uint32_t minValue;
+    uint32_t maxValue;
+    uint32_t meanSum;     // Sum and count behind mean(); both are halved
+    uint32_t meanCount;   // together before the sum could overflow
+
+  public:
+    LogHistogram() {
+      reset();
+    }
+
+    void reset() {
+      memset(buckets, 0, sizeof(buckets));
+      samples = 0;
+      minValue = 0xFFFFFFFFUL;
+      maxValue = 0;
+      meanSum = 0;
+      meanCount = 0;
+    }
+
+    // Bucket a value falls into
+    static byte bucketOf(uint32_t value) {
+      byte b = 0;
+      if (value >> 16) {
+        b = 16;
+        value >>= 16;
+      }
+      if (value >> 8) {
+        b += 8;
+        value >>= 8;
+      }
+      while (value) {
+        b++;
+        value >>= 1;
+      }
+      return (b < Buckets) ? b : Buckets - 1;
+    }
+
+    // Smallest and largest value counted by a bucket
+    static uint32_t bucketLow(byte b) {
+      return (b == 0) ? 0 : (1UL << (b - 1));
+    }
+
+    static uint32_t bucketHigh(byte b) {
+      if (b >= Buckets - 1 || b >= 32) {
+        return 0xFFFFFFFFUL;
+      }
+      return (b == 0) ? 0 : (1UL << b) - 1;
+    }
+
+    void add(uint32_t value) {
+      byte b = bucketOf(value);
+      if (buckets[b] != 0xFFFF) {
+        buckets[b]++;
+      }
+      samples++;
+      if (value < minValue) {
+        minValue = value;
+      }
+      if (value > maxValue) {
+        maxValue = value;
+      }
+      if (meanSum + value < meanSum) {
+        meanSum >>= 1;
+        meanCount >>= 1;
+      }
+      meanSum += value;
+      meanCount++;
+    }
+
+    uint32_t count() const {
+      return samples;
+    }
+
+    uint32_t min() const {
+      return samples ? minValue : 0;
+    }
+
+    uint32_t max() const {
+      return maxValue;
+    }
+
+    uint32_t mean() const {
+      return meanCount ? meanSum / meanCount : 0;
+    }
+
+    uint16_t bucket(byte b) const {
+      return (b < Buckets) ? buckets[b] : 0;
+    }
+
+    static byte bucketCount() {
+      return Buckets;
+    }
+
+    // Value below which the given share (per mille) of samples falls,
+    // rounded up to the end of its bucket
+    uint32_t percentile(uint16_t permille) const {
+      uint32_t total = 0;
+      for (byte b = 0; b < Buckets; b++) {
+        total += buckets[b];
+      }
+      if (total == 0) {
+        return 0;
+      }
+
+      uint32_t rank = (total * permille + 999) / 1000;
+      if (rank == 0) {
+        rank = 1;
+      }
+      uint32_t seen = 0;
+      for (byte b = 0; b < Buckets; b++) {
+        seen += buckets[b];
+        if (seen >= rank) {
+          uint32_t high = bucketHigh(b);
+          if (high > maxValue) {
+            high = maxValue;
+          }
+          return (high < minValue) ? minValue : high;
+        }
+      }
+      return maxValue;
+    }
+
+    // One line per non-empty bucket: "  low-high: count"
+    void printBuckets(Print& out) const {
+      for (byte b = 0; b < Buckets; b++) {
+        if (buckets[b] == 0) {
+          continue;
+        }
+        out.print(F("  "));
+        out.print(bucketLow(b));
+        if (b == Buckets - 1) {
+          out.print(F("+"));
+        } else if (b > 1) {
+          out.print('-');
+          out.print(bucketHigh(b));
+        }
+        out.print(F(": "));
+        out.println(buckets[b]);
+      }
+    }
+};
+
+#endif
@@ -0,0 +1,144 @@
+#include "LoopProfiler.h"
+
+/**
+ * LoopProfiler implementation
+ */
+
+// Single profiler - there is only one Timer1
+LoopProfilerEngine LoopProfiler;
+
+ISR(TIMER1_OVF_vect) {
+  LoopProfiler.overflow();
+}
+
+LoopProfilerEngine::LoopProfilerEngine() {
+  sectionCount = 0;
+  overflows = 0;
+  overheadCycles = 0;
+  running = false;
+  memset(names, 0, sizeof(names));
+  memset(startCycles, 0, sizeof(startCycles));
+}
+
+// Start Timer1 free-running at the CPU clock
+void LoopProfilerEngine::begin() {
+  uint8_t oldSREG = SREG;
+  cli();
+  // Timer1: normal mode, no prescaler, overflow interrupt every 65536 cycles
+  TCCR1A = 0;
+  TCCR1B = (1 << CS10);
+  TCNT1 = 0;
+  overflows = 0;
+  TIFR1 = (1 << TOV1);
+  TIMSK1 = (1 << TOIE1);
+  SREG = oldSREG;
+  running = true;
+
+  // Cheapest of a few back-to-back clock reads is the fixed cost that
+  // every start()/stop() pair adds to a measurement
+  overheadCycles = 0xFFFF;
+  for (byte i = 0; i < 8; i++) {
+    uint32_t a = cycles();
+    uint32_t b = cycles();
+    if (b - a < overheadCycles) {
+      overheadCycles = b - a;
+    }
+  }
+
+  reset();
+}
+
+void LoopProfilerEngine::end() {
+  uint8_t oldSREG = SREG;
+  cli();
+  TIMSK1 &= ~(1 << TOIE1);
+  TCCR1B = 0;
+  SREG = oldSREG;
+  running = false;
+}
+
+bool LoopProfilerEngine::isRunning() {
+  return running;
+}
+
+ProfileSection LoopProfilerEngine::section(const __FlashStringHelper* sectionName) {
+  if (sectionCount >= LOOP_PROFILER_SECTIONS) {
+    return PROFILE_NO_SECTION;
+  }
+  names[sectionCount] = sectionName;
+  return sectionCount++;
+}
+
+void LoopProfilerEngine::record(ProfileSection id, uint32_t elapsedCycles) {
+  if (id >= sectionCount || !running) {
+    return;
+  }
+  elapsedCycles = (elapsedCycles > overheadCycles) ? elapsedCycles - overheadCycles : 0;
+
+  // A section timed in an ISR may be reported from loop()
+  uint8_t oldSREG = SREG;
+  cli();
+  histograms[id].add(elapsedCycles);
+  SREG = oldSREG;
+}
+
+bool LoopProfilerEngine::snapshot(ProfileSection id, ProfileHistogram& copy) {
+  if (id >= sectionCount) {
+    return false;
+  }
+  uint8_t oldSREG = SREG;
+  cli();
+  copy = histograms[id];
+  SREG = oldSREG;
+  return true;
+}
+
+const __FlashStringHelper* LoopProfilerEngine::name(ProfileSection id) {
+  return (id < sectionCount) ? names[id] : NULL;
+}
+
+byte LoopProfilerEngine::count() {
+  return sectionCount;
+}
+
+// Whole microseconds for a cycle count
+static uint32_t cyclesToMicros(uint32_t cycleCount) {
+  return cycleCount / (F_CPU / 1000000UL);
+}
+
+void LoopProfilerEngine::report(Print& out) {
+  out.print(F("--- Loop profile (cycles, overhead "));
+  out.print(overheadCycles);
+  out.println(F(" removed) ---"));
+
+  for (ProfileSection id = 0; id < sectionCount; id++) {
+    // Copy first: printing is slow and the section keeps running
+    ProfileHistogram stats;
+    snapshot(id, stats);
+
+    out.print(names[id]);
+    out.print(F(": n="));
+    out.print(stats.count());
+    out.print(F(" min="));
+    out.print(stats.min());
+    out.print(F(" mean="));
+    out.print(stats.mean());
+    out.print(F(" max="));
+    out.print(stats.max());
+    out.print(F(" ("));
+    out.print(cyclesToMicros(stats.mean()));
+    out.print(F(" us mean, "));
+    out.print(cyclesToMicros(stats.max()));
+    out.println(F(" us max)"));
+    stats.printBuckets(out);
+  }
+}
+
+void LoopProfilerEngine::reset() {
+  for (ProfileSection id = 0; id < LOOP_PROFILER_SECTIONS; id++) {
+    uint8_t oldSREG = SREG;
+    cli();
+    histograms[id].reset();
+    SREG = oldSREG;
+  }
+}
@@ -0,0 +1,144 @@
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <Arduino.h>
+#include <LogHistogram.h>
+
+/**
+ * LoopProfiler - Cycle-accurate timing of named code sections
+ *
+ * Counting loop() passes per second says the loop got slower, not
+ * where. The profiler runs Timer1 at the full CPU clock (62.5 ns per
+ * count on a 16 MHz board) and extends it to 32 bits with the overflow
+ * interrupt, then times sections of code by name:
+ *
+ *   ProfileSection debounceSection = LoopProfiler.section(F("debounce"));
+ *   LoopProfiler.begin();
+ *   ...
+ *   {
+ *     PROFILE_SCOPE(debounceSection);   // Times the rest of the block
+ *     ...
+ *   }
+ *   LoopProfiler.report(Serial);        // On demand
+ *
+ * Each section keeps count, min, max, mean and a log2 histogram in a
+ * fixed amount of RAM (about 60 bytes with the default 16 buckets).
+ * The cost of reading the clock is measured in begin() and subtracted,
+ * so an empty section reads close to 0. Time spent in interrupts that
+ * fire inside a section is counted as part of it.
+ *
+ * Sections may also be timed inside an interrupt handler, as long as
+ * each section is only ever timed from one context.
+ *
+ * Uses Timer1, so analogWrite() on pins 9/10 and the Servo library are
+ * unavailable while it runs.
+ */
+
+// Limits; override with -DLOOP_PROFILER_SECTIONS=... etc.
+#ifndef LOOP_PROFILER_SECTIONS
+#define LOOP_PROFILER_SECTIONS 4
+#endif
+
+#ifndef LOOP_PROFILER_BUCKETS
+#define LOOP_PROFILER_BUCKETS 16    // Last bucket: 2^14 cycles (~1 ms) and up
+#endif
+
+// Compile PROFILE_SCOPE() out with -DLOOP_PROFILER_ENABLED=0
+#ifndef LOOP_PROFILER_ENABLED
+#define LOOP_PROFILER_ENABLED 1
+#endif
+
+typedef byte ProfileSection;
+const ProfileSection PROFILE_NO_SECTION = 0xFF;
+
+typedef LogHistogram<LOOP_PROFILER_BUCKETS> ProfileHistogram;
+
+class LoopProfilerEngine {
+  private:
+    const __FlashStringHelper* names[LOOP_PROFILER_SECTIONS];
+    ProfileHistogram histograms[LOOP_PROFILER_SECTIONS];
+    uint32_t startCycles[LOOP_PROFILER_SECTIONS];
+    byte sectionCount;
+    volatile uint16_t overflows;    // Timer1 overflows (upper 16 bits of the clock)
+    uint16_t overheadCycles;        // Cost of one cycles() call, measured in begin()
+    bool running;
+
+  public:
+    LoopProfilerEngine();
+
+    // Start Timer1 at clk/1 and calibrate the timing overhead
+    void begin();
+    void end();
+    bool isRunning();
+
+    // Register a section (name in flash); PROFILE_NO_SECTION when full
+    ProfileSection section(const __FlashStringHelper* name);
+
+    // 32-bit CPU cycle clock (wraps after ~268 s at 16 MHz)
+    inline uint32_t cycles() {
+      uint8_t oldSREG = SREG;
+      cli();
+      uint16_t low = TCNT1;
+      uint16_t high = overflows;
+      // Overflow pending but not yet counted by the interrupt
+      if ((TIFR1 & (1 << TOV1)) && low < 0x8000) {
+        high++;
+      }
+      SREG = oldSREG;
+      return ((uint32_t)high << 16) | low;
+    }
+
+    inline void start(ProfileSection id) {
+      if (id < sectionCount) {
+        startCycles[id] = cycles();
+      }
+    }
+
+    inline void stop(ProfileSection id) {
+      if (id < sectionCount) {
+        record(id, cycles() - startCycles[id]);
+      }
+    }
+
+    // Add one measurement (in cycles) to a section
+    void record(ProfileSection id, uint32_t elapsedCycles);
+
+    // Consistent copy of one section's statistics
+    bool snapshot(ProfileSection id, ProfileHistogram& copy);
+    const __FlashStringHelper* name(ProfileSection id);
+    byte count();
+
+    // Print every section: summary line (cycles and us) plus histogram
+    void report(Print& out);
+    void reset();
+
+    // Called from the Timer1 overflow interrupt
+    inline void overflow() {
+      overflows++;
+    }
+};
+
+extern LoopProfilerEngine LoopProfiler;
+
+// Times from construction to the end of the enclosing block
+class ProfileScope {
+  private:
+    ProfileSection id;
+
+  public:
+    explicit ProfileScope(ProfileSection section) : id(section) {
+      LoopProfiler.start(id);
+    }
+
+    ~ProfileScope() {
+      LoopProfiler.stop(id);
+    }
+};
+
+#if LOOP_PROFILER_ENABLED
+#define PROFILE_SCOPE(section) ProfileScope profileScope_##section(section)
+#else
+#define PROFILE_SCOPE(section)
+#endif
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef NATIVE_HAL_HARDWARE_SERIAL_H
+#define NATIVE_HAL_HARDWARE_SERIAL_H
+
+#include "Stream.h"
+
+// Serial on the host: output goes to stdout (or is discarded when muted)
+class HardwareSerial : public Stream {
+  private:
+    bool muted;
+    unsigned long written;
+
+  public:
+    HardwareSerial() : muted(false), written(0) {}
+    void begin(unsigned long) {}
+    void end() {}
+    void setMuted(bool mute) { muted = mute; }
+    unsigned long bytesWritten() const { return written; }
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual int peek() { return -1; }
+    virtual int availableForWrite() { return 64; }
+    virtual size_t write(uint8_t value);
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    using Print::write;
+    operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif
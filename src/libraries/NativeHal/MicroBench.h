@@ -0,0 +1,77 @@
+#ifndef MICRO_BENCH_H
+#define MICRO_BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+
+/**
+ * MicroBench - Minimal host microbenchmark runner
+ *
+ * Times a piece of code over many calls and prints the cost per call:
+ *
+ *   MicroBench bench("Debounce strategies");
+ *   bench.run("time window", SAMPLES, [&](uint32_t i) {
+ *     timeDebouncer.update(stream[i], i);
+ *   });
+ *
+ * Each case runs a few times and the fastest run is reported, which
+ * filters out most scheduler noise. On x86 the time stamp counter gives
+ * cycles; elsewhere the unit is nanoseconds. Host numbers are for
+ * spotting algorithmic regressions (a change that doubles the cost of a
+ * step), not for predicting AVR timings.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+static inline uint64_t benchNow() { return __rdtsc(); }
+#else
+#define BENCH_UNIT "ns"
+static inline uint64_t benchNow() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+class MicroBench {
+  private:
+    uint8_t repeats;
+
+  public:
+    explicit MicroBench(const char* title, uint8_t repeatCount = 5) : repeats(repeatCount) {
+      printf("%s (%s per call, best of %u runs)\n", title, BENCH_UNIT, (unsigned)repeats);
+    }
+
+    // Call fn(i) for i = 0 .. calls-1 and print the cost per call;
+    // setup() runs before every timed run and is not timed
+    template <typename Setup, typename Fn>
+    double run(const char* name, uint32_t calls, Setup setup, Fn fn) {
+      double best = 0;
+      for (uint8_t r = 0; r < repeats; r++) {
+        setup();
+        uint64_t start = benchNow();
+        for (uint32_t i = 0; i < calls; i++) {
+          fn(i);
+        }
+        double perCall = (double)(benchNow() - start) / calls;
+        if (r == 0 || perCall < best) {
+          best = perCall;
+        }
+      }
+      printf("  %-32s %10.1f\n", name, best);
+      return best;
+    }
+
+    template <typename Fn>
+    double run(const char* name, uint32_t calls, Fn fn) {
+      return run(name, calls, [] {}, fn);
+    }
+
+    // Extra result line (counts, checks) under the timings
+    void note(const char* name, double value, const char* unit) {
+      printf("  %-32s %10.1f %s\n", name, value, unit);
+    }
+};
+
+#endif
@@ -0,0 +1,568 @@
+#include "NativeHal.h"
+
+#include <stdio.h>
+#include <vector>
+
+/**
+ * NativeHal implementation - virtual clock, pin model and Print
+ */
+
+// Registers
+volatile uint8_t PORTB, PORTC, PORTD, DDRB, DDRC, DDRD, PINB, PINC, PIND;
+volatile uint8_t SREG = 0x80;   // Interrupts on, as after init()
+volatile uint8_t GPIOR0, GPIOR1, GPIOR2;
+volatile uint8_t TCCR0A, TCCR0B, TCNT0, OCR0A, OCR0B, TIMSK0, TIFR0;
+volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+volatile uint16_t TCNT1, OCR1A, OCR1B, ICR1;
+volatile uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2, TIFR2;
+volatile uint8_t EICRA, EIMSK, EIFR, PCICR, PCIFR, PCMSK0, PCMSK1, PCMSK2;
+volatile uint8_t SPCR, SPSR;
+NativeSpiData SPDR;
+volatile uint8_t UCSR0A, UCSR0B, UCSR0C, UBRR0H, UBRR0L, UDR0;
+volatile uint8_t ADMUX, ADCSRA, ADCSRB, ADCL, ADCH;
+volatile uint16_t ADC;
+volatile uint8_t SMCR, PRR, MCUCR, MCUSR, WDTCSR;
+
+// Arduino core internals some libraries adjust directly (wiring.c);
+// the virtual clock does not read them
+volatile unsigned long timer0_overflow_count = 0;
+volatile unsigned long timer0_millis = 0;
+
+HardwareSerial Serial;
+
+namespace {
+
+uint64_t clockMicros = 0;
+uint8_t inputLevel[NUM_DIGITAL_PINS];
+int16_t outputLevel[NUM_DIGITAL_PINS];
+uint32_t writeCount[NUM_DIGITAL_PINS];
+uint8_t lastPort[3];
+bool tracing = false;
+std::vector<NativePinEvent> trace;
+NativeSleepHook sleepHook = 0;
+uint32_t randomState = 1;       // avr-libc random() state
+uint32_t noiseState = 1;        // analogRead() noise
+
+// Mock 74HC595 chain
+const uint8_t SHIFT_CHAIN_MAX = 32;
+uint8_t chainLatchPin = 0xFF;     // None
+uint8_t chainLength = 0;
+uint8_t chainShift[SHIFT_CHAIN_MAX];
+uint8_t chainOutput[SHIFT_CHAIN_MAX];
+uint32_t chainLatches = 0;
+uint32_t spiBytes = 0;
+
+volatile uint8_t* portRegister(uint8_t pin) {
+  return pin < 8 ? &PORTD : pin < 14 ? &PORTB : &PORTC;
+}
+
+volatile uint8_t* pinRegister(uint8_t pin) {
+  return pin < 8 ? &PIND : pin < 14 ? &PINB : &PINC;
+}
+
+volatile uint8_t* ddrRegister(uint8_t pin) {
+  return pin < 8 ? &DDRD : pin < 14 ? &DDRB : &DDRC;
+}
+
+uint8_t pinBit(uint8_t pin) {
+  return pin < 8 ? pin : pin < 14 ? pin - 8 : pin - 14;
+}
+
+uint8_t portIndex(uint8_t pin) {
+  return pin < 8 ? 2 : pin < 14 ? 0 : 1;
+}
+
+void record(uint8_t pin, int16_t value, bool analog) {
+  writeCount[pin]++;
+  if (outputLevel[pin] == value && !analog) {
+    return;
+  }
+  outputLevel[pin] = value;
+  if (pin == chainLatchPin && value == 1) {
+    memcpy(chainOutput, chainShift, chainLength);
+    chainLatches++;
+  }
+  if (tracing) {
+    NativePinEvent event = {clockMicros, pin, value, analog};
+    trace.push_back(event);
+  }
+}
+
+// PINx reads back outputs for output pins and injected levels for inputs
+void refreshPin(uint8_t pin) {
+  uint8_t mask = 1 << pinBit(pin);
+  bool isOutput = (*ddrRegister(pin) & mask) != 0;
+  uint8_t level = isOutput ? ((*portRegister(pin) & mask) ? 1 : 0) : inputLevel[pin];
+  if (level) {
+    *pinRegister(pin) |= mask;
+  } else {
+    *pinRegister(pin) &= ~mask;
+  }
+}
+
+// Direct PORTx writes since the last scan, into the pin model
+void scanPorts() {
+  volatile uint8_t* ports[3] = {&PORTB, &PORTC, &PORTD};
+  volatile uint8_t* ddrs[3] = {&DDRB, &DDRC, &DDRD};
+  const uint8_t firstPin[3] = {8, 14, 0};
+  for (uint8_t p = 0; p < 3; p++) {
+    uint8_t changed = *ports[p] ^ lastPort[p];
+    if (changed == 0) {
+      continue;
+    }
+    lastPort[p] = *ports[p];
+    for (uint8_t b = 0; changed != 0; b++, changed >>= 1) {
+      uint8_t pin = firstPin[p] + b;
+      if (!(changed & 1) || pin >= NUM_DIGITAL_PINS) {
+        continue;
+      }
+      if (*ddrs[p] & (1 << b)) {
+        record(pin, (*ports[p] >> b) & 1, false);
+      } else if ((*ports[p] >> b) & 1) {
+        // Pull-up switched on with a PORTx write: idles HIGH, as INPUT_PULLUP
+        inputLevel[pin] = HIGH;
+      }
+      refreshPin(pin);
+    }
+  }
+}
+
+}  // namespace
+
+// Clock
+
+unsigned long millis() {
+  return (uint32_t)(clockMicros / 1000);
+}
+
+unsigned long micros() {
+  return (uint32_t)clockMicros;
+}
+
+// Direct PORTx writes are picked up before time moves on, so the trace
+// stamps them with the time they were made
+
+void delay(unsigned long ms) {
+  nativeSyncPorts();
+  clockMicros += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+  nativeSyncPorts();
+  clockMicros += us;
+}
+
+void nativeSetMicros(uint64_t now) {
+  nativeSyncPorts();
+  clockMicros = now;
+}
+
+void nativeAdvanceMicros(uint64_t span) {
+  nativeSyncPorts();
+  clockMicros += span;
+}
+
+void nativeAdvanceMillis(uint32_t span) {
+  nativeSyncPorts();
+  clockMicros += (uint64_t)span * 1000;
+}
+
+uint64_t nativeNowMicros() {
+  return clockMicros;
+}
+
+// Pins
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin >= NUM_DIGITAL_PINS) {
+    return;
+  }
+  nativeSyncPorts();
+  uint8_t mask = 1 << pinBit(pin);
+  if (mode == OUTPUT) {
+    *ddrRegister(pin) |= mask;
+  } else {
+    *ddrRegister(pin) &= ~mask;
+    if (mode == INPUT_PULLUP) {
+      *portRegister(pin) |= mask;
+      inputLevel[pin] = HIGH;
+    } else {
+      *portRegister(pin) &= ~mask;
+    }
+  }
+  lastPort[portIndex(pin)] = *portRegister(pin);
+  refreshPin(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin >= NUM_DIGITAL_PINS) {
+    return;
+  }
+  nativeSyncPorts();
+  uint8_t mask = 1 << pinBit(pin);
+  if (value) {
+    *portRegister(pin) |= mask;
+  } else {
+    *portRegister(pin) &= ~mask;
+  }
+  lastPort[portIndex(pin)] = *portRegister(pin);
+  record(pin, value ? 1 : 0, false);
+  refreshPin(pin);
+}
+
+int digitalRead(uint8_t pin) {
+  if (pin >= NUM_DIGITAL_PINS) {
+    return LOW;
+  }
+  nativeSyncPorts();
+  refreshPin(pin);
+  return (*pinRegister(pin) & (1 << pinBit(pin))) ? HIGH : LOW;
+}
+
+void analogWrite(uint8_t pin, int value) {
+  if (pin >= NUM_DIGITAL_PINS) {
+    return;
+  }
+  record(pin, (int16_t)constrain(value, 0, 255), true);
+}
+
+int analogRead(uint8_t pin) {
+  if (pin >= A0) {
+    pin -= A0;
+  }
+  // Deterministic low-bit noise, good enough to seed generators
+  noiseState = noiseState * 1103515245UL + 12345UL + pin;
+  return 512 + (int)((noiseState >> 16) & 0x07);
+}
+
+void nativeSetInput(uint8_t pin, uint8_t level) {
+  if (pin < NUM_DIGITAL_PINS) {
+    inputLevel[pin] = level ? HIGH : LOW;
+    refreshPin(pin);
+  }
+}
+
+int nativeOutputLevel(uint8_t pin) {
+  nativeSyncPorts();
+  return pin < NUM_DIGITAL_PINS ? outputLevel[pin] : 0;
+}
+
+// SPI transfer-complete interrupt, when a library defines one
+extern "C" void SPI_STC_vect(void) __attribute__((weak));
+
+void nativeSyncPorts() {
+  scanPorts();
+  // Pending SPI interrupts; each one may start the next byte. Interrupts
+  // are off inside the handler, as on the AVR
+  while ((SPCR & (1 << SPIE)) && (SPSR & (1 << SPIF)) && (SREG & 0x80) && SPI_STC_vect) {
+    SPSR &= ~(1 << SPIF);
+    SREG &= ~0x80;
+    SPI_STC_vect();
+    SREG |= 0x80;
+  }
+  scanPorts();
+}
+
+// SPI and the mock shift-register chain
+
+NativeSpiData& NativeSpiData::operator=(uint8_t data) {
+  // Latch level as it was when the byte went out
+  scanPorts();
+  value = data;
+  spiBytes++;
+  if (SPCR & (1 << SPE)) {
+    for (uint8_t i = chainLength; i > 1; i--) {
+      chainShift[i - 1] = chainShift[i - 2];
+    }
+    if (chainLength > 0) {
+      chainShift[0] = data;
+    }
+    SPSR |= (1 << SPIF);
+  }
+  return *this;
+}
+
+NativeSpiData::operator uint8_t() const {
+  SPSR &= ~(1 << SPIF);
+  return value;
+}
+
+void nativeShiftChainBegin(uint8_t latchPin, uint8_t length) {
+  chainLatchPin = latchPin;
+  chainLength = length < SHIFT_CHAIN_MAX ? length : SHIFT_CHAIN_MAX;
+  memset(chainShift, 0, sizeof(chainShift));
+  memset(chainOutput, 0, sizeof(chainOutput));
+  chainLatches = 0;
+}
+
+uint8_t nativeShiftChainOutput(uint8_t index) {
+  nativeSyncPorts();
+  return index < chainLength ? chainOutput[index] : 0;
+}
+
+uint32_t nativeShiftChainLatches() {
+  nativeSyncPorts();
+  return chainLatches;
+}
+
+uint32_t nativeSpiBytes() {
+  return spiBytes;
+}
+
+// Trace
+
+void nativeTraceEnable(bool enable) {
+  tracing = enable;
+}
+
+void nativeTraceClear() {
+  trace.clear();
+}
+
+size_t nativeTraceSize() {
+  return trace.size();
+}
+
+const NativePinEvent& nativeTraceAt(size_t index) {
+  return trace[index];
+}
+
+uint32_t nativeWriteCount(uint8_t pin) {
+  return pin < NUM_DIGITAL_PINS ? writeCount[pin] : 0;
+}
+
+void nativeResetCounts() {
+  memset(writeCount, 0, sizeof(writeCount));
+}
+
+// Interrupts and sleep
+
+void cli() {
+  SREG &= ~0x80;
+}
+
+void sei() {
+  SREG |= 0x80;
+}
+
+void nativeSetSleepHook(NativeSleepHook hook) {
+  sleepHook = hook;
+}
+
+void sleep_cpu() {
+  if (sleepHook) {
+    sleepHook();
+  } else {
+    nativeAdvanceMillis(1);
+  }
+}
+
+// Random numbers (same API and sequence as the Arduino core). avr-libc's
+// random() is the Park-Miller minimal standard generator computed with
+// Schrage's method - a 32-bit divide and modulo per call - so host
+// benchmarks pay for the same algorithm the board does.
+
+static int32_t avrRandom() {
+  int32_t x = (int32_t)randomState;
+  if (x == 0) {
+    x = 123459876L;
+  }
+  int32_t hi = x / 127773L;
+  int32_t lo = x % 127773L;
+  x = 16807L * lo - 2836L * hi;
+  if (x < 0) {
+    x += 0x7FFFFFFFL;
+  }
+  randomState = (uint32_t)x;
+  return x;   // Already below RANDOM_MAX + 1 (2^31)
+}
+
+void randomSeed(unsigned long seed) {
+  if (seed != 0) {
+    randomState = (uint32_t)seed;
+  }
+}
+
+long random(long howBig) {
+  if (howBig == 0) {
+    return 0;
+  }
+  // avr-libc's long is 32 bits
+  return (long)(avrRandom() % (int32_t)howBig);
+}
+
+long random(long howSmall, long howBig) {
+  if (howSmall >= howBig) {
+    return howSmall;
+  }
+  return random(howBig - howSmall) + howSmall;
+}
+
+void nativeReset() {
+  clockMicros = 0;
+  memset(inputLevel, LOW, sizeof(inputLevel));
+  memset(outputLevel, 0, sizeof(outputLevel));
+  memset(lastPort, 0, sizeof(lastPort));
+  nativeResetCounts();
+  trace.clear();
+  PORTB = PORTC = PORTD = 0;
+  DDRB = DDRC = DDRD = 0;
+  PINB = PINC = PIND = 0;
+  SREG = 0x80;
+  SPCR = SPSR = 0;
+  SPDR.value = 0;
+  chainLatchPin = 0xFF;
+  chainLength = 0;
+  spiBytes = 0;
+  sleepHook = 0;
+  randomState = 1;
+  noiseState = 1;
+}
+
+// Serial
+
+size_t HardwareSerial::write(uint8_t value) {
+  written++;
+  if (!muted) {
+    fputc(value, stdout);
+  }
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  written += size;
+  if (!muted) {
+    fwrite(buffer, 1, size, stdout);
+  }
+  return size;
+}
+
+// Print (same behaviour as the Arduino core)
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    if (write(*buffer++)) {
+      n++;
+    } else {
+      break;
+    }
+  }
+  return n;
+}
+
+size_t Print::print(const __FlashStringHelper* text) {
+  return write(reinterpret_cast<const char*>(text));
+}
+
+size_t Print::print(const char text[]) {
+  return write(text);
+}
+
+size_t Print::print(char c) {
+  return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char n, int base) {
+  return print((unsigned long)n, base);
+}
+
+size_t Print::print(int n, int base) {
+  return print((long)n, base);
+}
+
+size_t Print::print(unsigned int n, int base) {
+  return print((unsigned long)n, base);
+}
+
+size_t Print::print(long n, int base) {
+  if (base == 0) {
+    return write((uint8_t)n);
+  }
+  if (base == 10 && n < 0) {
+    size_t t = print('-');
+    return printNumber((unsigned long)-n, 10) + t;
+  }
+  return printNumber((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+  if (base == 0) {
+    return write((uint8_t)n);
+  }
+  return printNumber(n, base);
+}
+
+size_t Print::print(double n, int digits) {
+  return printFloat(n, digits);
+}
+
+size_t Print::println() {
+  return write("\r\n");
+}
+
+size_t Print::println(const __FlashStringHelper* text) {
+  size_t n = print(text);
+  return n + println();
+}
+
+size_t Print::println(const char text[]) {
+  size_t n = print(text);
+  return n + println();
+}
+
+size_t Print::println(char c) {
+  size_t n = print(c);
+  return n + println();
+}
+
+size_t Print::println(unsigned char b, int base) {
+  size_t n = print(b, base);
+  return n + println();
+}
+
+size_t Print::println(int num, int base) {
+  size_t n = print(num, base);
+  return n + println();
+}
+
+size_t Print::println(unsigned int num, int base) {
+  size_t n = print(num, base);
+  return n + println();
+}
+
+size_t Print::println(long num, int base) {
+  size_t n = print(num, base);
+  return n + println();
+}
+
+size_t Print::println(unsigned long num, int base) {
+  size_t n = print(num, base);
+  return n + println();
+}
+
+size_t Print::println(double num, int digits) {
+  size_t n = print(num, digits);
+  return n + println();
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base) {
+  char buf[8 * sizeof(long) + 1];
+  char* str = &buf[sizeof(buf) - 1];
+  *str = '\0';
+  if (base < 2) {
+    base = 10;
+  }
+  do {
+    char c = n % base;
+    n /= base;
+    *--str = c < 10 ? c + '0' : c + 'A' - 10;
+  } while (n);
+  return write(str);
+}
+
+size_t Print::printFloat(double number, uint8_t digits) {
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", digits, number);
+  return write(buf);
+}
@@ -0,0 +1,68 @@
+#ifndef NATIVE_HAL_H
+#define NATIVE_HAL_H
+
+#include <Arduino.h>
+
+/**
+ * NativeHal - Host-side control of the Arduino shim
+ *
+ * Benchmarks and tools built for [env:native] use these calls to drive
+ * the virtual clock, feed input pins and inspect what the code under
+ * test wrote to its outputs.
+ */
+
+// One recorded output change
+struct NativePinEvent {
+  uint64_t time;     // Virtual time in microseconds
+  uint8_t pin;
+  int16_t value;     // 0/1 for digital writes, 0-255 for analogWrite
+  bool analog;
+};
+
+// Virtual clock (microseconds). Nothing advances it except these calls
+// and delay()/delayMicroseconds().
+void nativeSetMicros(uint64_t now);
+void nativeAdvanceMicros(uint64_t span);
+void nativeAdvanceMillis(uint32_t span);
+uint64_t nativeNowMicros();
+
+// Drive the level an input pin reads back
+void nativeSetInput(uint8_t pin, uint8_t level);
+
+// Output level last written to a pin (digitalWrite, analogWrite or PORTx)
+int nativeOutputLevel(uint8_t pin);
+
+// Pin trace: every output change while enabled, in order
+void nativeTraceEnable(bool enable);
+void nativeTraceClear();
+size_t nativeTraceSize();
+const NativePinEvent& nativeTraceAt(size_t index);
+
+// Output writes per pin since the last reset (includes unchanged writes)
+uint32_t nativeWriteCount(uint8_t pin);
+void nativeResetCounts();
+
+// Pick up direct PORTx writes made since the last call
+void nativeSyncPorts();
+
+// Mock chain of 74HC595 shift registers on the SPI pins. Every SPDR
+// write shifts a byte into register 0 (nearest the MCU) and the others
+// one register along; a rising edge on latchPin copies the shift stages
+// to the outputs. Like the pin trace, the latch pin is looked at when the
+// ports are synced, which includes every SPDR write: keep it low for at
+// least one byte of each frame (ShiftChain does).
+// The SPI interrupt (SPI_STC_vect, if linked) runs when the ports are
+// synced while SPIE, SPIF and interrupts are all on.
+void nativeShiftChainBegin(uint8_t latchPin, uint8_t length);
+uint8_t nativeShiftChainOutput(uint8_t index);
+uint32_t nativeShiftChainLatches();
+uint32_t nativeSpiBytes();
+
+// Called by sleep_cpu(); default advances the clock by 1 ms
+typedef void (*NativeSleepHook)();
+void nativeSetSleepHook(NativeSleepHook hook);
+
+// Put every pin, register and the clock back to power-on state
+void nativeReset();
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef NATIVE_HAL_STREAM_H
+#define NATIVE_HAL_STREAM_H
+
+#include "Print.h"
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+#endif
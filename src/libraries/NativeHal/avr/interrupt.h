@@ -0,0 +1,14 @@
+#ifndef NATIVE_HAL_INTERRUPT_H
+#define NATIVE_HAL_INTERRUPT_H
+
+#include "io.h"
+
+// Interrupt enable is bit 7 of SREG, as on the AVR
+void cli();
+void sei();
+
+// ISR(vector) defines a plain function the host harness can call
+// directly to simulate the interrupt
+#define ISR(vector, ...) extern "C" void vector(void)
+
+#endif
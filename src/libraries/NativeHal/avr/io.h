@@ -0,0 +1,91 @@
+#ifndef NATIVE_HAL_IO_H
+#define NATIVE_HAL_IO_H
+
+#include <stdint.h>
+
+/**
+ * ATmega328P registers as plain variables
+ *
+ * Lets code that uses direct port access and timer registers compile
+ * on the host. Port writes are mirrored into the pin model by
+ * nativeSyncPorts() (called whenever the clock moves and from the pin
+ * functions), so PORTx and digitalWrite() stay consistent.
+ */
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+#define __AVR_ATmega328P__ 1
+
+// I/O ports
+extern volatile uint8_t PORTB, PORTC, PORTD;
+extern volatile uint8_t DDRB, DDRC, DDRD;
+extern volatile uint8_t PINB, PINC, PIND;
+
+// Status register and general purpose I/O
+extern volatile uint8_t SREG;
+extern volatile uint8_t GPIOR0, GPIOR1, GPIOR2;
+
+// Timers
+extern volatile uint8_t TCCR0A, TCCR0B, TCNT0, OCR0A, OCR0B, TIMSK0, TIFR0;
+extern volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+extern volatile uint16_t TCNT1, OCR1A, OCR1B, ICR1;
+extern volatile uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2, TIFR2;
+
+// External and pin-change interrupts
+extern volatile uint8_t EICRA, EIMSK, EIFR, PCICR, PCIFR, PCMSK0, PCMSK1, PCMSK2;
+
+// SPI. A write to SPDR shifts the byte out at once (into the mock
+// 74HC595 chain, see NativeHal.h) and sets SPIF; reading SPDR clears it
+extern volatile uint8_t SPCR, SPSR;
+struct NativeSpiData {
+  uint8_t value;      // Last byte written (no slave drives MISO)
+  NativeSpiData& operator=(uint8_t data);
+  operator uint8_t() const;
+};
+extern NativeSpiData SPDR;
+
+// USART0
+extern volatile uint8_t UCSR0A, UCSR0B, UCSR0C, UBRR0H, UBRR0L, UDR0;
+
+// ADC
+extern volatile uint8_t ADMUX, ADCSRA, ADCSRB, ADCL, ADCH;
+extern volatile uint16_t ADC;
+
+// Power management
+extern volatile uint8_t SMCR, PRR, MCUCR, MCUSR, WDTCSR;
+
+// Register bit positions used by the sketches and libraries
+enum {
+  // Timer0 / Timer2
+  WGM00 = 0, WGM01 = 1, WGM02 = 3, CS00 = 0, CS01 = 1, CS02 = 2,
+  TOIE0 = 0, OCIE0A = 1, OCIE0B = 2, TOV0 = 0, OCF0A = 1, OCF0B = 2,
+  WGM20 = 0, WGM21 = 1, WGM22 = 3, CS20 = 0, CS21 = 1, CS22 = 2,
+  TOIE2 = 0, OCIE2A = 1, OCIE2B = 2, TOV2 = 0, OCF2A = 1, OCF2B = 2,
+  // Timer1
+  WGM10 = 0, WGM11 = 1, WGM12 = 3, WGM13 = 4, CS10 = 0, CS11 = 1, CS12 = 2,
+  TOIE1 = 0, OCIE1A = 1, OCIE1B = 2, ICIE1 = 5, TOV1 = 0, OCF1A = 1, OCF1B = 2,
+  // External / pin-change interrupts
+  ISC00 = 0, ISC01 = 1, ISC10 = 2, ISC11 = 3, INT0 = 0, INT1 = 1, INTF0 = 0, INTF1 = 1,
+  PCIE0 = 0, PCIE1 = 1, PCIE2 = 2, PCIF0 = 0, PCIF1 = 1, PCIF2 = 2,
+  // SPI
+  SPR0 = 0, SPR1 = 1, CPHA = 2, CPOL = 3, MSTR = 4, DORD = 5, SPE = 6, SPIE = 7,
+  SPI2X = 0, WCOL = 6, SPIF = 7,
+  // USART0
+  MPCM0 = 0, U2X0 = 1, UPE0 = 2, DOR0 = 3, FE0 = 4, UDRE0 = 5, TXC0 = 6, RXC0 = 7,
+  TXB80 = 0, RXB80 = 1, UCSZ02 = 2, TXEN0 = 3, RXEN0 = 4, UDRIE0 = 5, TXCIE0 = 6, RXCIE0 = 7,
+  UCPOL0 = 0, UCSZ00 = 1, UCSZ01 = 2,
+  // ADC
+  MUX0 = 0, ADLAR = 5, REFS0 = 6, REFS1 = 7,
+  ADPS0 = 0, ADPS1 = 1, ADPS2 = 2, ADIE = 3, ADIF = 4, ADATE = 5, ADSC = 6, ADEN = 7,
+  // Sleep / power
+  SE = 0, SM0 = 1, SM1 = 2, SM2 = 3,
+  PRADC = 0, PRUSART0 = 1, PRSPI = 2, PRTIM1 = 3, PRTIM0 = 5, PRTIM2 = 6, PRTWI = 7,
+  BODSE = 5, BODS = 6,
+  // Watchdog
+  WDP0 = 0, WDP1 = 1, WDP2 = 2, WDE = 3, WDCE = 4, WDP3 = 5, WDIE = 6, WDIF = 7,
+  PORF = 0, EXTRF = 1, BORF = 2, WDRF = 3
+};
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef NATIVE_HAL_PGMSPACE_H
+#define NATIVE_HAL_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+// The host has one address space: "flash" data is ordinary memory
+#define PROGMEM
+#define PSTR(s) (s)
+#define PGM_P const char*
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_ptr(addr) (*(void* const*)(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+
+#endif
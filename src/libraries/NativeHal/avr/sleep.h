@@ -0,0 +1,20 @@
+#ifndef NATIVE_HAL_SLEEP_H
+#define NATIVE_HAL_SLEEP_H
+
+#include "io.h"
+
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_ADC (1 << SM0)
+#define SLEEP_MODE_PWR_DOWN (1 << SM1)
+#define SLEEP_MODE_PWR_SAVE ((1 << SM0) | (1 << SM1))
+#define SLEEP_MODE_STANDBY ((1 << SM1) | (1 << SM2))
+
+#define set_sleep_mode(mode) (SMCR = (SMCR & ~((1 << SM0) | (1 << SM1) | (1 << SM2))) | (mode))
+#define sleep_enable() (SMCR |= (1 << SE))
+#define sleep_disable() (SMCR &= ~(1 << SE))
+#define sleep_bod_disable()
+
+// On the host a sleep advances the virtual clock to the next wake-up
+void sleep_cpu();
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef NATIVE_HAL_WDT_H
+#define NATIVE_HAL_WDT_H
+
+#include "io.h"
+
+#define wdt_reset()
+#define wdt_disable() (WDTCSR = 0)
+
+#endif
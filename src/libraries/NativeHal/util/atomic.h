@@ -0,0 +1,19 @@
+#ifndef NATIVE_HAL_ATOMIC_H
+#define NATIVE_HAL_ATOMIC_H
+
+#include "../avr/interrupt.h"
+
+// Minimal ATOMIC_BLOCK: the host runs single threaded, so a block just
+// clears and restores the interrupt flag like the AVR version
+struct NativeAtomicGuard {
+  uint8_t saved;
+  bool done;
+  NativeAtomicGuard() : saved(SREG), done(false) { cli(); }
+  ~NativeAtomicGuard() { SREG = saved; }
+};
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define ATOMIC_BLOCK(type) for (NativeAtomicGuard _guard; !_guard.done; _guard.done = true)
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef PATTERN_REGISTRY_H
+#define PATTERN_REGISTRY_H
+
+#include <Arduino.h>
+
+/**
+ * PatternRegistry - Pattern tables in flash, generated from one list
+ *
+ * A sketch declares its patterns once, as an X-macro list with one
+ * PATTERN(id, name, intervalMs, step) line per pattern:
+ *
+ *   #define MY_PATTERN_LIST(PATTERN) \
+ *     PATTERN(PATTERN_BLINK, "Blink", 100, blinkStep) \
+ *     PATTERN(PATTERN_CHASE, "Chase", 150, chaseStep)
+ *
+ *   enum MyPattern {
+ *     MY_PATTERN_LIST(PATTERN_REGISTRY_ENUM)
+ *     PATTERN_COUNT
+ *   };
+ *
+ * and in one .cpp file defines the names and the table:
+ *
+ *   MY_PATTERN_LIST(PATTERN_REGISTRY_NAME)
+ *   const PatternEntry<MyStep> PATTERNS[] PROGMEM = {
+ *     MY_PATTERN_LIST(PATTERN_REGISTRY_ENTRY)
+ *   };
+ *   PATTERN_REGISTRY_CHECK(PATTERNS, PATTERN_COUNT);
+ *
+ * `step` is whatever the sketch runs for a pattern: a step function, a
+ * PatternVm program, ... Entries are read back with patternEntryStep(),
+ * patternEntryInterval() and patternEntryName(), which do the flash reads.
+ */
+
+// One pattern (in flash)
+template <typename Step>
+struct PatternEntry {
+  Step step;              // What renders the pattern
+  uint16_t intervalMs;    // Default time between steps
+  const char* name;       // PROGMEM string
+};
+
+// List expanders, for PATTERN(id, name, intervalMs, step) lists
+#define PATTERN_REGISTRY_ENUM(id, name, intervalMs, step) id,
+#define PATTERN_REGISTRY_NAME(id, name, intervalMs, step) static const char id##_NAME[] PROGMEM = name;
+#define PATTERN_REGISTRY_ENTRY(id, name, intervalMs, step) {step, intervalMs, id##_NAME},
+
+// The table has exactly one entry per enum value
+#define PATTERN_REGISTRY_CHECK(table, count) \
+  static_assert(sizeof(table) / sizeof((table)[0]) == (count), \
+                #table " must have one entry per pattern")
+
+// Flash reads of one entry
+template <typename Step>
+inline Step patternEntryStep(const PatternEntry<Step>* table, byte pattern) {
+  Step step;
+  memcpy_P(&step, &table[pattern].step, sizeof(step));
+  return step;
+}
+
+template <typename Step>
+inline uint16_t patternEntryInterval(const PatternEntry<Step>* table, byte pattern) {
+  return pgm_read_word(&table[pattern].intervalMs);
+}
+
+template <typename Step>
+inline const __FlashStringHelper* patternEntryName(const PatternEntry<Step>* table, byte pattern) {
+  return (const __FlashStringHelper*)pgm_read_ptr(&table[pattern].name);
+}
+
+#endif
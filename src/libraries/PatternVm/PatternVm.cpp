@@ -0,0 +1,193 @@
+#include "PatternVm.h"
+#include <FastRandom.h>
+
+/**
+ * PatternVm interpreter
+ */
+
+PatternVm::PatternVm() {
+  state = saved;
+  length = 1;
+  program = NULL;
+  pc = 0;
+  waitLeft = 0;
+  depth = 0;
+  skipped = 0;
+  memset(saved, 0, sizeof(saved));
+}
+
+void PatternVm::begin(byte* ledState, byte bytes) {
+  state = ledState;
+  length = constrain(bytes, 1, PVM_MAX_BYTES);
+}
+
+void PatternVm::start(const byte* programP) {
+  program = programP;
+  pc = 0;
+  waitLeft = 0;
+  depth = 0;
+  skipped = 0;
+}
+
+void PatternVm::step() {
+  if (program == NULL) {
+    return;
+  }
+  // Still showing the last frame
+  if (waitLeft != 0) {
+    waitLeft--;
+    return;
+  }
+
+  for (byte ops = 0; ops < PVM_MAX_OPS_PER_STEP; ops++) {
+    byte op = fetch();
+    switch (op) {
+      case PVM_WAIT:
+        {
+          byte steps = fetch();
+          waitLeft = steps ? steps - 1 : 0;
+        }
+        return;
+
+      case PVM_FILL:
+        memset(state, fetch(), length);
+        break;
+
+      case PVM_ONLY:
+        {
+          byte led = fetch();
+          if (led == PVM_LAST_LED || led >= length * 8) {
+            led = length * 8 - 1;
+          }
+          memset(state, 0, length);
+          state[led >> 3] = 1 << (led & 7);
+        }
+        break;
+
+      case PVM_AND:
+        {
+          byte value = fetch();
+          for (byte i = 0; i < length; i++) {
+            state[i] &= value;
+          }
+        }
+        break;
+
+      case PVM_OR:
+        {
+          byte value = fetch();
+          for (byte i = 0; i < length; i++) {
+            state[i] |= value;
+          }
+        }
+        break;
+
+      case PVM_XOR:
+        {
+          byte value = fetch();
+          for (byte i = 0; i < length; i++) {
+            state[i] ^= value;
+          }
+        }
+        break;
+
+      case PVM_SHL:
+      case PVM_ROL:
+        for (byte n = fetch(); n > 0; n--) {
+          shiftUp(op == PVM_ROL);
+        }
+        break;
+
+      case PVM_SHR:
+      case PVM_ROR:
+        for (byte n = fetch(); n > 0; n--) {
+          shiftDown(op == PVM_ROR);
+        }
+        break;
+
+      case PVM_INC:
+        // Ripple carry up from byte 0
+        for (byte i = 0; i < length && ++state[i] == 0; i++) {
+        }
+        break;
+
+      case PVM_RANDOM:
+        FastRandom.fill(state, length);
+        break;
+
+      case PVM_SAVE:
+        memcpy(saved, state, length);
+        break;
+
+      case PVM_MASK_SAVED:
+        {
+          byte value = fetch();
+          for (byte i = 0; i < length; i++) {
+            state[i] = saved[i] & value;
+          }
+        }
+        break;
+
+      case PVM_REPEAT:
+        {
+          byte count = fetch();
+          if (count == PVM_LEDS_MINUS_1) {
+            count = length * 8 - 1;
+          }
+          // Too deep: the block runs once, and its next is matched
+          // here instead of against an outer block
+          if (depth < PVM_MAX_DEPTH) {
+            loopStart[depth] = pc;
+            loopLeft[depth] = count;
+            depth++;
+          } else {
+            skipped++;
+          }
+        }
+        break;
+
+      case PVM_NEXT:
+        if (skipped != 0) {
+          skipped--;
+        } else if (depth != 0) {
+          if (--loopLeft[depth - 1] != 0) {
+            pc = loopStart[depth - 1];
+          } else {
+            depth--;
+          }
+        }
+        break;
+
+      case PVM_JUMP:
+        pc = fetch();
+        break;
+
+      default:
+        // PVM_END or an unknown op: start again
+        pc = 0;
+        depth = 0;
+        skipped = 0;
+        break;
+    }
+  }
+}
+
+// Every LED one place up; the top LED drops out or wraps to LED 0
+void PatternVm::shiftUp(bool rotate) {
+  byte carry = rotate ? state[length - 1] >> 7 : 0;
+  for (byte i = 0; i < length; i++) {
+    byte next = state[i] >> 7;
+    state[i] = (state[i] << 1) | carry;
+    carry = next;
+  }
+}
+
+// Every LED one place down; LED 0 drops out or wraps to the top
+void PatternVm::shiftDown(bool rotate) {
+  byte carry = rotate ? state[0] << 7 : 0;
+  for (byte i = length; i-- > 0;) {
+    byte next = state[i] << 7;
+    state[i] = (state[i] >> 1) | carry;
+    carry = next;
+  }
+}
@@ -0,0 +1,110 @@
+#ifndef PATTERN_VM_H
+#define PATTERN_VM_H
+
+#include <Arduino.h>
+
+/**
+ * PatternVm - LED patterns as small byte programs in flash
+ *
+ * Every hand-written pattern is a new switch case with its own copy of
+ * the step bookkeeping. A pattern program is a few bytes in flash run by
+ * one shared interpreter instead:
+ *
+ *   ; Knight Rider, assembled by tools/patternvm/pvasm.py
+ *           only 0
+ *   top:    repeat leds-1
+ *           wait 1
+ *           shl 1
+ *           next
+ *           repeat leds-1
+ *           wait 1
+ *           shr 1
+ *           next
+ *           jump top
+ *
+ * The program works on an LED state of 1-PVM_MAX_BYTES bytes (bit i =
+ * LED i, as ledState in bit_manipulation). Each step() runs instructions
+ * up to the next `wait n`, which shows the state for n steps. Running
+ * off the end starts the program again.
+ *
+ * - One opcode byte, plus one operand byte for most ops
+ * - A step is at most PVM_MAX_OPS_PER_STEP instructions, so a program
+ *   without a wait cannot hang the sketch
+ * - repeat/next blocks nest PVM_MAX_DEPTH deep (pvasm rejects deeper
+ *   ones; if one gets through anyway it runs once, and its next does not
+ *   close the block around it); programs are up to 256 bytes (jump
+ *   addresses are one byte)
+ * - Programs are read with pgm_read_byte(), so they must be PROGMEM
+ *
+ * Opcode numbers are part of the program format: tools/patternvm/pvasm.py
+ * reads them from the enum below, so add new ops before PVM_OP_COUNT.
+ */
+
+#ifndef PVM_MAX_BYTES
+#define PVM_MAX_BYTES 16   // 128 LEDs
+#endif
+
+const byte PVM_MAX_OPS_PER_STEP = 32;
+const byte PVM_MAX_DEPTH = 2;
+
+// Operand values with a special meaning
+const byte PVM_LAST_LED = 0xFF;       // only: the last LED
+const byte PVM_LEDS_MINUS_1 = 0;      // repeat: LED count - 1 times
+
+enum PatternOp : byte {
+  PVM_END,         // Start the program again
+  PVM_WAIT,        // n: show the state for n steps (ends the step)
+  PVM_FILL,        // v: every state byte = v
+  PVM_ONLY,        // n: LED n on, all others off
+  PVM_AND,         // v: every state byte &= v
+  PVM_OR,          // v: every state byte |= v
+  PVM_XOR,         // v: every state byte ^= v
+  PVM_SHL,         // n: move every LED n places up, zeros in
+  PVM_SHR,         // n: move every LED n places down, zeros in
+  PVM_ROL,         // n: rotate n places up
+  PVM_ROR,         // n: rotate n places down
+  PVM_INC,         // Count: state + 1 as one binary number
+  PVM_RANDOM,      // Random value in every state byte (FastRandom)
+  PVM_SAVE,        // Copy the state to the save buffer
+  PVM_MASK_SAVED,  // v: state = saved state & v (per byte)
+  PVM_REPEAT,      // n: run the block up to the matching next n times
+  PVM_NEXT,        // End of a repeat block
+  PVM_JUMP,        // a: continue at program address a
+  PVM_OP_COUNT
+};
+
+class PatternVm {
+  private:
+    byte* state;
+    byte length;                  // State bytes
+    byte saved[PVM_MAX_BYTES];
+
+    const byte* program;          // PROGMEM
+    byte pc;
+    byte waitLeft;                // Steps the current frame is still shown
+    byte depth;                   // Open repeat blocks
+    byte skipped;                 // Open blocks past PVM_MAX_DEPTH (run once)
+    byte loopStart[PVM_MAX_DEPTH];
+    byte loopLeft[PVM_MAX_DEPTH];
+
+    inline byte fetch() {
+      return pgm_read_byte(program + pc++);
+    }
+
+    void shiftUp(bool rotate);
+    void shiftDown(bool rotate);
+
+  public:
+    PatternVm();
+
+    // LED state the programs draw into (bytes <= PVM_MAX_BYTES)
+    void begin(byte* ledState, byte bytes);
+
+    // Run a program from the start; the state is left as it is
+    void start(const byte* programP);
+
+    // Advance one step
+    void step();
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef PORT_DEBOUNCER_H
+#define PORT_DEBOUNCER_H
+
+#include <Arduino.h>
+
+/**
+ * PortDebouncer - Debounce all 8 pins of a port at once
+ *
+ * The counter (integrator) method from button_debouncing counts how many
+ * readings in a row disagree with the stable state and accepts the new
+ * state after MAX_COUNT of them. This class runs that same idea for 8
+ * pins in parallel using "vertical counters":
+ * - Each pin gets a 2-bit counter, stored as bit n of count0 and count1
+ * - A pin's counter advances while its reading differs from the stable
+ *   state and resets as soon as it agrees again
+ * - After 4 differing samples in a row the pin's stable state flips
+ *
+ * One update() is a handful of bitwise operations no matter how many
+ * buttons are on the port. Call it at a steady rate, for example every
+ * millisecond with the raw port value:
+ *
+ *   PortDebouncer buttons;          // Pull-ups: idle HIGH, pressed LOW
+ *   buttons.update(PIND);
+ *   if (buttons.pressed() & (1 << 2)) { ... }   // Pin 2 pressed
+ */
+
+// Consecutive differing samples needed to accept a change (2-bit counter)
+const byte PORT_DEBOUNCE_SAMPLES = 4;
+
+class PortDebouncer {
+  private:
+    byte state;          // Debounced pin levels
+    byte count0;         // Bit 0 of each pin's counter
+    byte count1;         // Bit 1 of each pin's counter
+    byte activeLow;      // Pins that are "pressed" when LOW (pull-up wiring)
+    byte pressedEdges;   // Pins that became pressed on the last update
+    byte releasedEdges;  // Pins that became released on the last update
+
+  public:
+    // initialState: levels to start from (0xFF for idle pull-ups)
+    // activeLowMask: pins whose pressed level is LOW
+    PortDebouncer(byte initialState = 0xFF, byte activeLowMask = 0xFF) {
+      state = initialState;
+      count0 = 0;
+      count1 = 0;
+      activeLow = activeLowMask;
+      pressedEdges = 0;
+      releasedEdges = 0;
+    }
+
+    // Feed one raw sample of the port; returns the pins that changed
+    inline byte update(byte sample) {
+      // Pins whose reading disagrees with the debounced state
+      byte delta = sample ^ state;
+
+      // Advance disagreeing counters, clear agreeing ones
+      count1 = (count1 ^ count0) & delta;
+      count0 = (byte)~count0 & delta;
+
+      // A counter that has wrapped back to 0 while still disagreeing
+      // has seen PORT_DEBOUNCE_SAMPLES samples in a row: accept it
+      byte toggle = delta & (byte)~(count0 | count1);
+      state ^= toggle;
+
+      // Convert level changes into press/release edges
+      byte down = state ^ activeLow;
+      pressedEdges = toggle & down;
+      releasedEdges = toggle & (byte)~down;
+      return toggle;
+    }
+
+    // Debounced pin levels (as read from the port)
+    byte levels() const {
+      return state;
+    }
+
+    // Pins currently pressed, after debouncing
+    byte down() const {
+      return state ^ activeLow;
+    }
+
+    // Pins that were pressed / released by the last update()
+    byte pressed() const {
+      return pressedEdges;
+    }
+
+    byte released() const {
+      return releasedEdges;
+    }
+};
+
+#endif
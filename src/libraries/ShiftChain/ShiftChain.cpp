@@ -0,0 +1,110 @@
+#include "ShiftChain.h"
+
+/**
+ * ShiftChain implementation (SPI master, mode 0, MSB first)
+ */
+
+// Single engine - there is only one SPI port
+ShiftChainEngine ShiftChain;
+
+ISR(SPI_STC_vect) {
+  ShiftChain.handleTransferComplete();
+}
+
+ShiftChainEngine::ShiftChainEngine() {
+  length = 1;
+  sendingFrame = 0;
+  sendIndex = 0;
+  transferBusy = false;
+  frameQueued = false;
+  framesReplaced = 0;
+  memset(frames, 0, sizeof(frames));
+}
+
+void ShiftChainEngine::begin(byte bytes, ShiftClock clock) {
+  end();
+  length = constrain(bytes, 1, SHIFT_CHAIN_MAX_BYTES);
+  framesReplaced = 0;
+
+  uint8_t oldSREG = SREG;
+  cli();
+  // Latch idles high; the registers latch on its rising edge
+  PORTB |= SHIFT_LATCH_MASK;
+  DDRB |= SHIFT_LATCH_MASK | SHIFT_MOSI_MASK | SHIFT_SCK_MASK;
+
+  // Master, mode 0, MSB first. Divider 2^(clock + 1): SPR1:0 picks
+  // 4/16/64/128, SPI2X halves it (except for 128)
+  byte rate = clock > SHIFT_CLOCK_DIV128 ? SHIFT_CLOCK_DIV128 : clock;
+  SPCR = (1 << SPE) | (1 << MSTR) | (rate >> 1);
+  if ((rate & 1) == 0 && rate != SHIFT_CLOCK_DIV128) {
+    SPSR |= (1 << SPI2X);
+  } else {
+    SPSR &= ~(1 << SPI2X);
+  }
+  SREG = oldSREG;
+}
+
+void ShiftChainEngine::end() {
+  // Let a send() in flight finish so the outputs hold a whole frame
+  while (busy()) {
+  }
+  SPCR = 0;
+}
+
+byte ShiftChainEngine::size() {
+  return length;
+}
+
+void ShiftChainEngine::write(const byte* data) {
+  while (busy()) {
+  }
+
+  // Farthest register's byte first; each byte pushes the earlier ones on
+  for (byte i = length - 1; i > 0; i--) {
+    SPDR = data[i];
+    while (!(SPSR & (1 << SPIF))) {
+    }
+  }
+  // RCLK low while the last byte shifts in; rising edge latches
+  PORTB &= ~SHIFT_LATCH_MASK;
+  SPDR = data[0];
+  while (!(SPSR & (1 << SPIF))) {
+  }
+  PORTB |= SHIFT_LATCH_MASK;
+}
+
+void ShiftChainEngine::send(const byte* data) {
+  uint8_t oldSREG = SREG;
+  cli();
+  if (transferBusy) {
+    // Fill the buffer the interrupt is not reading; sent after this frame
+    if (frameQueued) {
+      framesReplaced++;
+    }
+    memcpy(frames[sendingFrame ^ 1], data, length);
+    frameQueued = true;
+  } else {
+    memcpy(frames[sendingFrame], data, length);
+    transferBusy = true;
+
+    // Clear a completion flag left by write() (read SPSR, then SPDR),
+    // or the interrupt would fire before the first byte is out
+    (void)SPSR;
+    (void)SPDR;
+    SPCR |= (1 << SPIE);
+    startFrame();
+  }
+  SREG = oldSREG;
+}
+
+bool ShiftChainEngine::busy() {
+  return transferBusy;
+}
+
+uint16_t ShiftChainEngine::replaced() {
+  uint8_t oldSREG = SREG;
+  cli();
+  uint16_t count = framesReplaced;
+  SREG = oldSREG;
+  return count;
+}
@@ -0,0 +1,131 @@
+#ifndef SHIFT_CHAIN_H
+#define SHIFT_CHAIN_H
+
+#include <Arduino.h>
+
+/**
+ * ShiftChain - Chained 74HC595 shift registers on the hardware SPI port
+ *
+ * Driving LEDs straight from the port pins stops at 8 LEDs on the UNO
+ * and uses up most of the header. A chain of 74HC595s needs 3 pins for
+ * any number of outputs, and the SPI hardware clocks a byte out in 16
+ * CPU cycles at its fastest setting (fosc/2):
+ * - Pin 11 (MOSI) -> SER of the first register, its QH' -> SER of the next
+ * - Pin 13 (SCK)  -> SRCLK of every register
+ * - Pin 10 (SS)   -> RCLK (latch) of every register. SS must be an
+ *   output for the SPI to stay in master mode, so it doubles as the latch
+ *
+ * A frame is one byte per register. Byte 0 goes to the register nearest
+ * the MCU, bit b of a byte to output Qb, so frame bit i is output i along
+ * the chain. Outputs only change on the latch edge after the whole frame
+ * is shifted in, so a frame never shows half updated.
+ *
+ * Two ways to send:
+ * - write(): blocking, one burst. About 1 us per register at fosc/2
+ * - send(): non-blocking, the SPI interrupt feeds the bytes. Each byte
+ *   costs an interrupt (~50 cycles), more than the 16 cycles the
+ *   transfer itself takes at fosc/2, so this pays off at the slower SPI
+ *   clocks long wires need. A frame sent while another is in flight is
+ *   queued; only the newest queued frame is kept
+ *
+ *   ShiftChain.begin(8);                 // 8 registers, 64 outputs
+ *   ShiftChain.write(state);             // state[0..7]
+ *
+ * Owns the SPI interrupt, so do not use the SPI library in the same
+ * sketch.
+ */
+
+#ifndef SHIFT_CHAIN_MAX_BYTES
+#define SHIFT_CHAIN_MAX_BYTES 16   // 128 outputs
+#endif
+
+// SPI clock (divider of the CPU clock)
+enum ShiftClock : byte {
+  SHIFT_CLOCK_DIV2,      // 8 MHz at 16 MHz: 1 us per register
+  SHIFT_CLOCK_DIV4,
+  SHIFT_CLOCK_DIV8,
+  SHIFT_CLOCK_DIV16,
+  SHIFT_CLOCK_DIV32,
+  SHIFT_CLOCK_DIV64,
+  SHIFT_CLOCK_DIV128     // 125 kHz: 64 us per register
+};
+
+// SPI pins (PORTB)
+const byte SHIFT_LATCH_PIN = 10;
+const byte SHIFT_LATCH_MASK = 1 << 2;   // PB2 (SS)
+const byte SHIFT_MOSI_MASK = 1 << 3;    // PB3
+const byte SHIFT_SCK_MASK = 1 << 5;     // PB5
+
+class ShiftChainEngine {
+  private:
+    byte length;                 // Registers in the chain
+
+    // Double-buffered frames: the interrupt sends one, send() fills the other
+    byte frames[2][SHIFT_CHAIN_MAX_BYTES];
+    volatile byte sendingFrame;  // Buffer the interrupt is sending
+    volatile byte sendIndex;     // Byte in flight (counts down to 0)
+    volatile bool transferBusy;
+    volatile bool frameQueued;   // Other buffer is waiting to be sent
+    volatile uint16_t framesReplaced;
+
+    inline void startFrame() {
+      byte i = length - 1;
+      sendIndex = i;
+      if (i == 0) {
+        PORTB &= ~SHIFT_LATCH_MASK;
+      }
+      SPDR = frames[sendingFrame][i];
+    }
+
+  public:
+    ShiftChainEngine();
+
+    // Set up the SPI pins and port for a chain of `bytes` registers
+    void begin(byte bytes, ShiftClock clock = SHIFT_CLOCK_DIV2);
+    void end();
+
+    byte size();
+
+    // Send a frame (size() bytes) and latch it, returning when done
+    void write(const byte* data);
+
+    // Start sending a frame from the SPI interrupt and return at once.
+    // The frame is copied, so data can change straight away
+    void send(const byte* data);
+
+    // A send() is still in progress
+    bool busy();
+
+    // Queued frames overwritten by a newer send() before they went out
+    uint16_t replaced();
+
+    // Called from the SPI transfer-complete interrupt - send the next byte
+    inline void handleTransferComplete() {
+      byte i = sendIndex;
+      if (i != 0) {
+        i--;
+        sendIndex = i;
+        if (i == 0) {
+          // RCLK low while the last byte shifts in; rising edge latches
+          PORTB &= ~SHIFT_LATCH_MASK;
+        }
+        SPDR = frames[sendingFrame][i];
+        return;
+      }
+
+      // Whole frame shifted in: show it
+      PORTB |= SHIFT_LATCH_MASK;
+      if (frameQueued) {
+        frameQueued = false;
+        sendingFrame ^= 1;
+        startFrame();
+        return;
+      }
+      SPCR &= ~(1 << SPIE);
+      transferBusy = false;
+    }
+};
+
+extern ShiftChainEngine ShiftChain;
+
+#endif
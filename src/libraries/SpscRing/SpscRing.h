@@ -0,0 +1,97 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <Arduino.h>
+
+/**
+ * SpscRing - Fixed-size queue between one interrupt and the main loop
+ *
+ * Single producer (usually an ISR) and single consumer (usually loop()).
+ * Each side only writes its own index, and a byte index is read and
+ * written in one instruction on AVR, so neither side ever has to turn
+ * interrupts off:
+ * - push() writes the item first, then publishes it by moving head
+ * - pop() copies the item out first, then frees the slot by moving tail
+ *
+ * Size must be a power of two (up to 128); one slot is kept empty to
+ * tell full from empty, so the ring holds Size - 1 items.
+ */
+
+template <typename T, byte Size>
+class SpscRing {
+  static_assert(Size >= 2 && Size <= 128 && (Size & (Size - 1)) == 0,
+                "SpscRing size must be a power of two between 2 and 128");
+
+  private:
+    T items[Size];
+    volatile byte head;      // Next slot to write (producer only)
+    volatile byte tail;      // Next slot to read (consumer only)
+    volatile uint16_t drops; // Items rejected because the ring was full
+
+  public:
+    SpscRing() {
+      head = 0;
+      tail = 0;
+      drops = 0;
+    }
+
+    // Producer: add an item, returns false (and counts a drop) when full
+    bool push(const T& item) {
+      byte h = head;
+      byte next = (h + 1) & (Size - 1);
+      if (next == tail) {
+        if (drops != 0xFFFF) {
+          drops++;
+        }
+        return false;
+      }
+      items[h] = item;
+      // Compiler barrier: the item must be stored before head moves
+      asm volatile("" ::: "memory");
+      head = next;
+      return true;
+    }
+
+    // Consumer: take the oldest item, returns false when empty
+    bool pop(T& item) {
+      byte t = tail;
+      if (t == head) {
+        return false;
+      }
+      item = items[t];
+      asm volatile("" ::: "memory");
+      tail = (t + 1) & (Size - 1);
+      return true;
+    }
+
+    bool isEmpty() const {
+      return head == tail;
+    }
+
+    // Items waiting (approximate while the producer is running)
+    byte available() const {
+      return (head - tail) & (Size - 1);
+    }
+
+    static constexpr byte capacity() {
+      return Size - 1;
+    }
+
+    // Number of pushes rejected so far (consumer side)
+    uint16_t dropped() {
+      uint8_t oldSREG = SREG;
+      cli();
+      uint16_t count = drops;
+      SREG = oldSREG;
+      return count;
+    }
+
+    void clearDropped() {
+      uint8_t oldSREG = SREG;
+      cli();
+      drops = 0;
+      SREG = oldSREG;
+    }
+};
+
+#endif
@@ -0,0 +1,145 @@
+#include "TokenLog.h"
+
+/**
+ * TokenLog record encoding and COBS framing
+ */
+
+TokenLogger TokenLog;
+
+TokenLogger::TokenLogger() {
+  out = 0;
+  length = 0;
+  truncated = false;
+  lastTime = 0;
+  recordCount = 0;
+  bytesSent = 0;
+  truncatedCount = 0;
+}
+
+void TokenLogger::begin(Print& output) {
+  out = &output;
+  lastTime = millis();
+}
+
+// Append one byte, keeping the last slot free for the CRC
+void TokenLogger::put(byte value) {
+  if (length < TOKENLOG_MAX_RECORD - 1) {
+    record[length++] = value;
+  } else {
+    truncated = true;
+  }
+}
+
+// Unsigned LEB128: 7 bits per byte, high bit set on all but the last
+void TokenLogger::putVarint(uint32_t value) {
+  while (value >= 0x80) {
+    put((byte)(value | 0x80));
+    value >>= 7;
+  }
+  put((byte)value);
+}
+
+// Zigzag maps small negative and positive numbers to small varints
+void TokenLogger::putSigned(int32_t value) {
+  putVarint(((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+// 64-bit versions, kept apart so 32-bit arguments stay on 32-bit math
+void TokenLogger::putVarint64(uint64_t value) {
+  while (value >= 0x80) {
+    put((byte)(value | 0x80));
+    value >>= 7;
+  }
+  put((byte)value);
+}
+
+void TokenLogger::putSigned64(int64_t value) {
+  putVarint64(((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+void TokenLogger::add(const char* text) {
+  byte count = 0;
+  while (text[count] && count < TOKENLOG_MAX_STRING) {
+    count++;
+  }
+  put(count);
+  for (byte i = 0; i < count; i++) {
+    put((byte)text[i]);
+  }
+}
+
+void TokenLogger::add(const __FlashStringHelper* text) {
+  PGM_P p = reinterpret_cast<PGM_P>(text);
+  byte count = 0;
+  while (pgm_read_byte(p + count) && count < TOKENLOG_MAX_STRING) {
+    count++;
+  }
+  put(count);
+  for (byte i = 0; i < count; i++) {
+    put(pgm_read_byte(p + i));
+  }
+}
+
+void TokenLogger::start(uint16_t id) {
+  length = 0;
+  truncated = false;
+  put(id & 0xFF);
+  put(id >> 8);
+
+  uint32_t now = millis();
+  putVarint(now - lastTime);
+  lastTime = now;
+}
+
+// Add the CRC, COBS-encode between 0x00 delimiters and send in one write
+void TokenLogger::finish() {
+  if (truncated) {
+    truncatedCount++;
+  }
+
+  // CRC-8 (polynomial 0x07) over the record
+  byte crc = 0;
+  for (byte i = 0; i < length; i++) {
+    crc ^= record[i];
+    for (byte bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (byte)((crc << 1) ^ 0x07) : (byte)(crc << 1);
+    }
+  }
+  record[length++] = crc;
+
+  // COBS: every zero is replaced by the distance to the next zero, so
+  // the only zeros on the wire are the frame delimiters
+  byte frame[TOKENLOG_MAX_RECORD + 3];
+  byte size = 0;
+  frame[size++] = 0;           // Leading delimiter separates us from any text
+  byte codeIndex = size++;
+  byte code = 1;
+  for (byte i = 0; i < length; i++) {
+    if (record[i] == 0) {
+      frame[codeIndex] = code;
+      codeIndex = size++;
+      code = 1;
+    } else {
+      frame[size++] = record[i];
+      code++;
+    }
+  }
+  frame[codeIndex] = code;
+  frame[size++] = 0;           // Trailing delimiter
+
+  out->write(frame, size);
+  recordCount++;
+  bytesSent += size;
+}
+
+uint32_t TokenLogger::records() {
+  return recordCount;
+}
+
+uint32_t TokenLogger::bytes() {
+  return bytesSent;
+}
+
+uint16_t TokenLogger::truncatedRecords() {
+  return truncatedCount;
+}
@@ -0,0 +1,143 @@
+#ifndef TOKEN_LOG_H
+#define TOKEN_LOG_H
+
+#include <Arduino.h>
+
+/**
+ * TokenLog - Compact binary logging with host-side format strings
+ *
+ * Human-readable logging costs flash for every string, UART time for
+ * every character and CPU time for number formatting. TokenLog sends
+ * a small binary record instead and the host rebuilds the text:
+ *
+ *   TLOG("Uptime: %lu seconds, cycles: %u", seconds, cycleCount);
+ *
+ * - The format string is hashed at compile time into a 16-bit message
+ *   ID; the string itself never reaches the board
+ * - tools/tokenlog/extract_tokens.py finds every TLOG() in the sources
+ *   and writes the ID -> format table (run automatically as a
+ *   PlatformIO pre-build script)
+ * - Record: ID (2 bytes), millis() delta since the previous record and
+ *   each argument as zigzag varints, then a CRC-8
+ * - Records are COBS-framed between 0x00 delimiters, so ordinary text
+ *   printed on the same port passes through the decoder untouched
+ *
+ * Supported format specifiers: %d %i %u %x %X %c %s (with optional
+ * hh / h / l / ll length modifiers) and %%. Arguments:
+ * - Integers up to 32 bits, signed or unsigned, are sent as a 32-bit
+ *   zigzag varint (1-5 bytes). Unsigned values of 2^31 and above travel
+ *   as negative numbers; the decoder turns them back for %u %x %X
+ * - long long / unsigned long long use a 64-bit zigzag varint (1-10
+ *   bytes); format them with ll (%lld, %llu, %llx). So does long in
+ *   host builds, where it is 64 bits, so nothing is cut off there
+ * - Strings (RAM or F()) are sent with a length byte, up to 32 chars
+ *
+ * Decode with: python3 tools/tokenlog/decode_log.py --db tokens.csv --port /dev/ttyACM0
+ */
+
+// Largest record before framing (ID + timestamp + arguments + CRC)
+const byte TOKENLOG_MAX_RECORD = 48;
+
+// Longest string argument sent
+const byte TOKENLOG_MAX_STRING = 32;
+
+#ifdef __AVR__
+static_assert(sizeof(long) == 4, "TokenLog sends long as a 32-bit varint on the AVR");
+#endif
+
+// 32-bit FNV-1a over a C string, evaluated by the compiler
+constexpr uint32_t tokenFnv1a(const char* text, uint32_t hash = 2166136261UL) {
+  return *text ? tokenFnv1a(text + 1, (hash ^ (uint8_t)*text) * 16777619UL) : hash;
+}
+
+// Fold the 32-bit hash to the 16-bit message ID
+constexpr uint16_t tokenFold(uint32_t hash) {
+  return (uint16_t)((hash >> 16) ^ (hash & 0xFFFF));
+}
+
+constexpr uint16_t tokenHash(const char* text) {
+  return tokenFold(tokenFnv1a(text));
+}
+
+// Forces the hash to be a compile-time constant
+template <uint16_t Id>
+struct TokenId {
+  static const uint16_t value = Id;
+};
+
+#define TOKEN(format) (TokenId<tokenHash(format)>::value)
+#define TLOG(format, ...) TokenLog.log(TOKEN(format), ##__VA_ARGS__)
+
+class TokenLogger {
+  private:
+    Print* out;
+    byte record[TOKENLOG_MAX_RECORD];
+    byte length;
+    bool truncated;            // Current record ran out of room
+    uint32_t lastTime;         // millis() of the previous record
+    uint32_t recordCount;
+    uint32_t bytesSent;
+    uint16_t truncatedCount;
+
+    void put(byte value);
+    void putVarint(uint32_t value);
+    void putSigned(int32_t value);
+    void putVarint64(uint64_t value);
+    void putSigned64(int64_t value);
+    void start(uint16_t id);
+    void finish();
+
+    // Argument encoders, chosen by type
+    void add(char value)               { putSigned(value); }
+    void add(signed char value)        { putSigned(value); }
+    void add(unsigned char value)      { putSigned(value); }
+    void add(int value)                { putSigned(value); }
+    void add(unsigned int value)       { putSigned((int32_t)value); }
+#ifdef __AVR__
+    void add(long value)               { putSigned(value); }
+    void add(unsigned long value)      { putSigned((int32_t)value); }
+#else
+    // long is 64 bits on most hosts (NativeHal builds): send all of it
+    void add(long value)               { putSigned64(value); }
+    void add(unsigned long value)      { putSigned64((int64_t)value); }
+#endif
+    void add(long long value)          { putSigned64(value); }
+    void add(unsigned long long value) { putSigned64((int64_t)value); }
+    void add(bool value)               { putSigned(value ? 1 : 0); }
+    void add(const char* text);
+    void add(const __FlashStringHelper* text);
+
+    void addAll() {}
+
+    template <typename T, typename... Rest>
+    void addAll(T first, Rest... rest) {
+      add(first);
+      addAll(rest...);
+    }
+
+  public:
+    TokenLogger();
+
+    // Send records to a Print (Serial, Uart, ...)
+    void begin(Print& output);
+
+    // Encode and send one record (use the TLOG macro)
+    template <typename... Args>
+    void log(uint16_t id, Args... args) {
+      if (!out) {
+        return;
+      }
+      start(id);
+      addAll(args...);
+      finish();
+    }
+
+    // Statistics
+    uint32_t records();
+    uint32_t bytes();
+    uint16_t truncatedRecords();
+};
+
+extern TokenLogger TokenLog;
+
+#endif
@@ -0,0 +1,239 @@
+#include "UartSerial.h"
+
+/**
+ * UartSerial implementation (USART0)
+ */
+
+UartSerial Uart;
+
+ISR(USART_UDRE_vect) {
+  Uart.handleTxReady();
+}
+
+ISR(USART_RX_vect) {
+  Uart.handleRx();
+}
+
+UartSerial::UartSerial() {
+  txHead = 0;
+  txTail = 0;
+  rxHead = 0;
+  rxTail = 0;
+  policy = UART_OVERFLOW_DROP;
+  discardLine = false;
+  lineOpen = false;
+  txStarted = false;
+  clearStats();
+}
+
+void UartSerial::begin(unsigned long baud, bool doubleSpeed) {
+  // Baud divisor, rounded to nearest (same formula as the core)
+  uint16_t divisor;
+  if (doubleSpeed) {
+    UCSR0A = (1 << U2X0);
+    divisor = (F_CPU / 4 / baud - 1) / 2;
+  } else {
+    UCSR0A = 0;
+    divisor = (F_CPU / 8 / baud - 1) / 2;
+  }
+  UBRR0H = divisor >> 8;
+  UBRR0L = divisor & 0xFF;
+
+  // 8 data bits, no parity, 1 stop bit
+  UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);
+  UCSR0B = (1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0);
+  txStarted = false;
+}
+
+void UartSerial::end() {
+  flush();
+  UCSR0B = 0;
+  txHead = txTail = 0;
+  rxHead = rxTail = 0;
+}
+
+void UartSerial::setOverflowPolicy(UartOverflowPolicy overflowPolicy) {
+  policy = overflowPolicy;
+}
+
+// Bytes waiting in the TX ring (txTail moves in the interrupt)
+uint16_t UartSerial::txUsed() {
+  uint8_t oldSREG = SREG;
+  cli();
+  uint16_t used = (txHead + UART_TX_BUFFER_SIZE - txTail) % UART_TX_BUFFER_SIZE;
+  SREG = oldSREG;
+  return used;
+}
+
+int UartSerial::available() {
+  uint8_t oldSREG = SREG;
+  cli();
+  int count = (rxHead + UART_RX_BUFFER_SIZE - rxTail) % UART_RX_BUFFER_SIZE;
+  SREG = oldSREG;
+  return count;
+}
+
+int UartSerial::peek() {
+  if (available() == 0) {
+    return -1;
+  }
+  return rxBuffer[rxTail];
+}
+
+int UartSerial::read() {
+  if (available() == 0) {
+    return -1;
+  }
+  byte value = rxBuffer[rxTail];
+  uint8_t oldSREG = SREG;
+  cli();
+  rxTail = (rxTail + 1) % UART_RX_BUFFER_SIZE;
+  SREG = oldSREG;
+  return value;
+}
+
+int UartSerial::availableForWrite() {
+  return (UART_TX_BUFFER_SIZE - 1) - txUsed();
+}
+
+// Wait until every queued byte has left the UART
+void UartSerial::flush() {
+  if (!txStarted) {
+    return;
+  }
+  while ((UCSR0B & (1 << UDRIE0)) || !(UCSR0A & (1 << TXC0))) {
+    // With interrupts off the UDRE interrupt cannot run - poll it here
+    if (!(SREG & 0x80) && (UCSR0A & (1 << UDRE0))) {
+      handleTxReady();
+    }
+  }
+}
+
+// Read the interrupt-owned tail index atomically
+uint16_t UartSerial::txTailSnapshot() {
+  uint8_t oldSREG = SREG;
+  cli();
+  uint16_t tail = txTail;
+  SREG = oldSREG;
+  return tail;
+}
+
+// Hand new bytes to the interrupt and make sure it is draining the ring
+void UartSerial::publishTx(uint16_t head) {
+  uint8_t oldSREG = SREG;
+  cli();
+  txHead = head;
+  // Clear TXC (write 1) so flush() can tell when the last byte is out
+  UCSR0A = (UCSR0A & ((1 << U2X0) | (1 << MPCM0))) | (1 << TXC0);
+  UCSR0B |= (1 << UDRIE0);
+  SREG = oldSREG;
+}
+
+size_t UartSerial::write(uint8_t value) {
+  return write(&value, 1);
+}
+
+size_t UartSerial::write(const uint8_t* buffer, size_t size) {
+  if (size == 0) {
+    return 0;
+  }
+
+  bool endsLine = (buffer[size - 1] == '\n');
+  bool endsFrame = (buffer[size - 1] == 0);   // TokenLog frame delimiter
+
+  // Finish dropping a line that overflowed earlier (frames still go out)
+  if (discardLine && !endsFrame) {
+    txDroppedBytes += size;
+    if (endsLine) {
+      discardLine = false;
+    }
+    return size;
+  }
+
+  // A write that leaves a line open keeps room to end that line later
+  bool leavesLineOpen = endsFrame ? lineOpen : !endsLine;
+  uint16_t reserve = leavesLineOpen ? UART_LINE_END_RESERVE : 0;
+  uint16_t space = (UART_TX_BUFFER_SIZE - 1) - txUsed();
+  if (size + reserve > space && policy == UART_OVERFLOW_DROP) {
+    // No room: drop this write, and for text the rest of its line
+    txDroppedBytes += size;
+    txDroppedWrites++;
+    if (endsFrame) {
+      return size;
+    }
+    if (lineOpen) {
+      // The start of the line is queued: end it in the reserved room
+      queueTx((const uint8_t*)"\r\n", 2);
+      lineOpen = false;
+    }
+    discardLine = !endsLine;
+    return size;
+  }
+
+  queueTx(buffer, size);
+  lineOpen = leavesLineOpen;
+  return size;
+}
+
+// Copy bytes into the TX ring (waiting for room if it is full)
+void UartSerial::queueTx(const uint8_t* buffer, size_t size) {
+  // Fill the ring with a local head and publish it in one step, so the
+  // interrupt never sees a half-written 16-bit index
+  uint16_t head = txHead;
+  uint16_t tail = txTailSnapshot();
+  for (size_t i = 0; i < size; i++) {
+    uint16_t next = (head + 1) % UART_TX_BUFFER_SIZE;
+
+    // Looks full: re-check, and under the blocking policy publish what
+    // we have and wait for the interrupt to make room
+    if (next == tail) {
+      publishTx(head);
+      while (next == (tail = txTailSnapshot())) {
+        // With interrupts off the UDRE interrupt cannot run - poll it here
+        if (!(SREG & 0x80) && (UCSR0A & (1 << UDRE0))) {
+          handleTxReady();
+        }
+      }
+    }
+
+    txBuffer[head] = buffer[i];
+    head = next;
+  }
+  publishTx(head);
+
+  uint16_t used = txUsed();
+  if (used > txHighWater) {
+    txHighWater = used;
+  }
+  txStarted = true;
+}
+
+uint32_t UartSerial::droppedBytes() {
+  return txDroppedBytes;
+}
+
+uint16_t UartSerial::droppedWrites() {
+  return txDroppedWrites;
+}
+
+uint16_t UartSerial::highWater() {
+  return txHighWater;
+}
+
+uint16_t UartSerial::rxDropped() {
+  uint8_t oldSREG = SREG;
+  cli();
+  uint16_t count = rxDroppedBytes;
+  SREG = oldSREG;
+  return count;
+}
+
+void UartSerial::clearStats() {
+  txDroppedBytes = 0;
+  txDroppedWrites = 0;
+  txHighWater = 0;
+  uint8_t oldSREG = SREG;
+  cli();
+  rxDroppedBytes = 0;
+  SREG = oldSREG;
+}
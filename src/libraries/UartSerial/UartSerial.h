@@ -0,0 +1,125 @@
+#ifndef UART_SERIAL_H
+#define UART_SERIAL_H
+
+#include <Arduino.h>
+
+/**
+ * UartSerial - Interrupt-driven UART with a large TX buffer that never blocks
+ *
+ * The core Serial object has a 64-byte transmit buffer. Once a burst of
+ * prints fills it, Serial.print() waits for the UART, which stalls
+ * loop() and skews any timing being measured. UartSerial is a drop-in
+ * replacement (same print/println/read API, it is a Stream):
+ * - TX ring size set at build time (UART_TX_BUFFER_SIZE, default 256)
+ * - U2X double-speed mode for a closer 115200 baud on 16 MHz boards
+ * - Overflow policy: block like Serial, or drop and count
+ * - When dropping, the rest of the line is dropped too, so output
+ *   resumes on a clean line instead of a torn one. A line already
+ *   partly queued is ended with "\r\n" (writes that leave a line open
+ *   keep 2 bytes free for it), so the next line never joins it
+ * - A write ending in 0x00 (a TokenLog COBS frame) is a whole record:
+ *   it is sent or dropped as one and never starts or ends a line drop
+ *
+ *   Uart.begin(115200);
+ *   Uart.println(F("Hello"));   // Returns immediately
+ *
+ * Owns the USART0 interrupts, so do not use the core Serial object in
+ * the same sketch.
+ */
+
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE 256
+#endif
+
+// Room kept for ending a partly queued line
+const uint16_t UART_LINE_END_RESERVE = 2;
+
+#ifndef UART_RX_BUFFER_SIZE
+#define UART_RX_BUFFER_SIZE 64
+#endif
+
+// What write() does when the TX buffer has no room
+enum UartOverflowPolicy : byte {
+  UART_OVERFLOW_DROP,    // Drop the write (and the rest of its line), count it
+  UART_OVERFLOW_BLOCK    // Wait for space, like the core Serial
+};
+
+class UartSerial : public Stream {
+  private:
+    // Transmit ring: written by the main loop, drained by the UDRE interrupt
+    byte txBuffer[UART_TX_BUFFER_SIZE];
+    volatile uint16_t txHead;
+    volatile uint16_t txTail;
+
+    // Receive ring: written by the RX interrupt, read by the main loop
+    byte rxBuffer[UART_RX_BUFFER_SIZE];
+    volatile uint16_t rxHead;
+    volatile uint16_t rxTail;
+
+    UartOverflowPolicy policy;
+    bool discardLine;          // Dropping until the end of the current line
+    bool lineOpen;             // Part of the current line is queued (no '\n' yet)
+    bool txStarted;            // Something has been sent since begin()
+    uint32_t txDroppedBytes;
+    uint16_t txDroppedWrites;
+    uint16_t txHighWater;      // Most bytes ever waiting in the TX ring
+    uint16_t rxDroppedBytes;
+
+    uint16_t txUsed();
+    uint16_t txTailSnapshot();
+    void publishTx(uint16_t head);
+    void queueTx(const uint8_t* buffer, size_t size);
+
+  public:
+    UartSerial();
+
+    // Start the UART; doubleSpeed enables U2X
+    void begin(unsigned long baud, bool doubleSpeed = true);
+    void end();
+
+    void setOverflowPolicy(UartOverflowPolicy overflowPolicy);
+
+    // Stream / Print interface
+    virtual int available();
+    virtual int peek();
+    virtual int read();
+    virtual int availableForWrite();
+    virtual void flush();
+    virtual size_t write(uint8_t value);
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    using Print::write;
+
+    // Overflow statistics
+    uint32_t droppedBytes();
+    uint16_t droppedWrites();
+    uint16_t highWater();
+    uint16_t rxDropped();
+    void clearStats();
+
+    // Interrupt handlers
+    inline void handleTxReady() {
+      uint16_t tail = txTail;
+      if (tail == txHead) {
+        // Nothing left - stop the data-register-empty interrupt
+        UCSR0B &= ~(1 << UDRIE0);
+        return;
+      }
+      UDR0 = txBuffer[tail];
+      txTail = (tail + 1) % UART_TX_BUFFER_SIZE;
+    }
+
+    inline void handleRx() {
+      byte value = UDR0;
+      uint16_t next = (rxHead + 1) % UART_RX_BUFFER_SIZE;
+      if (next == rxTail) {
+        rxDroppedBytes++;
+        return;
+      }
+      rxBuffer[rxHead] = value;
+      rxHead = next;
+    }
+};
+
+extern UartSerial Uart;
+
+#endif
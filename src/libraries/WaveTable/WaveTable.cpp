@@ -0,0 +1,122 @@
+#include "WaveTable.h"
+
+/**
+ * WaveTable lookup tables and interpolated sampling
+ *
+ * Each table is a separate PROGMEM object, so tables a sketch never
+ * references are removed by the linker (--gc-sections).
+ */
+
+const uint8_t WAVE_SINE8[WAVE_TABLE_SIZE] PROGMEM = {
+  128, 131, 134, 137, 140, 143, 146, 149, 152, 155, 158, 162, 165, 167, 170, 173,
+  176, 179, 182, 185, 188, 190, 193, 196, 198, 201, 203, 206, 208, 211, 213, 215,
+  218, 220, 222, 224, 226, 228, 230, 232, 234, 235, 237, 238, 240, 241, 243, 244,
+  245, 246, 248, 249, 250, 250, 251, 252, 253, 253, 254, 254, 254, 255, 255, 255,
+  255, 255, 255, 255, 254, 254, 254, 253, 253, 252, 251, 250, 250, 249, 248, 246,
+  245, 244, 243, 241, 240, 238, 237, 235, 234, 232, 230, 228, 226, 224, 222, 220,
+  218, 215, 213, 211, 208, 206, 203, 201, 198, 196, 193, 190, 188, 185, 182, 179,
+  176, 173, 170, 167, 165, 162, 158, 155, 152, 149, 146, 143, 140, 137, 134, 131,
+  128, 124, 121, 118, 115, 112, 109, 106, 103, 100,  97,  93,  90,  88,  85,  82,
+   79,  76,  73,  70,  67,  65,  62,  59,  57,  54,  52,  49,  47,  44,  42,  40,
+   37,  35,  33,  31,  29,  27,  25,  23,  21,  20,  18,  17,  15,  14,  12,  11,
+   10,   9,   7,   6,   5,   5,   4,   3,   2,   2,   1,   1,   1,   0,   0,   0,
+    0,   0,   0,   0,   1,   1,   1,   2,   2,   3,   4,   5,   5,   6,   7,   9,
+   10,  11,  12,  14,  15,  17,  18,  20,  21,  23,  25,  27,  29,  31,  33,  35,
+   37,  40,  42,  44,  47,  49,  52,  54,  57,  59,  62,  65,  67,  70,  73,  76,
+   79,  82,  85,  88,  90,  93,  97, 100, 103, 106, 109, 112, 115, 118, 121, 124
+};
+
+const uint16_t WAVE_SINE16[WAVE_TABLE_SIZE] PROGMEM = {
+  32768, 33572, 34375, 35178, 35979, 36779, 37575, 38369,
+  39160, 39947, 40729, 41507, 42279, 43046, 43807, 44560,
+  45307, 46046, 46777, 47500, 48214, 48919, 49613, 50298,
+  50972, 51635, 52287, 52927, 53555, 54170, 54773, 55362,
+  55938, 56499, 57047, 57579, 58097, 58600, 59087, 59558,
+  60013, 60451, 60873, 61278, 61666, 62036, 62389, 62724,
+  63041, 63339, 63620, 63881, 64124, 64348, 64553, 64739,
+  64905, 65053, 65180, 65289, 65377, 65446, 65496, 65525,
+  65535, 65525, 65496, 65446, 65377, 65289, 65180, 65053,
+  64905, 64739, 64553, 64348, 64124, 63881, 63620, 63339,
+  63041, 62724, 62389, 62036, 61666, 61278, 60873, 60451,
+  60013, 59558, 59087, 58600, 58097, 57579, 57047, 56499,
+  55938, 55362, 54773, 54170, 53555, 52927, 52287, 51635,
+  50972, 50298, 49613, 48919, 48214, 47500, 46777, 46046,
+  45307, 44560, 43807, 43046, 42279, 41507, 40729, 39947,
+  39160, 38369, 37575, 36779, 35979, 35178, 34375, 33572,
+  32768, 31963, 31160, 30357, 29556, 28756, 27960, 27166,
+  26375, 25588, 24806, 24028, 23256, 22489, 21728, 20975,
+  20228, 19489, 18758, 18035, 17321, 16616, 15922, 15237,
+  14563, 13900, 13248, 12608, 11980, 11365, 10762, 10173,
+   9597,  9036,  8488,  7956,  7438,  6935,  6448,  5977,
+   5522,  5084,  4662,  4257,  3869,  3499,  3146,  2811,
+   2494,  2196,  1915,  1654,  1411,  1187,   982,   796,
+    630,   482,   355,   246,   158,    89,    39,    10,
+      0,    10,    39,    89,   158,   246,   355,   482,
+    630,   796,   982,  1187,  1411,  1654,  1915,  2196,
+   2494,  2811,  3146,  3499,  3869,  4257,  4662,  5084,
+   5522,  5977,  6448,  6935,  7438,  7956,  8488,  9036,
+   9597, 10173, 10762, 11365, 11980, 12608, 13248, 13900,
+  14563, 15237, 15922, 16616, 17321, 18035, 18758, 19489,
+  20228, 20975, 21728, 22489, 23256, 24028, 24806, 25588,
+  26375, 27166, 27960, 28756, 29556, 30357, 31160, 31963
+};
+
+const uint8_t WAVE_TRIANGLE8[WAVE_TABLE_SIZE] PROGMEM = {
+    0,   2,   4,   6,   8,  10,  12,  14,  16,  18,  20,  22,  24,  26,  28,  30,
+   32,  34,  36,  38,  40,  42,  44,  46,  48,  50,  52,  54,  56,  58,  60,  62,
+   64,  66,  68,  70,  72,  74,  76,  78,  80,  82,  84,  86,  88,  90,  92,  94,
+   96,  98, 100, 102, 104, 106, 108, 110, 112, 114, 116, 118, 120, 122, 124, 126,
+  128, 130, 132, 134, 136, 138, 140, 142, 144, 146, 148, 150, 152, 154, 156, 158,
+  160, 162, 164, 166, 168, 170, 172, 174, 176, 178, 180, 182, 184, 186, 188, 190,
+  192, 194, 196, 198, 200, 202, 204, 206, 208, 210, 212, 214, 216, 218, 220, 222,
+  224, 226, 228, 230, 232, 234, 236, 238, 240, 242, 244, 246, 248, 250, 252, 254,
+  255, 253, 251, 249, 247, 245, 243, 241, 239, 237, 235, 233, 231, 229, 227, 225,
+  223, 221, 219, 217, 215, 213, 211, 209, 207, 205, 203, 201, 199, 197, 195, 193,
+  191, 189, 187, 185, 183, 181, 179, 177, 175, 173, 171, 169, 167, 165, 163, 161,
+  159, 157, 155, 153, 151, 149, 147, 145, 143, 141, 139, 137, 135, 133, 131, 129,
+  127, 125, 123, 121, 119, 117, 115, 113, 111, 109, 107, 105, 103, 101,  99,  97,
+   95,  93,  91,  89,  87,  85,  83,  81,  79,  77,  75,  73,  71,  69,  67,  65,
+   63,  61,  59,  57,  55,  53,  51,  49,  47,  45,  43,  41,  39,  37,  35,  33,
+   31,  29,  27,  25,  23,  21,  19,  17,  15,  13,  11,   9,   7,   5,   3,   1
+};
+
+const uint8_t WAVE_GAMMA8[WAVE_TABLE_SIZE] PROGMEM = {
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+    1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+    3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+    6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+   12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+   20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+   30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+   42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+   56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+   73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+   91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+  113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+  137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+  163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+  192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+  223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255
+};
+
+// 16-bit sample with linear interpolation using the phase fraction
+uint16_t waveSample16(WaveShape shape, uint16_t phase) {
+  uint8_t index = phase >> 8;
+  uint8_t fraction = phase & 0xFF;
+  uint8_t nextIndex = index + 1;  // Wraps to 0 at the end of the table
+
+  uint16_t a;
+  uint16_t b;
+  if (shape == WAVE_TRIANGLE) {
+    // Scale the 8-bit triangle up to 16 bits (255 -> 65535)
+    a = pgm_read_byte(&WAVE_TRIANGLE8[index]) * 257U;
+    b = pgm_read_byte(&WAVE_TRIANGLE8[nextIndex]) * 257U;
+  } else {
+    a = pgm_read_word(&WAVE_SINE16[index]);
+    b = pgm_read_word(&WAVE_SINE16[nextIndex]);
+  }
+
+  // a + (b - a) * fraction / 256, done in signed 32-bit to keep the sign
+  int32_t delta = (int32_t)b - (int32_t)a;
+  return (uint16_t)(a + ((delta * fraction) >> 8));
+}
@@ -0,0 +1,70 @@
+#ifndef WAVE_TABLE_H
+#define WAVE_TABLE_H
+
+#include <stdint.h>
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#else
+// Host builds (benchmarks) keep the tables in normal memory
+#ifndef PROGMEM
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#endif
+#endif
+
+/**
+ * WaveTable - Flash-resident waveform lookup tables for LED effects
+ *
+ * Replaces per-step floating point sin() with a table lookup:
+ * - 256-entry sine, triangle and gamma curves stored in PROGMEM
+ * - Phase is a 16-bit fixed-point accumulator (8.8 format):
+ *   the high byte selects the table entry, the low byte is the
+ *   fraction used for interpolation by the 16-bit lookup
+ * - A full period is 65536 phase units, so wrap-around is free
+ *
+ * Tables are generated by tools/wavetable/gen_wavetables.py.
+ */
+
+const uint16_t WAVE_TABLE_SIZE = 256;
+
+// Phase increment that advances exactly one table entry per step
+const uint16_t WAVE_PHASE_ONE_STEP = 256;
+
+// Available waveform shapes
+enum WaveShape : uint8_t {
+  WAVE_SINE,       // Smooth sine, 0-255 (midpoint 128)
+  WAVE_TRIANGLE,   // Linear ramp up then down, 0-255
+  WAVE_SHAPE_COUNT
+};
+
+// Raw tables (defined in WaveTable.cpp)
+extern const uint8_t WAVE_SINE8[WAVE_TABLE_SIZE] PROGMEM;
+extern const uint16_t WAVE_SINE16[WAVE_TABLE_SIZE] PROGMEM;
+extern const uint8_t WAVE_TRIANGLE8[WAVE_TABLE_SIZE] PROGMEM;
+extern const uint8_t WAVE_GAMMA8[WAVE_TABLE_SIZE] PROGMEM;
+
+// 8-bit sample at the given phase (no interpolation, one flash read)
+inline uint8_t waveSample8(WaveShape shape, uint16_t phase) {
+  uint8_t index = phase >> 8;
+  if (shape == WAVE_TRIANGLE) {
+    return pgm_read_byte(&WAVE_TRIANGLE8[index]);
+  }
+  return pgm_read_byte(&WAVE_SINE8[index]);
+}
+
+// 16-bit sample at the given phase, linearly interpolated between entries
+uint16_t waveSample16(WaveShape shape, uint16_t phase);
+
+// Gamma-correct a linear brightness value for perceptually even fades
+inline uint8_t gamma8(uint8_t level) {
+  return pgm_read_byte(&WAVE_GAMMA8[level]);
+}
+
+// Phase offset that spreads `count` outputs evenly over one period
+inline uint16_t wavePhaseOffset(uint8_t index, uint8_t count) {
+  return (uint16_t)(((uint32_t)index << 16) / count);
+}
+
+#endif
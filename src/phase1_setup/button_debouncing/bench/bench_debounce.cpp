@@ -0,0 +1,86 @@
+#include <NativeHal.h>
+#include <MicroBench.h>
+#include <PortDebouncer.h>
+#include "DebounceMethods.h"
+
+/**
+ * Debounce Strategy Benchmark (host)
+ *
+ * Feeds the same synthetic button signal to each debounce strategy and
+ * reports the cost per sample plus the number of debounced changes.
+ * The signal is a press every 200 samples with 2-12 bounce toggles
+ * spread over the 8 samples after each edge. The time and counter
+ * debouncers should report exactly two changes per press; the
+ * vertical-counter PortDebouncer only waits 4 samples, so some bounce
+ * gets through. If a count moves, the strategy's behaviour changed, not
+ * just its speed.
+ *
+ * PortDebouncer filters 8 pins per update(), so its figure covers a
+ * whole port.
+ *
+ * Run with: pio run -e native -t exec
+ */
+
+const uint32_t SAMPLES = 200000;
+const uint32_t PRESS_PERIOD = 200;   // Samples from one press to the next
+const uint32_t HOLD_SAMPLES = 100;   // Samples the button stays down
+const uint32_t WINDOW_TICKS = 20;    // Time debouncer window (samples)
+const byte REQUIRED_COUNT = 5;       // Counter debouncer readings
+
+static byte signal[SAMPLES];
+static volatile uint32_t sink;
+
+// Button signal: idle HIGH, LOW while held, random bounce after each edge
+static uint32_t buildSignal() {
+  randomSeed(12345);
+  for (uint32_t i = 0; i < SAMPLES; i++) {
+    uint32_t phase = i % PRESS_PERIOD;
+    signal[i] = (phase >= 50 && phase < 50 + HOLD_SAMPLES) ? LOW : HIGH;
+  }
+  for (uint32_t edge = 50; edge < SAMPLES; edge += PRESS_PERIOD) {
+    uint32_t bounces = random(2, 13);
+    for (uint32_t k = 0; k < bounces; k++) {
+      uint32_t press = edge + random(8);
+      uint32_t release = edge + HOLD_SAMPLES + random(8);
+      if (press < SAMPLES) {
+        signal[press] ^= 1;
+      }
+      if (release < SAMPLES) {
+        signal[release] ^= 1;
+      }
+    }
+  }
+  return SAMPLES / PRESS_PERIOD;
+}
+
+int main() {
+  uint32_t presses = buildSignal();
+  MicroBench bench("Debounce strategies");
+
+  TimeDebouncer timeDebouncer(WINDOW_TICKS, HIGH);
+  uint32_t changes = 0;
+  bench.run("time window", SAMPLES,
+            [&] { timeDebouncer = TimeDebouncer(WINDOW_TICKS, HIGH); changes = 0; },
+            [&](uint32_t i) { changes += timeDebouncer.update(signal[i], i); });
+  bench.note("time window changes", changes, "");
+
+  CounterDebouncer counterDebouncer(REQUIRED_COUNT, HIGH);
+  bench.run("counter (integrator)", SAMPLES,
+            [&] { counterDebouncer = CounterDebouncer(REQUIRED_COUNT, HIGH); changes = 0; },
+            [&](uint32_t i) { changes += counterDebouncer.update(signal[i]); });
+  bench.note("counter changes", changes, "");
+
+  // Same signal on all 8 bits of a port
+  PortDebouncer portDebouncer;
+  bench.run("vertical counter (8 pins)", SAMPLES,
+            [&] { portDebouncer = PortDebouncer(); changes = 0; },
+            [&](uint32_t i) {
+              byte toggled = portDebouncer.update(signal[i] ? 0xFF : 0x00);
+              changes += (toggled & 0x01);
+            });
+  bench.note("vertical counter changes", changes, "");
+
+  bench.note("expected changes", presses * 2.0, "");
+  sink = changes;
+  return 0;
+}
@@ -0,0 +1,101 @@
+#ifndef DEBOUNCE_METHODS_H
+#define DEBOUNCE_METHODS_H
+
+#include <Arduino.h>
+#include <Debouncer.h>
+
+/**
+ * DebounceMethods - The debounce strategies compared by this sketch
+ *
+ * Both work in "sample time": they are fed one reading per sample tick
+ * (from the InputSampler interrupt), so their timing no longer depends
+ * on how long loop() takes. The time and counter methods are the
+ * DebounceWindow and DebounceCount logic from the Debouncer library with
+ * the window or count set at run time (the 'd' command changes it).
+ */
+
+// Method 1: Time-based - accept a level once it has been stable for a window
+class TimeDebouncer {
+  private:
+    DebounceWindow<uint16_t> debounce;  // Low 16 bits of the tick
+    uint16_t window;       // Stable time needed, in ticks (up to 32767)
+
+  public:
+    TimeDebouncer(uint16_t windowTicks, byte initialState);
+
+    // Feed one reading; returns true when the debounced state changes
+    bool update(byte reading, uint32_t tick);
+
+    byte getState() const;
+    void setWindow(uint16_t windowTicks);
+};
+
+// Method 2: Counter-based (integrator) - accept after N differing readings in a row
+class CounterDebouncer {
+  private:
+    DebounceCount debounce;
+    byte maxCount;         // Readings needed to accept a change (up to 127)
+
+  public:
+    CounterDebouncer(byte requiredCount, byte initialState);
+
+    // Feed one reading; returns true when the integrated state changes
+    bool update(byte reading);
+
+    byte getState() const;
+};
+
+// Method 1, adaptive: a time window sized from the bounce actually seen
+//
+// Most switches settle within a few milliseconds, so a fixed 50 ms
+// window costs every press far more latency than it needs. This keeps a
+// running estimate of the 95th percentile of burst length (first to last
+// raw change) and uses a window of twice that, between minWindow and
+// maxWindow ticks. It starts at maxWindow and shrinks as presses come in.
+// - A burst counts as over once it has been quiet for longer than
+//   maxWindow ticks, so a short window never cuts the measurement short
+// - If the input changes again after a burst was already accepted, the
+//   window was too short: the estimate jumps straight to the burst
+//   length so far ("regrow"), instead of creeping up over many presses
+// - The estimate moves by 1/32 of itself per burst: up 19 steps when a
+//   burst is longer, down 1 when shorter, which settles where 95% of
+//   bursts are shorter
+class AdaptiveDebouncer {
+  private:
+    byte lastReading;      // Previous raw reading
+    byte state;            // Current debounced state
+    bool inBurst;          // Changes seen, not yet maxWindow ticks of quiet
+    bool accepted;         // The current burst already changed state
+    uint32_t burstStart;   // Tick of the burst's first change
+    uint32_t lastChange;   // Tick of the last raw change
+    uint32_t estimate;     // p95 burst length, in 1/16 ticks (up to maxWindow)
+    uint16_t window;       // Stable time needed, in ticks
+    uint16_t minWindow;
+    uint16_t maxWindow;
+    uint32_t burstCount;   // Bursts measured
+    uint16_t regrowCount;  // Times the window turned out too short
+
+    uint32_t toEstimate(uint32_t ticks) const;
+    void recordBurst(uint32_t length);
+    void updateWindow();
+
+  public:
+    AdaptiveDebouncer(uint16_t minTicks, uint16_t maxTicks, byte initialState);
+
+    // Feed one reading; returns true when the debounced state changes
+    bool update(byte reading, uint32_t tick);
+
+    byte getState() const;
+
+    // Force the state (for example after switching methods); keeps what
+    // has been learned about the switch
+    void setState(byte level);
+
+    // Statistics
+    uint16_t getWindow() const;          // Current window, ticks
+    uint16_t getBounceEstimate() const;  // p95 burst length, ticks (rounded up)
+    uint32_t bursts() const;
+    uint16_t regrows() const;
+};
+
+#endif
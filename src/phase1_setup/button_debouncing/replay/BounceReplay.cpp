@@ -0,0 +1,104 @@
+#include "BounceReplay.h"
+#include <algorithm>
+
+/**
+ * Trace replay and scoring
+ */
+
+ReplayStats::ReplayStats() {
+  traces = 0;
+  transitions = 0;
+  missed = 0;
+  falseTriggers = 0;
+  tracesWithFalse = 0;
+}
+
+void replayTrace(const BounceTrace& trace, ReplayTarget& target,
+                 const ReplayConfig& config, uint32_t phaseUs, ReplayStats& stats) {
+  std::vector<TraceTransition> truth = settledTransitions(trace, config.quietUs);
+  uint32_t firstEdge = trace.edges.front().time;
+  uint32_t start = firstEdge > config.leadInUs ? firstEdge - config.leadInUs : 0;
+  uint32_t end = trace.edges.back().time + config.tailUs;
+
+  byte level = trace.initialLevel();
+  target.reset(level);
+
+  size_t nextEdge = 0;
+  size_t nextTruth = 0;       // First transition not yet reached
+  bool detected = true;       // The current transition has been reported
+  uint32_t falseBefore = stats.falseTriggers;
+  byte settledSamples = 0;    // Readings in a row that matched the state
+
+  uint32_t tick = 0;
+  uint32_t now = start + phaseUs;
+  while (now <= end) {
+    // Pin level at this sample
+    while (nextEdge < trace.edges.size() && trace.edges[nextEdge].time <= now) {
+      level = trace.edges[nextEdge].level;
+      nextEdge++;
+    }
+    // Entering the next transition's window
+    while (nextTruth < truth.size() && truth[nextTruth].time <= now) {
+      if (!detected) {
+        stats.missed++;
+      }
+      detected = false;
+      nextTruth++;
+    }
+
+    if (target.update(level, tick)) {
+      settledSamples = 0;
+      if (nextTruth > 0 && !detected && target.state() == truth[nextTruth - 1].level) {
+        const TraceTransition& transition = truth[nextTruth - 1];
+        uint32_t latency = now - transition.time;
+        if (transition.level == LOW) {
+          stats.pressLatency.push_back(latency);
+        } else {
+          stats.releaseLatency.push_back(latency);
+        }
+        detected = true;
+      } else {
+        stats.falseTriggers++;
+      }
+    } else if (level != target.state()) {
+      settledSamples = 0;
+    } else if (settledSamples < 2) {
+      settledSamples++;
+    }
+
+    // Settled: nothing happens before the next edge, so go straight to
+    // the first sample after it
+    if (settledSamples == 2 && target.skipsSettled()) {
+      if (nextEdge >= trace.edges.size()) {
+        break;
+      }
+      uint32_t ahead = trace.edges[nextEdge].time - now;
+      uint32_t samples = (ahead + config.samplePeriodUs - 1) / config.samplePeriodUs;
+      now += samples * config.samplePeriodUs;
+      tick += samples;
+      settledSamples = 0;
+      continue;
+    }
+
+    now += config.samplePeriodUs;
+    tick++;
+  }
+
+  if (!detected) {
+    stats.missed++;
+  }
+  stats.traces++;
+  stats.transitions += truth.size();
+  if (stats.falseTriggers != falseBefore) {
+    stats.tracesWithFalse++;
+  }
+}
+
+uint32_t latencyPercentile(std::vector<uint32_t>& latencies, uint16_t permille) {
+  if (latencies.empty()) {
+    return 0;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  size_t rank = ((uint64_t)latencies.size() * permille + 999) / 1000;
+  return latencies[rank == 0 ? 0 : rank - 1];
+}
@@ -0,0 +1,69 @@
+#ifndef BOUNCE_REPLAY_H
+#define BOUNCE_REPLAY_H
+
+#include <Arduino.h>
+#include <vector>
+#include "BounceTrace.h"
+
+/**
+ * BounceReplay - Feed recorded bounce traces to a debouncer (host)
+ *
+ * Each trace is sampled the way InputSampler samples the real pin: one
+ * reading every sample period on a virtual clock, handed to the
+ * debouncer with the sample tick. The first sample lands at a random
+ * phase within the period, as a real press does not line up with the
+ * sampling interrupt.
+ *
+ * Every debounced change is checked against the trace's settled
+ * transitions (see BounceTrace.h):
+ * - the first change to the new level after a transition is a
+ *   detection; its latency is from the transition's first edge
+ * - any other change is a false trigger (bounce or a glitch let through)
+ * - a transition with no detection before the next one is missed
+ */
+
+// Debouncer under test, reset to a level before each trace
+class ReplayTarget {
+  public:
+    virtual ~ReplayTarget() {}
+    virtual const char* name() const = 0;
+    virtual void reset(byte level) = 0;
+
+    // One reading per tick; true when the debounced state changed
+    virtual bool update(byte reading, uint32_t tick) = 0;
+    virtual byte state() const = 0;
+
+    // True if, once two readings in a row have matched the state, more of
+    // the same reading change nothing (no timers run while settled). The
+    // replay then jumps straight to the next edge instead of sampling
+    // through the hold time, which is most of every trace.
+    virtual bool skipsSettled() const { return false; }
+};
+
+struct ReplayConfig {
+  uint32_t samplePeriodUs;   // 1000 = the sketch's 1 kHz sampling
+  uint32_t quietUs;          // Burst separation for the ground truth
+  uint32_t leadInUs;         // Sampled before the first edge
+  uint32_t tailUs;           // Sampled after the last edge
+};
+
+struct ReplayStats {
+  uint32_t traces;
+  uint32_t transitions;
+  uint32_t missed;
+  uint32_t falseTriggers;
+  uint32_t tracesWithFalse;       // Traces with at least one false trigger
+  std::vector<uint32_t> pressLatency;     // Microseconds, one per detection
+  std::vector<uint32_t> releaseLatency;
+
+  ReplayStats();
+};
+
+// Replay one trace; phaseUs (below the sample period) shifts the samples
+void replayTrace(const BounceTrace& trace, ReplayTarget& target,
+                 const ReplayConfig& config, uint32_t phaseUs, ReplayStats& stats);
+
+// Nearest-rank percentile of a latency list (sorts it); 0 if empty
+uint32_t latencyPercentile(std::vector<uint32_t>& latencies, uint16_t permille);
+
+#endif
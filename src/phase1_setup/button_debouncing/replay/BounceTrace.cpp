@@ -0,0 +1,219 @@
+#include "BounceTrace.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+/**
+ * Trace file format, ground truth and the synthetic trace generator
+ */
+
+// Generator model
+const uint32_t BOUNCE_CAP_US = 20000;         // Longest generated burst
+const double PRESS_BOUNCE_MEDIAN_US = 1500;   // Contacts closing bounce longer
+const double RELEASE_BOUNCE_MEDIAN_US = 700;
+const double BOUNCE_SIGMA = 0.9;              // Log-normal spread
+const uint32_t MAX_BOUNCE_TOGGLES = 8;        // Extra edge pairs per burst
+const uint32_t HOLD_MIN_US = 150000;
+const uint32_t HOLD_MAX_US = 600000;
+const uint32_t GLITCH_PERCENT = 5;            // Presses with a spike while held
+const uint32_t IDLE_GLITCH_PERCENT = 2;       // Presses with a spike after release
+
+byte BounceTrace::initialLevel() const {
+  return edges.empty() ? HIGH : !edges[0].level;
+}
+
+// Read one line (without the '\n'); NUL bytes of binary frames become
+// spaces so the string functions see the whole line. Longer lines are cut
+static bool readLine(FILE* in, char* line, size_t size) {
+  size_t length = 0;
+  int c = getc(in);
+  if (c == EOF) {
+    return false;
+  }
+  while (c != EOF && c != '\n') {
+    if (length + 1 < size) {
+      line[length++] = (c == 0) ? ' ' : (char)c;
+    }
+    c = getc(in);
+  }
+  line[length] = 0;
+  return true;
+}
+
+size_t readTraces(FILE* in, std::vector<BounceTrace>& traces, size_t* skipped) {
+  size_t before = traces.size();
+  size_t skippedLines = 0;
+  bool open = false;
+  char line[160];
+
+  while (readLine(in, line, sizeof(line))) {
+    char* text = line;
+    while (*text == ' ' || *text == '\t') {
+      text++;
+    }
+    if (*text == 0 || *text == '\r' || *text == '#') {
+      continue;
+    }
+
+    if (strncmp(text, "trace", 5) == 0 && (text[5] == ' ' || text[5] == '\r' || text[5] == 0)) {
+      BounceTrace trace;
+      char* label = text + 5;
+      while (*label == ' ') {
+        label++;
+      }
+      label[strcspn(label, "\r\n")] = 0;
+      trace.label = label;
+      traces.push_back(trace);
+      open = true;
+      continue;
+    }
+
+    // "<time> <level>", optionally prefixed with "edge" (anything before
+    // the prefix is ignored)
+    char* edge = strstr(text, "edge ");
+    if (edge != NULL) {
+      text = edge + 5;
+    }
+    char* end;
+    unsigned long time = strtoul(text, &end, 10);
+    if (end == text) {
+      skippedLines++;
+      continue;
+    }
+    text = end;
+    long level = strtol(text, &end, 10);
+    if (end == text || (level != 0 && level != 1)) {
+      skippedLines++;
+      continue;
+    }
+
+    if (!open) {
+      traces.push_back(BounceTrace());
+      traces.back().label = "capture";
+      open = true;
+    }
+    BounceTrace& trace = traces.back();
+    // Repeated levels (a dropped edge in a capture) carry no information
+    if (!trace.edges.empty() && trace.edges.back().level == level) {
+      continue;
+    }
+    trace.edges.push_back({(uint32_t)time, (byte)level});
+  }
+
+  // Traces without edges cannot be replayed
+  traces.erase(std::remove_if(traces.begin() + before, traces.end(),
+                              [](const BounceTrace& t) { return t.edges.empty(); }),
+               traces.end());
+  if (skipped != NULL) {
+    *skipped = skippedLines;
+  }
+  return traces.size() - before;
+}
+
+void writeTrace(FILE* out, const BounceTrace& trace) {
+  fprintf(out, "trace %s\n", trace.label.c_str());
+  for (const TraceEdge& edge : trace.edges) {
+    fprintf(out, "%lu %u\n", (unsigned long)edge.time, (unsigned)edge.level);
+  }
+}
+
+std::vector<TraceTransition> settledTransitions(const BounceTrace& trace, uint32_t quietUs) {
+  std::vector<TraceTransition> transitions;
+  byte level = trace.initialLevel();
+  size_t i = 0;
+
+  while (i < trace.edges.size()) {
+    // Extend the burst while edges keep coming within the quiet gap
+    size_t first = i;
+    while (i + 1 < trace.edges.size() &&
+           trace.edges[i + 1].time - trace.edges[i].time < quietUs) {
+      i++;
+    }
+    byte settled = trace.edges[i].level;
+    if (settled != level) {
+      transitions.push_back({trace.edges[first].time, settled});
+      level = settled;
+    }
+    i++;
+  }
+  return transitions;
+}
+
+// Synthetic traces
+
+TraceGenerator::TraceGenerator(uint32_t seed) : rng(seed) {
+  count = 0;
+}
+
+uint32_t TraceGenerator::uniform(uint32_t low, uint32_t high) {
+  return std::uniform_int_distribution<uint32_t>(low, high)(rng);
+}
+
+bool TraceGenerator::chance(uint32_t percent) {
+  return uniform(0, 99) < percent;
+}
+
+uint32_t TraceGenerator::bounceLength(double medianUs) {
+  std::lognormal_distribution<double> length(log(medianUs), BOUNCE_SIGMA);
+  double us = length(rng);
+  return us > BOUNCE_CAP_US ? BOUNCE_CAP_US : (uint32_t)us;
+}
+
+// First edge to the new level at start, then pairs of toggles spread over
+// the bounce length, ending on the new level
+void TraceGenerator::addBurst(BounceTrace& trace, uint32_t start, byte level, double medianUs) {
+  uint32_t length = bounceLength(medianUs);
+  uint32_t toggles = 2 * uniform(0, MAX_BOUNCE_TOGGLES);
+  if (length < toggles) {
+    toggles = 0;
+  }
+
+  std::vector<uint32_t> times;
+  for (uint32_t k = 0; k < toggles; k++) {
+    times.push_back(start + uniform(1, length));
+  }
+  std::sort(times.begin(), times.end());
+  // Two toggles at the same microsecond would cancel out
+  times.erase(std::unique(times.begin(), times.end()), times.end());
+  if (times.size() & 1) {
+    times.pop_back();
+  }
+
+  trace.edges.push_back({start, level});
+  for (size_t k = 0; k < times.size(); k++) {
+    trace.edges.push_back({times[k], (byte)((k & 1) ? level : !level)});
+  }
+}
+
+// Short spike away from the current level and straight back
+void TraceGenerator::addGlitch(BounceTrace& trace, uint32_t start, byte level) {
+  trace.edges.push_back({start, (byte)!level});
+  trace.edges.push_back({start + uniform(50, 2000), level});
+}
+
+BounceTrace TraceGenerator::next() {
+  BounceTrace trace;
+  char label[24];
+  snprintf(label, sizeof(label), "synthetic-%lu", (unsigned long)count++);
+  trace.label = label;
+
+  // Pull-up wiring: released HIGH, pressed LOW
+  uint32_t press = uniform(5000, 20000);
+  uint32_t hold = uniform(HOLD_MIN_US, HOLD_MAX_US);
+  uint32_t release = press + hold;
+
+  addBurst(trace, press, LOW, PRESS_BOUNCE_MEDIAN_US);
+
+  // Spikes sit mid-hold, at least TRACE_QUIET_US from either burst
+  if (chance(GLITCH_PERCENT)) {
+    addGlitch(trace, press + hold / 2 + uniform(0, 10000) - 5000, LOW);
+  }
+
+  addBurst(trace, release, HIGH, RELEASE_BOUNCE_MEDIAN_US);
+
+  if (chance(IDLE_GLITCH_PERCENT)) {
+    addGlitch(trace, release + BOUNCE_CAP_US + TRACE_QUIET_US + uniform(5000, 20000), HIGH);
+  }
+  return trace;
+}
@@ -0,0 +1,99 @@
+#ifndef BOUNCE_TRACE_H
+#define BOUNCE_TRACE_H
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * BounceTrace - Recorded button edges for the debounce replay (host)
+ *
+ * A trace is the list of edges one button produced, with microsecond
+ * timestamps. The text format is one edge per line:
+ *
+ *   # comments are ignored, other lines are skipped and counted
+ *   trace omron-b3f-017
+ *   12000 0
+ *   12410 1
+ *   12630 0
+ *   ...
+ *   trace omron-b3f-018
+ *   ...
+ *
+ * "trace <label>" starts a new trace. An edge line is "<time_us> <level>"
+ * and may carry an "edge" prefix, which is how the sketch prints captured
+ * edges after a 't' command, so a serial log of real presses can be
+ * replayed as it is (lines before the first "trace" form one trace).
+ * "edge " is found anywhere in a line and whatever comes before it is
+ * ignored: in a raw capture the sketch's TokenLog frames (binary, with
+ * 0x00 delimiters) end up in front of the next edge line. The level
+ * before the first edge is the opposite of that edge.
+ *
+ * Where the ground truth comes from: edges closer together than a quiet
+ * gap form one burst, and a burst that ends on a different level than
+ * it started from is one real transition, timed at its first edge. A
+ * burst that ends where it started (a glitch) is not a transition.
+ */
+
+struct TraceEdge {
+  uint32_t time;     // Microseconds
+  byte level;
+};
+
+struct BounceTrace {
+  std::string label;
+  std::vector<TraceEdge> edges;
+
+  // Level before the first edge
+  byte initialLevel() const;
+};
+
+// A real (settled) level change
+struct TraceTransition {
+  uint32_t time;     // First edge of the burst
+  byte level;        // Level the burst settled on
+};
+
+// Append every trace in a file to traces; returns the number read. If
+// skipped is given it gets the number of lines that were neither blank,
+// a comment, "trace" nor an edge (other serial output, broken edges)
+size_t readTraces(FILE* in, std::vector<BounceTrace>& traces, size_t* skipped = NULL);
+
+void writeTrace(FILE* out, const BounceTrace& trace);
+
+// Group edges into bursts split by quietUs of silence; one transition
+// per burst that changed the level
+std::vector<TraceTransition> settledTransitions(const BounceTrace& trace, uint32_t quietUs);
+
+/**
+ * Synthetic press-and-release traces, for when there are no captures.
+ * Bounce lengths are log-normal (most bursts are a millisecond or two, a
+ * few run to the cap) with a random number of toggles; some presses get
+ * a short spike while held or after release, which no debouncer should
+ * report. Glitches are kept more than TRACE_QUIET_US away from the
+ * bursts so the ground truth holds.
+ */
+
+// Quiet gap that separates bursts (generated bounce never lasts this long)
+const uint32_t TRACE_QUIET_US = 30000;
+
+class TraceGenerator {
+  private:
+    std::mt19937 rng;
+    uint32_t count;
+
+    uint32_t uniform(uint32_t low, uint32_t high);
+    bool chance(uint32_t percent);
+    uint32_t bounceLength(double medianUs);
+    void addBurst(BounceTrace& trace, uint32_t start, byte level, double medianUs);
+    void addGlitch(BounceTrace& trace, uint32_t start, byte level);
+
+  public:
+    explicit TraceGenerator(uint32_t seed);
+
+    BounceTrace next();
+};
+
+#endif
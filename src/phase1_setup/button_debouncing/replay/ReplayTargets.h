@@ -0,0 +1,70 @@
+#ifndef REPLAY_TARGETS_H
+#define REPLAY_TARGETS_H
+
+#include <PortDebouncer.h>
+#include "BounceReplay.h"
+#include "DebounceMethods.h"
+
+/**
+ * ReplayTargets - The sketch's debounce strategies as replay targets
+ */
+
+class TimeTarget : public ReplayTarget {
+  private:
+    TimeDebouncer debouncer;
+    uint32_t windowTicks;
+
+  public:
+    explicit TimeTarget(uint32_t ticks) : debouncer(ticks, HIGH), windowTicks(ticks) {}
+    const char* name() const override { return "time window"; }
+    void reset(byte level) override { debouncer = TimeDebouncer(windowTicks, level); }
+    bool update(byte reading, uint32_t tick) override { return debouncer.update(reading, tick); }
+    byte state() const override { return debouncer.getState(); }
+    bool skipsSettled() const override { return true; }
+};
+
+class CounterTarget : public ReplayTarget {
+  private:
+    CounterDebouncer debouncer;
+    byte requiredCount;
+
+  public:
+    explicit CounterTarget(byte count) : debouncer(count, HIGH), requiredCount(count) {}
+    const char* name() const override { return "counter (integrator)"; }
+    void reset(byte level) override { debouncer = CounterDebouncer(requiredCount, level); }
+    bool update(byte reading, uint32_t /*tick*/) override { return debouncer.update(reading); }
+    byte state() const override { return debouncer.getState(); }
+    bool skipsSettled() const override { return true; }
+};
+
+// Learns across traces: reset() only sets the level, like a switch that
+// is pressed again, and the bounce estimate carries over
+class AdaptiveTarget : public ReplayTarget {
+  private:
+    AdaptiveDebouncer debouncer;
+
+  public:
+    AdaptiveTarget(uint16_t minTicks, uint16_t maxTicks) : debouncer(minTicks, maxTicks, HIGH) {}
+    const char* name() const override { return "adaptive window"; }
+    void reset(byte level) override { debouncer.setState(level); }
+    bool update(byte reading, uint32_t tick) override { return debouncer.update(reading, tick); }
+    byte state() const override { return debouncer.getState(); }
+    const AdaptiveDebouncer& get() const { return debouncer; }
+};
+
+// Bit 0 of a PortDebouncer (fixed at PORT_DEBOUNCE_SAMPLES)
+class VerticalTarget : public ReplayTarget {
+  private:
+    PortDebouncer debouncer;
+
+  public:
+    const char* name() const override { return "vertical counter"; }
+    void reset(byte level) override { debouncer = PortDebouncer(level ? 0xFF : 0x00); }
+    bool update(byte reading, uint32_t /*tick*/) override {
+      return debouncer.update(reading ? 0xFF : 0x00) & 0x01;
+    }
+    byte state() const override { return debouncer.levels() & 0x01; }
+    bool skipsSettled() const override { return true; }
+};
+
+#endif
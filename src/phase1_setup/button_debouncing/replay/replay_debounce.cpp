@@ -0,0 +1,172 @@
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "BounceReplay.h"
+#include "ReplayTargets.h"
+
+/**
+ * Debounce Trace Replay (host)
+ *
+ * Replays bounce traces through the sketch's debounce strategies and
+ * reports, per strategy, the press and release latency distribution
+ * (from the first edge of a press to the debounced change), missed
+ * presses and false triggers.
+ *
+ *   replay                        5000 synthetic traces
+ *   replay captures.txt ...       recorded traces (format in BounceTrace.h)
+ *   replay --write traces.txt     save the synthetic traces, then replay
+ *
+ * Options: --rate HZ (sampling, default 1000), --count N and --seed S
+ * (synthetic traces), --quiet MS (burst gap for the ground truth).
+ *
+ * To record real switches, send 't' to the sketch and log the serial
+ * output: every captured edge is printed as "edge <us> <level>", which
+ * the trace reader accepts as it is.
+ *
+ * Build and run: pio run -e replay -t exec
+ */
+
+// Same settings as main.cpp
+const uint32_t DEBOUNCE_WINDOW_MS = 50;
+const byte MAX_COUNT = 5;
+const uint32_t ADAPTIVE_MIN_MS = 3;
+
+const uint32_t DEFAULT_TRACES = 5000;
+const uint32_t LEAD_IN_US = 20000;
+const uint32_t TAIL_US = 200000;
+
+static void usage() {
+  fprintf(stderr,
+          "usage: replay [--rate HZ] [--count N] [--seed S] [--quiet MS]\n"
+          "              [--write FILE] [trace files...]\n");
+}
+
+static void printLatencies(const char* name, const char* edge, std::vector<uint32_t>& latencies) {
+  printf("  %-22s %-8s %7lu %7lu %7lu %7lu %7lu %7lu\n", name, edge,
+         (unsigned long)latencies.size(),
+         (unsigned long)latencyPercentile(latencies, 500),
+         (unsigned long)latencyPercentile(latencies, 900),
+         (unsigned long)latencyPercentile(latencies, 990),
+         (unsigned long)latencyPercentile(latencies, 999),
+         (unsigned long)latencyPercentile(latencies, 1000));
+}
+
+int main(int argc, char** argv) {
+  uint32_t rate = 1000;
+  uint32_t count = DEFAULT_TRACES;
+  uint32_t seed = 12345;
+  uint32_t quietMs = TRACE_QUIET_US / 1000;
+  const char* writePath = NULL;
+  std::vector<const char*> files;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--rate") && i + 1 < argc) {
+      rate = strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--count") && i + 1 < argc) {
+      count = strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+      seed = strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--quiet") && i + 1 < argc) {
+      quietMs = strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--write") && i + 1 < argc) {
+      writePath = argv[++i];
+    } else if (argv[i][0] != '-') {
+      files.push_back(argv[i]);
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  if (rate == 0 || rate > 1000000 || quietMs == 0) {
+    usage();
+    return 2;
+  }
+
+  // Recorded traces, or synthetic ones when none are given
+  std::vector<BounceTrace> traces;
+  for (const char* path : files) {
+    FILE* in = fopen(path, "r");
+    if (in == NULL) {
+      fprintf(stderr, "replay: cannot open %s\n", path);
+      return 2;
+    }
+    size_t skipped = 0;
+    readTraces(in, traces, &skipped);
+    fclose(in);
+    if (skipped > 0) {
+      fprintf(stderr, "replay: %s: skipped %lu lines that are not traces or edges\n",
+              path, (unsigned long)skipped);
+    }
+  }
+  if (files.empty()) {
+    TraceGenerator generator(seed);
+    for (uint32_t i = 0; i < count; i++) {
+      traces.push_back(generator.next());
+    }
+  }
+  if (traces.empty()) {
+    fprintf(stderr, "replay: no traces\n");
+    return 2;
+  }
+
+  if (writePath != NULL) {
+    FILE* out = fopen(writePath, "w");
+    if (out == NULL) {
+      fprintf(stderr, "replay: cannot write %s\n", writePath);
+      return 2;
+    }
+    fprintf(out, "# bounce traces (see replay/BounceTrace.h)\n");
+    for (const BounceTrace& trace : traces) {
+      writeTrace(out, trace);
+    }
+    fclose(out);
+  }
+
+  ReplayConfig config;
+  config.samplePeriodUs = 1000000UL / rate;
+  config.quietUs = quietMs * 1000;
+  config.leadInUs = LEAD_IN_US;
+  config.tailUs = TAIL_US;
+
+  TimeTarget timeTarget(DEBOUNCE_WINDOW_MS * rate / 1000);
+  CounterTarget counterTarget(MAX_COUNT);
+  VerticalTarget verticalTarget;
+  AdaptiveTarget adaptiveTarget(ADAPTIVE_MIN_MS * rate / 1000, DEBOUNCE_WINDOW_MS * rate / 1000);
+  ReplayTarget* targets[] = {&timeTarget, &adaptiveTarget, &counterTarget, &verticalTarget};
+
+  printf("Debounce trace replay: %lu traces, sampling at %lu Hz\n",
+         (unsigned long)traces.size(), (unsigned long)rate);
+  printf("  Latency in us from the first edge of a press/release to the debounced change\n");
+  printf("  %-22s %-8s %7s %7s %7s %7s %7s %7s\n",
+         "strategy", "edge", "count", "p50", "p90", "p99", "p99.9", "max");
+
+  std::vector<ReplayStats> results;
+  for (ReplayTarget* target : targets) {
+    ReplayStats stats;
+    // Same phase sequence for every strategy
+    randomSeed(seed);
+    for (const BounceTrace& trace : traces) {
+      replayTrace(trace, *target, config, random(config.samplePeriodUs), stats);
+    }
+    printLatencies(target->name(), "press", stats.pressLatency);
+    printLatencies("", "release", stats.releaseLatency);
+    results.push_back(stats);
+  }
+
+  printf("\n  %-22s %11s %8s %14s %18s\n",
+         "strategy", "transitions", "missed", "false triggers", "traces with false");
+  for (size_t i = 0; i < results.size(); i++) {
+    const ReplayStats& stats = results[i];
+    printf("  %-22s %11lu %8lu %14lu %11lu (%4.1f%%)\n", targets[i]->name(),
+           (unsigned long)stats.transitions, (unsigned long)stats.missed,
+           (unsigned long)stats.falseTriggers, (unsigned long)stats.tracesWithFalse,
+           100.0 * stats.tracesWithFalse / stats.traces);
+  }
+
+  const AdaptiveDebouncer& adaptive = adaptiveTarget.get();
+  printf("\n  adaptive window after %lu bursts: %u ticks (p95 bounce %u ticks, %u regrows)\n",
+         (unsigned long)adaptive.bursts(), adaptive.getWindow(), adaptive.getBounceEstimate(),
+         adaptive.regrows());
+  return 0;
+}
@@ -0,0 +1,157 @@
+#include "DebounceMethods.h"
+
+/**
+ * Debounce method implementations
+ */
+
+// Time-based debouncer
+
+TimeDebouncer::TimeDebouncer(uint16_t windowTicks, byte initialState) {
+  debounce.reset(initialState != LOW);
+  window = windowTicks;
+}
+
+bool TimeDebouncer::update(byte reading, uint32_t tick) {
+  return debounce.update(reading != LOW, (uint16_t)tick, window);
+}
+
+byte TimeDebouncer::getState() const {
+  return debounce.level();
+}
+
+void TimeDebouncer::setWindow(uint16_t windowTicks) {
+  window = windowTicks;
+}
+
+// Counter-based debouncer
+
+CounterDebouncer::CounterDebouncer(byte requiredCount, byte initialState) {
+  debounce.reset(initialState != LOW);
+  maxCount = requiredCount > DebounceCount::MAX_SAMPLES ? DebounceCount::MAX_SAMPLES : requiredCount;
+}
+
+bool CounterDebouncer::update(byte reading) {
+  return debounce.update(reading, maxCount);
+}
+
+byte CounterDebouncer::getState() const {
+  return debounce.level();
+}
+
+// Adaptive time-based debouncer
+
+// Percentile tracking: step up 19 times as far as down (p95 = 19:1)
+const byte ADAPT_UP_STEPS = 19;
+const byte ADAPT_STEP_SHIFT = 5;     // Step = 1/32 of the estimate
+const byte ADAPT_FRACTION_BITS = 4;  // Estimate is in 1/16 ticks
+
+AdaptiveDebouncer::AdaptiveDebouncer(uint16_t minTicks, uint16_t maxTicks, byte initialState) {
+  lastReading = initialState;
+  state = initialState;
+  inBurst = false;
+  accepted = false;
+  burstStart = 0;
+  lastChange = 0;
+  minWindow = minTicks;
+  maxWindow = maxTicks > minTicks ? maxTicks : minTicks;
+  // Assume the worst until bursts have been measured
+  estimate = ((uint32_t)maxWindow << ADAPT_FRACTION_BITS) / 2;
+  burstCount = 0;
+  regrowCount = 0;
+  updateWindow();
+}
+
+void AdaptiveDebouncer::updateWindow() {
+  // Twice the estimate, rounded up to whole ticks
+  uint32_t ticks = (estimate * 2 + (1 << ADAPT_FRACTION_BITS) - 1) >> ADAPT_FRACTION_BITS;
+  if (ticks < minWindow) {
+    ticks = minWindow;
+  } else if (ticks > maxWindow) {
+    ticks = maxWindow;
+  }
+  window = ticks;
+}
+
+// The estimate never exceeds maxWindow ticks; clamping the length first
+// also keeps the shift into 1/16 ticks from overflowing
+uint32_t AdaptiveDebouncer::toEstimate(uint32_t ticks) const {
+  return (ticks > maxWindow ? maxWindow : ticks) << ADAPT_FRACTION_BITS;
+}
+
+void AdaptiveDebouncer::recordBurst(uint32_t length) {
+  uint32_t scaled = toEstimate(length);
+  uint32_t step = (estimate >> ADAPT_STEP_SHIFT) + 1;
+  uint32_t ceiling = toEstimate(maxWindow);
+
+  if (scaled > estimate) {
+    uint32_t raised = estimate + step * ADAPT_UP_STEPS;
+    estimate = raised > ceiling ? ceiling : raised;
+  } else if (estimate > step) {
+    estimate -= step;
+  } else {
+    estimate = 0;
+  }
+  burstCount++;
+  updateWindow();
+}
+
+bool AdaptiveDebouncer::update(byte reading, uint32_t tick) {
+  if (reading != lastReading) {
+    lastReading = reading;
+    if (!inBurst) {
+      inBurst = true;
+      accepted = false;
+      burstStart = tick;
+    } else if (accepted) {
+      // Still bouncing after the state was accepted: the window is too
+      // short for this switch, so catch up at once
+      estimate = toEstimate(tick - burstStart);
+      regrowCount++;
+      updateWindow();
+    }
+    lastChange = tick;
+  }
+
+  if (!inBurst) {
+    return false;
+  }
+
+  uint32_t quiet = tick - lastChange;
+  if (quiet > window && reading != state) {
+    state = reading;
+    accepted = true;
+    return true;
+  }
+  // Burst over: measure it
+  if (quiet > maxWindow) {
+    inBurst = false;
+    recordBurst(lastChange - burstStart);
+  }
+  return false;
+}
+
+byte AdaptiveDebouncer::getState() const {
+  return state;
+}
+
+void AdaptiveDebouncer::setState(byte level) {
+  state = level;
+  lastReading = level;
+  inBurst = false;
+}
+
+uint16_t AdaptiveDebouncer::getWindow() const {
+  return window;
+}
+
+uint16_t AdaptiveDebouncer::getBounceEstimate() const {
+  return (estimate + (1 << ADAPT_FRACTION_BITS) - 1) >> ADAPT_FRACTION_BITS;
+}
+
+uint32_t AdaptiveDebouncer::bursts() const {
+  return burstCount;
+}
+
+uint16_t AdaptiveDebouncer::regrows() const {
+  return regrowCount;
+}
@@ -1,58 +1,228 @@
 #include <Arduino.h>
+#include <ButtonGesture.h>
+#include <CycleMarker.h>
+#include <EdgeCapture.h>
+#include <InputSampler.h>
+#include <LogHistogram.h>
+#include <LoopProfiler.h>
+#include <SpscRing.h>
+#include <TokenLog.h>
+#include <UartSerial.h>
+#include "DebounceMethods.h"
 
 // Enhanced button debouncing with simulated bounce
 // Shows multiple debouncing methods for comparison
+//
+// The button is sampled by a timer interrupt at a fixed rate and both
+// debounce methods run inside that interrupt, so their timing does not
+// depend on how long loop() takes. Results reach loop() through a queue.
+//
+// Every physical edge on the button pin is also captured by an interrupt
+// with a micros() timestamp, and the bounce/response metrics are worked
+// out from that edge stream.
+//
+// Output goes through the UartSerial driver: a 256-byte interrupt-driven
+// buffer that drops (and counts) whole lines instead of blocking loop()
+// when the log outruns 115200 baud.
+//
+// LoopProfiler times each stage with Timer1 cycle counts; send 'p' over
+// serial to print the per-section histograms, 'r' to clear them.
+//
+// Gestures on the time-debounced button (ButtonGesture, never blocks):
+// a long press (1 s) toggles the bounce simulation, a double-click
+// switches method 1's window like 'a', and holding on past the long
+// press logs auto-repeats.
+//
+// 'a' switches method 1 between the fixed 50 ms window and an adaptive
+// window sized from the bounce actually measured on this switch.
+//
+// Every debounced press goes into a latency histogram per method (from
+// the first captured edge of the press); the metrics report shows count,
+// min, p50/p95/p99 and max, 'h' dumps the raw buckets.
+//
+// 't' toggles printing every captured edge as "edge <us> <level>": a log
+// of real presses can be fed straight to the trace replay (replay/).
 
 // Pin definitions
 const int buttonPin = 2;      // Button connected to pin 2
 const int ledPin = LED_BUILTIN; // Built-in LED
 const int externalLedPin = 8; // External LED for comparing debounce methods
 
+// simavr benchmark marker ids (see tools/avrbench/benchmarks.json)
+const byte MARK_ON_SAMPLE = 1;
+const byte MARK_TIME_DEBOUNCE = 2;
+const byte MARK_COUNTER_DEBOUNCE = 3;
+
+// Sampling
+const uint16_t SAMPLE_RATE_HZ = 1000;  // Button samples per second (1-4 kHz works well)
+
+// Convert milliseconds into sample ticks
+constexpr uint32_t msToTicks(uint32_t ms) {
+  return (ms * SAMPLE_RATE_HZ) / 1000;
+}
+
 // Debounce method 1: Time-based (current method)
-unsigned long lastDebounceTime = 0;
 unsigned long debounceDelay = 50;    // 50ms debounce period
-int lastButtonState = HIGH;   // Previous reading from button
-int buttonState = HIGH;       // Current debounced state
+int buttonState = HIGH;       // Current debounced state (mirrored from events)
 int ledState = LOW;           // Current state of the LED
 
+// Adaptive window limits for method 1 ('a')
+const uint16_t ADAPTIVE_MIN_MS = 3;   // Never shorter, whatever the statistics say
+volatile bool adaptiveMode = false;   // Method 1 uses the adaptive window
+
 // Debounce method 2: Integrator/counter-based
-const int MAX_COUNT = 5;      // Number of consistent readings needed
-int stableCount = 0;          // Counter for consecutive stable readings
-int integratedState = HIGH;   // Current integrated button state
+const int MAX_COUNT = 5;      // Number of consistent samples needed
+int integratedState = HIGH;   // Current integrated button state (mirrored from events)
 int externalLedState = LOW;   // State for external LED
 
-// Performance metrics
+// Both debouncers are only touched by the sampling interrupt
+TimeDebouncer timeDebouncer(msToTicks(50), HIGH);
+AdaptiveDebouncer adaptiveDebouncer(msToTicks(ADAPTIVE_MIN_MS), msToTicks(50), HIGH);
+CounterDebouncer counterDebouncer(MAX_COUNT, HIGH);
+
+// Gestures on the method 1 (time-debounced) state
+ButtonGesture buttonGesture(GESTURE_DEFAULT_TIMING);
+uint16_t repeatCount = 0;             // Auto-repeats in the current hold
+
+// Events passed from the sampling interrupt to loop()
+enum EventSource : byte {
+  EVENT_RAW,          // Raw reading changed
+  EVENT_TIME,         // Time-based debounced state changed
+  EVENT_COUNTER       // Counter-based debounced state changed
+};
+
+struct ButtonEvent {
+  EventSource source;
+  byte level;         // HIGH = released, LOW = pressed
+  bool simulated;     // Raw change came from the bounce simulation
+  uint32_t tick;      // Sample tick when it happened
+  uint32_t time;      // micros() when it happened (same clock as captured edges)
+};
+
+SpscRing<ButtonEvent, 32> eventQueue;
+
+// Profiled sections (registered in setup())
+ProfileSection debounceSection;     // onSample() in the sampling interrupt
+ProfileSection edgeSection;         // Draining captured edges
+ProfileSection eventSection;        // Handling queued events (includes logging)
+ProfileSection reportSection;       // Periodic metrics report
+
+// Performance metrics (from the captured edge stream, in microseconds)
 unsigned long bounceEvents = 0;      // Count of detected bounces
-unsigned long lastPressTime = 0;     // Timestamp of last press
-unsigned long responseTime = 0;      // Time from press to stable reading
+uint32_t lastPressTime = 0;          // First falling edge of the last press
+uint32_t responseTime = 0;           // Time from press edge to stable reading
+
+// Press latency per method (us), 60 bytes each. Buckets 1-18 resolve up
+// to 2^18 us (~262 ms); bucket 19 collects everything from 2^18 us up.
+// Percentiles are bucket upper bounds (within 2x).
+typedef LogHistogram<20> LatencyHistogram;
+LatencyHistogram timeLatency;        // Method 1 (whichever window is active)
+LatencyHistogram counterLatency;     // Method 2
+uint32_t bounceDuration = 0;         // First to last edge of the last burst
+uint32_t lastEdgeTime = 0;           // Previous captured edge
+uint32_t burstStartTime = 0;         // First edge of the current burst
+bool edgeSeen = false;               // At least one edge captured
+bool traceEdges = false;             // Print each captured edge ('t')
 unsigned long lastReportTime = 0;    // Last time we sent a report
 const unsigned long REPORT_INTERVAL = 3000; // Status reporting interval (ms)
 
 // Bounce simulation variables
-bool simulateBounce = false;          // Enable/disable bounce simulation
-bool buttonActive = false;            // Track if button is currently being pressed
-unsigned long buttonPressStart = 0;   // When the button was first pressed
+volatile bool simulateBounce = false; // Enable/disable bounce simulation
 const int BOUNCE_DURATION = 50;       // How long bounce simulation lasts (ms)
-int bouncePattern[] = {HIGH, LOW, HIGH, LOW, HIGH, LOW, HIGH}; // Bounce pattern
+const byte bouncePattern[] = {HIGH, LOW, HIGH, LOW, HIGH, LOW, HIGH}; // Bounce pattern
 const int BOUNCE_COUNT = 7;           // Number of bounces to simulate
-int currentBounce = 0;                // Current position in bounce pattern
-unsigned long lastBounceTime = 0;     // Last time we changed bounce state
 const int BOUNCE_INTERVAL = 5;        // Time between bounces (ms)
 
+// Sampling interrupt state (only used inside onSample)
+byte lastRawReading = HIGH;           // Previous raw reading
+bool bounceActive = false;            // Bounce simulation running
+uint32_t bounceStartTick = 0;         // Tick the simulated bounce started
+
+// Get button reading, either real or simulated (runs in the interrupt)
+byte getButtonReading(const InputSample& sample, bool& simulated) {
+  byte reading = samplePin(sample, buttonPin);
+  simulated = false;
+
+  if (!simulateBounce) {
+    bounceActive = false;
+    return reading;
+  }
+
+  // A fresh press starts a simulated bounce burst
+  if (!bounceActive && reading == LOW && lastRawReading == HIGH) {
+    bounceActive = true;
+    bounceStartTick = sample.tick;
+  }
+
+  if (bounceActive) {
+    uint32_t elapsed = sample.tick - bounceStartTick;
+    if (elapsed < msToTicks(BOUNCE_DURATION)) {
+      // Step through the bounce pattern every BOUNCE_INTERVAL ms
+      simulated = true;
+      return bouncePattern[(elapsed / msToTicks(BOUNCE_INTERVAL)) % BOUNCE_COUNT];
+    }
+    // Bounce simulation finished, settle to the real reading
+    if (reading == HIGH) {
+      bounceActive = false;
+    }
+  }
+  return reading;
+}
+
+// Called by the sampling interrupt at SAMPLE_RATE_HZ
+void onSample(const InputSample& sample) {
+  PROFILE_SCOPE(debounceSection);
+  CYCLE_MARK_SCOPE(MARK_ON_SAMPLE);
+  bool simulated;
+  byte reading = getButtonReading(sample, simulated);
+  ButtonEvent event;
+  event.tick = sample.tick;
+  event.time = micros();
+  event.level = reading;
+  event.simulated = simulated;
+
+  if (reading != lastRawReading) {
+    lastRawReading = reading;
+    event.source = EVENT_RAW;
+    eventQueue.push(event);
+  }
+
+  // PART 1: TIME-BASED DEBOUNCING (traditional method)
+  // Both windows always run, so the adaptive one keeps learning while
+  // the fixed one is in charge
+  CYCLE_MARK_BEGIN(MARK_TIME_DEBOUNCE);
+  bool fixedChanged = timeDebouncer.update(reading, sample.tick);
+  bool adaptiveChanged = adaptiveDebouncer.update(reading, sample.tick);
+  if (adaptiveMode ? adaptiveChanged : fixedChanged) {
+    event.source = EVENT_TIME;
+    eventQueue.push(event);
+  }
+  CYCLE_MARK_END(MARK_TIME_DEBOUNCE);
+
+  // PART 2: COUNTER-BASED DEBOUNCING (integrator method)
+  CYCLE_MARK_BEGIN(MARK_COUNTER_DEBOUNCE);
+  if (counterDebouncer.update(reading)) {
+    event.source = EVENT_COUNTER;
+    eventQueue.push(event);
+  }
+  CYCLE_MARK_END(MARK_COUNTER_DEBOUNCE);
+}
+
 void setup() {
-  // Set up serial port
-  Serial.begin(115200);
-  Serial.println("=== Enhanced Button Debounce Demonstration with Bounce Simulation ===");
-  
+  // Set up serial port (U2X double speed). Block while printing the
+  // banner so none of it is lost; loop() switches to dropping below.
+  Uart.begin(115200);
+  Uart.setOverflowPolicy(UART_OVERFLOW_BLOCK);
+  Uart.println("=== Enhanced Button Debounce Demonstration with Bounce Simulation ===");
+
+  // Marker cost for the simavr benchmarks (nothing in normal builds)
+  CYCLE_MARK_CALIBRATE();
+
   // Configure I/O pins
   pinMode(buttonPin, INPUT_PULLUP);  // Button with pull-up resistor
-  pinMode(ledPin, OUTPUT);           // Built-in LED 
+  pinMode(ledPin, OUTPUT);           // Built-in LED
   pinMode(externalLedPin, OUTPUT);   // External LED
-  
-  // Initialize states with current readings
-  buttonState = digitalRead(buttonPin);
-  integratedState = buttonState;
-  
+
   // LED test sequence to verify hardware
   digitalWrite(ledPin, HIGH);
   digitalWrite(externalLedPin, HIGH);
@@ -65,186 +235,293 @@ void setup() {
   delay(300);
   digitalWrite(ledPin, LOW);
   digitalWrite(externalLedPin, LOW);
-  
+
   // Set initial states
   digitalWrite(ledPin, ledState);
   digitalWrite(externalLedPin, externalLedState);
-  
-  Serial.println("\nMethod 1: Time-based debouncing (built-in LED)");
-  Serial.println("Method 2: Counter-based debouncing (external LED)");
-  Serial.println("\nPress and hold button for >1 second to enable bounce simulation");
-  Serial.println("Setup complete. Press button to toggle LEDs.\n");
-  
+
+  // Profile sections before anything starts calling into them
+  debounceSection = LoopProfiler.section(F("debounce"));
+  edgeSection = LoopProfiler.section(F("edges"));
+  eventSection = LoopProfiler.section(F("events"));
+  reportSection = LoopProfiler.section(F("report"));
+  LoopProfiler.begin();
+
+  // Initialize states with current readings, then start sampling
+  buttonState = digitalRead(buttonPin);
+  integratedState = buttonState;
+  lastRawReading = buttonState;
+  timeDebouncer = TimeDebouncer(msToTicks(debounceDelay), buttonState);
+  adaptiveDebouncer = AdaptiveDebouncer(msToTicks(ADAPTIVE_MIN_MS), msToTicks(debounceDelay),
+                                        buttonState);
+  counterDebouncer = CounterDebouncer(MAX_COUNT, buttonState);
+  InputSampler.begin(SAMPLE_RATE_HZ, onSample);
+  EdgeCapture.begin(buttonPin);
+
+  Uart.println("\nMethod 1: Time-based debouncing (built-in LED)");
+  Uart.println("Method 2: Counter-based debouncing (external LED)");
+  Uart.print("Sampling button at ");
+  Uart.print(InputSampler.rate());
+  Uart.println(" Hz");
+  Uart.println("\nPress and hold button for >1 second to enable bounce simulation");
+  Uart.println("Double-click to switch method 1 between fixed and adaptive windows");
+  Uart.println("Send 'p' for the loop profile, 'h' for latency histograms, 'r' to reset both");
+  Uart.println("Send 't' to trace edges");
+  Uart.println("Send 'a' to switch method 1 between fixed and adaptive windows");
+  Uart.println("Setup complete. Press button to toggle LEDs.\n");
+
+  // From here on never let logging stall the loop
+  Uart.setOverflowPolicy(UART_OVERFLOW_DROP);
+  TokenLog.begin(Uart);
+
   lastReportTime = millis();
 }
 
+// Press latency summary for one method (all presses since the last 'r')
+void printLatency(const char* method, const LatencyHistogram& latency) {
+  TLOG("%s press latency us: n=%lu min=%lu p50=%lu p95=%lu p99=%lu max=%lu", method,
+       latency.count(), latency.min(), latency.percentile(500), latency.percentile(950),
+       latency.percentile(990), latency.max());
+}
+
+// Raw buckets of both latency histograms ('h'), for plotting on the host
+void dumpLatencyHistograms() {
+  Uart.println("Time-based press latency (us: presses)");
+  timeLatency.printBuckets(Uart);
+  Uart.println("Counter-based press latency (us: presses)");
+  counterLatency.printBuckets(Uart);
+}
+
+// Current adaptive window and the bounce statistics behind it
+void printAdaptiveWindow() {
+  // The sampling interrupt owns the debouncer; copy it in one go
+  uint8_t oldSREG = SREG;
+  cli();
+  AdaptiveDebouncer snapshot = adaptiveDebouncer;
+  SREG = oldSREG;
+
+  TLOG("Adaptive window: %lu us (p95 bounce %lu us, %lu bursts, %u regrows)%s",
+       InputSampler.ticksToMicros(snapshot.getWindow()),
+       InputSampler.ticksToMicros(snapshot.getBounceEstimate()),
+       snapshot.bursts(), snapshot.regrows(), adaptiveMode ? " [active]" : "");
+}
+
+// Metrics go out as TokenLog records: a few bytes each instead of a
+// screenful of text (decode with tools/tokenlog/decode_log.py)
 void printPerformanceMetrics() {
-  Serial.println("\n--- Performance Metrics ---");
-  Serial.print("Detected bounce events: ");
-  Serial.println(bounceEvents);
-  Serial.print("Time-based debounce response: ");
-  Serial.print(responseTime);
-  Serial.println(" ms");
-  Serial.print("Counter-based stable readings required: ");
-  Serial.println(MAX_COUNT);
-  Serial.print("Bounce simulation: ");
-  Serial.println(simulateBounce ? "ENABLED" : "DISABLED");
-  Serial.println("----------------------------\n");
-  
+  TLOG("--- Performance Metrics ---");
+  TLOG("Detected bounce events: %lu (last burst %lu us)", bounceEvents, bounceDuration);
+  TLOG("Time-based debounce response: %lu us", responseTime);
+  printLatency("time", timeLatency);
+  printAdaptiveWindow();
+  TLOG("Counter-based stable readings required: %d (%lu us)",
+       MAX_COUNT, InputSampler.ticksToMicros(MAX_COUNT));
+  printLatency("counter", counterLatency);
+  TLOG("Drops: events %u, edges %u, serial %lu bytes in %u writes (buffer peak %u bytes)",
+       eventQueue.dropped(), EdgeCapture.dropped(),
+       Uart.droppedBytes(), Uart.droppedWrites(), Uart.highWater());
+  if (simulateBounce) {
+    TLOG("Bounce simulation: ENABLED");
+  } else {
+    TLOG("Bounce simulation: DISABLED");
+  }
+
   // Reset bounce counter after reporting
   bounceEvents = 0;
 }
 
-// Get button reading, either real or simulated
-int getButtonReading() {
-  int reading;
-  
-  if (simulateBounce && buttonActive) {
-    // We're in an active bounce simulation
-    unsigned long currentTime = millis();
-    
-    // Check if we're still within bounce duration
-    if (currentTime - buttonPressStart < BOUNCE_DURATION) {
-      // Time to change bounce state?
-      if (currentTime - lastBounceTime >= BOUNCE_INTERVAL) {
-        currentBounce = (currentBounce + 1) % BOUNCE_COUNT;
-        lastBounceTime = currentTime;
-        // Log the simulated bounce
-        Serial.print("Simulated bounce: ");
-        Serial.println(bouncePattern[currentBounce] == HIGH ? "RELEASED" : "PRESSED");
-      }
-      reading = bouncePattern[currentBounce];
-    } else {
-      // Bounce simulation finished, settle to final state (pressed)
-      reading = LOW;
-      buttonActive = false;
-      Serial.println("Bounce simulation complete, button settled");
-    }
+// Handle one captured edge - edges closer together than the debounce
+// window belong to the same bounce burst
+void handleEdge(const CapturedEdge& edge) {
+  uint32_t gap = edge.time - lastEdgeTime;
+
+  if (traceEdges) {
+    Uart.print("edge ");
+    Uart.print(edge.time);
+    Uart.print(' ');
+    Uart.println(edge.level);
+  }
+
+  if (edgeSeen && gap < debounceDelay * 1000UL) {
+    // Still bouncing
+    bounceEvents++;
+    bounceDuration = edge.time - burstStartTime;
   } else {
-    // Normal reading
-    reading = digitalRead(buttonPin);
-    
-    // Check for long press to enable/disable bounce simulation
-    if (reading == LOW) {
-      if (!buttonActive) {
-        // Button just pressed
-        buttonActive = true;
-        buttonPressStart = millis();
-        currentBounce = 0;
-      } else {
-        // Check for long press (1 second)
-        if ((millis() - buttonPressStart > 1000) && reading == LOW) {
-          simulateBounce = !simulateBounce;
-          Serial.print("Bounce simulation ");
-          Serial.println(simulateBounce ? "ENABLED" : "DISABLED");
-          // Wait for button release to avoid immediate simulation
-          while (digitalRead(buttonPin) == LOW) {
-            delay(10);
-          }
-          buttonActive = false;
-          return HIGH; // Return released state after toggle
-        }
-      }
-    } else {
-      // Button released
-      buttonActive = false;
+    // First edge after a quiet period starts a new burst
+    burstStartTime = edge.time;
+    bounceDuration = 0;
+    if (edge.level == LOW) {
+      lastPressTime = edge.time;
     }
   }
-  
-  return reading;
+
+  lastEdgeTime = edge.time;
+  edgeSeen = true;
 }
 
-void loop() {
-  // Get button reading (real or simulated)
-  int reading = getButtonReading();
-  unsigned long currentTime = millis();
-  
-  // PART 1: TIME-BASED DEBOUNCING (traditional method)
-  // If reading changed from last time, reset the debounce timer
-  if (reading != lastButtonState) {
-    // Count bounces (transitions between HIGH and LOW)
-    if (lastButtonState != buttonState) { // Only count as bounce if unstable
-      bounceEvents++;
-    }
-    
-    // If this is the first detection of a press, note the time
-    if (buttonState == HIGH && reading == LOW) {
-      lastPressTime = currentTime;
-    }
-    
-    // Reset debounce timer
-    lastDebounceTime = currentTime;
-    
-    // Log the raw state change
-    Serial.print("Raw: ");
-    Serial.println(reading == HIGH ? "RELEASED" : "PRESSED");
-  }
-  
-  // Check if debounce time has passed
-  if ((currentTime - lastDebounceTime) > debounceDelay) {
-    // If the button state has changed and is stable:
-    if (reading != buttonState) {
-      buttonState = reading;
-      
+// Handle one event from the sampling interrupt
+void handleEvent(const ButtonEvent& event) {
+  switch (event.source) {
+    case EVENT_RAW:
+      // Log the raw state change
+      Uart.print(event.simulated ? "Simulated bounce: " : "Raw: ");
+      Uart.println(event.level == HIGH ? "RELEASED" : "PRESSED");
+      break;
+
+    case EVENT_TIME:
+      buttonState = event.level;
+
       // Measure response time for presses
       if (buttonState == LOW) {
-        responseTime = currentTime - lastPressTime;
-        
+        responseTime = event.time - lastPressTime;
+        timeLatency.add(responseTime);
+
         // Report debounced state change
-        Serial.print("Time-debounced: PRESSED (response: ");
-        Serial.print(responseTime);
-        Serial.println("ms)");
-        
+        Uart.print("Time-debounced: PRESSED (response: ");
+        Uart.print(responseTime);
+        Uart.println("us)");
+
         // Toggle LED state
         ledState = !ledState;
         digitalWrite(ledPin, ledState);
-        Serial.print("Built-in LED: ");
-        Serial.println(ledState == HIGH ? "ON" : "OFF");
+        Uart.print("Built-in LED: ");
+        Uart.println(ledState == HIGH ? "ON" : "OFF");
       } else {
-        Serial.println("Time-debounced: RELEASED");
+        Uart.println("Time-debounced: RELEASED");
       }
-    }
-  }
-  
-  // PART 2: COUNTER-BASED DEBOUNCING (integrator method)
-  // Check if current reading matches the integrated state
-  if (reading == integratedState) {
-    // Reading is stable and matches our current state
-    stableCount = 0; // Reset counter as no change is happening
-  } else {
-    // Reading differs from current stable state
-    stableCount++; // Increment counter for this potential new state
-    
-    // If we've had enough consistent readings, change the integrated state
-    if (stableCount >= MAX_COUNT) {
-      integratedState = reading; // Accept the new state
-      stableCount = 0; // Reset counter
-      
+      break;
+
+    case EVENT_COUNTER:
+      integratedState = event.level;
+
       // Handle the debounced state change
       if (integratedState == LOW) { // Button is pressed (LOW due to pull-up)
-        Serial.println("Counter-debounced: PRESSED");
-        
+        counterLatency.add(event.time - lastPressTime);
+        Uart.println("Counter-debounced: PRESSED");
+
         // Toggle external LED
         externalLedState = !externalLedState;
         digitalWrite(externalLedPin, externalLedState);
-        Serial.print("External LED: ");
-        Serial.println(externalLedState == HIGH ? "ON" : "OFF");
+        Uart.print("External LED: ");
+        Uart.println(externalLedState == HIGH ? "ON" : "OFF");
       } else {
-        Serial.println("Counter-debounced: RELEASED");
+        Uart.println("Counter-debounced: RELEASED");
       }
+      break;
+  }
+}
+
+// Hand method 1 over between the fixed and the adaptive window. The
+// incoming debouncer takes over the current debounced state, so the
+// switch itself never shows up as a press.
+void switchWindowMode() {
+  uint8_t oldSREG = SREG;
+  cli();
+  if (adaptiveMode) {
+    timeDebouncer = TimeDebouncer(msToTicks(debounceDelay), adaptiveDebouncer.getState());
+  } else {
+    adaptiveDebouncer.setState(timeDebouncer.getState());
+  }
+  adaptiveMode = !adaptiveMode;
+  SREG = oldSREG;
+
+  Uart.println(adaptiveMode ? "Method 1: adaptive window" : "Method 1: fixed window");
+  printAdaptiveWindow();
+}
+
+// Act on a recognised gesture
+void handleGesture(GestureEvent gesture) {
+  switch (gesture) {
+    case GESTURE_LONG_PRESS:
+      // Simulation only starts on a fresh press, so holding on is harmless
+      simulateBounce = !simulateBounce;
+      repeatCount = 0;
+      Uart.print("Long press - bounce simulation ");
+      Uart.println(simulateBounce ? "ENABLED" : "DISABLED");
+      break;
+
+    case GESTURE_DOUBLE_CLICK:
+      Uart.println("Double-click");
+      switchWindowMode();
+      break;
+
+    case GESTURE_CLICK:
+      Uart.println("Click");
+      break;
+
+    case GESTURE_REPEAT:
+      repeatCount++;
+      Uart.print("Repeat ");
+      Uart.println(repeatCount);
+      break;
+
+    default:
+      break;
+  }
+}
+
+// Serial commands: 'p' prints the loop profile, 'r' clears it and the
+// latency histograms, 'h' dumps the histograms, 't' toggles the edge
+// trace, 'a' switches method 1's window
+void handleCommands() {
+  while (Uart.available() > 0) {
+    char command = Uart.read();
+    if (command == 'p') {
+      // The profile is asked for, so wait for buffer space rather than drop it
+      Uart.setOverflowPolicy(UART_OVERFLOW_BLOCK);
+      LoopProfiler.report(Uart);
+      Uart.setOverflowPolicy(traceEdges ? UART_OVERFLOW_BLOCK : UART_OVERFLOW_DROP);
+    } else if (command == 'r') {
+      LoopProfiler.reset();
+      timeLatency.reset();
+      counterLatency.reset();
+      Uart.println("Loop profile and latency histograms reset");
+    } else if (command == 'h') {
+      Uart.setOverflowPolicy(UART_OVERFLOW_BLOCK);
+      dumpLatencyHistograms();
+      Uart.setOverflowPolicy(traceEdges ? UART_OVERFLOW_BLOCK : UART_OVERFLOW_DROP);
+    } else if (command == 'a') {
+      switchWindowMode();
+    } else if (command == 't') {
+      // A trace with lines missing is useless, so block while tracing
+      traceEdges = !traceEdges;
+      Uart.setOverflowPolicy(traceEdges ? UART_OVERFLOW_BLOCK : UART_OVERFLOW_DROP);
+      Uart.println(traceEdges ? "# edge trace on" : "# edge trace off");
     }
   }
-  
+}
+
+void loop() {
+  unsigned long currentTime = millis();
+
+  // Drain captured edges first, so a debounced press always finds the
+  // edge that started it
+  {
+    PROFILE_SCOPE(edgeSection);
+    CapturedEdge edge;
+    while (EdgeCapture.read(edge)) {
+      handleEdge(edge);
+    }
+  }
+
+  // Handle everything the sampling interrupt has queued
+  {
+    PROFILE_SCOPE(eventSection);
+    ButtonEvent event;
+    while (eventQueue.pop(event)) {
+      handleEvent(event);
+    }
+  }
+
+  // Gestures: one state machine step per pass, the loop never waits
+  handleGesture(buttonGesture.update(buttonState == LOW, currentTime));
+
   // Periodic performance metrics reporting
   if (currentTime - lastReportTime >= REPORT_INTERVAL) {
+    PROFILE_SCOPE(reportSection);
     printPerformanceMetrics();
     lastReportTime = currentTime;
   }
-  
-  // Save current reading for next comparison
-  lastButtonState = reading;
-  
-  // Small delay to avoid overwhelming the serial monitor while still 
-  // being responsive enough to catch button bounces
-  delay(1);
-}
\ No newline at end of file
+
+  handleCommands();
+}
@@ -0,0 +1,106 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * WorkStealingPool - Run independent tasks on every core (host)
+ *
+ * Tasks are numbered 0..count-1 and dealt round-robin into one queue per
+ * worker. A worker takes from the back of its own queue; once that is
+ * empty it steals from the front of the others'. Sweep points differ a
+ * lot in cost (a 4 kHz sample rate replays four times as many samples as
+ * 1 kHz), and stealing keeps every core busy until the very end instead
+ * of leaving the slowest fixed share to one thread.
+ *
+ *   WorkStealingPool pool;
+ *   pool.run(points.size(), [&](size_t i) { results[i] = evaluate(points[i]); });
+ *
+ * fn must be safe to call from several threads at once.
+ */
+
+class WorkStealingPool {
+  private:
+    struct WorkQueue {
+      std::mutex lock;
+      std::deque<size_t> tasks;
+    };
+
+    unsigned threadCount;
+
+    static bool popBack(WorkQueue& queue, size_t& task) {
+      std::lock_guard<std::mutex> guard(queue.lock);
+      if (queue.tasks.empty()) {
+        return false;
+      }
+      task = queue.tasks.back();
+      queue.tasks.pop_back();
+      return true;
+    }
+
+    static bool stealFront(WorkQueue& queue, size_t& task) {
+      std::lock_guard<std::mutex> guard(queue.lock);
+      if (queue.tasks.empty()) {
+        return false;
+      }
+      task = queue.tasks.front();
+      queue.tasks.pop_front();
+      return true;
+    }
+
+  public:
+    // threads = 0: one per core
+    explicit WorkStealingPool(unsigned threads = 0) {
+      threadCount = threads ? threads : std::thread::hardware_concurrency();
+      if (threadCount == 0) {
+        threadCount = 1;
+      }
+    }
+
+    unsigned threads() const {
+      return threadCount;
+    }
+
+    // Run fn(i) for every i in 0..count-1; returns when all are done
+    void run(size_t count, const std::function<void(size_t)>& fn) {
+      std::vector<WorkQueue> queues(threadCount);
+      for (size_t i = 0; i < count; i++) {
+        queues[i % threadCount].tasks.push_back(i);
+      }
+
+      auto worker = [&](unsigned self) {
+        size_t task;
+        while (true) {
+          if (popBack(queues[self], task)) {
+            fn(task);
+            continue;
+          }
+          // Own queue empty: steal, starting with the next worker along.
+          // No task creates others, so once every queue is empty we are done
+          bool stole = false;
+          for (unsigned k = 1; k < threadCount && !stole; k++) {
+            stole = stealFront(queues[(self + k) % threadCount], task);
+          }
+          if (!stole) {
+            return;
+          }
+          fn(task);
+        }
+      };
+
+      std::vector<std::thread> workers;
+      for (unsigned t = 1; t < threadCount; t++) {
+        workers.emplace_back(worker, t);
+      }
+      worker(0);
+      for (std::thread& thread : workers) {
+        thread.join();
+      }
+    }
+};
+
+#endif
@@ -0,0 +1,278 @@
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include "BounceReplay.h"
+#include "ReplayTargets.h"
+#include "WorkStealingPool.h"
+
+/**
+ * Debounce Parameter Sweep (host)
+ *
+ * Replays a set of bounce traces (synthetic, plus any recorded ones given
+ * on the command line) through every combination of strategy and
+ * parameter on a grid:
+ * - time window: 1-80 ms window
+ * - counter (integrator): 1-30 matching samples
+ * - vertical counter (fixed at 4 samples)
+ * each at 500, 1000, 2000 and 4000 Hz sampling. The grid points are
+ * spread over all cores with a work-stealing pool.
+ *
+ * Each point is scored on worst-case latency (p99 from the first edge to
+ * the debounced change, presses and releases together) and errors
+ * (false triggers plus missed transitions per 1000 transitions). The
+ * output is the Pareto front: the points no other point beats on both.
+ * The sketch's current settings are listed underneath for comparison.
+ *
+ *   sweep                              10000 synthetic traces
+ *   sweep --count 0 captures.txt       recorded traces only
+ *   sweep --csv sweep.csv              also write every point
+ *
+ * Options: --threads N (default: all cores), --count N, --seed S,
+ * --quiet MS (burst gap for the ground truth, see BounceTrace.h).
+ *
+ * Build and run: pio run -e sweep -t exec
+ */
+
+// Settings main.cpp uses today
+const uint32_t CURRENT_WINDOW_MS = 50;
+const byte CURRENT_COUNT = 5;
+const uint32_t CURRENT_RATE = 1000;
+
+// Grid
+const uint32_t SAMPLE_RATES[] = {500, 1000, 2000, 4000};
+const uint32_t MAX_WINDOW_MS = 80;
+const byte MAX_COUNT = 30;
+
+const uint32_t DEFAULT_TRACES = 10000;
+const uint32_t LEAD_IN_US = 20000;
+const uint32_t TAIL_US = 200000;
+
+enum SweepStrategy : byte {
+  SWEEP_TIME,
+  SWEEP_COUNTER,
+  SWEEP_VERTICAL
+};
+
+const char* const STRATEGY_NAMES[] = {"time window", "counter", "vertical counter"};
+const char* const PARAMETER_UNITS[] = {"ms", "samples", "samples"};
+
+struct SweepPoint {
+  SweepStrategy strategy;
+  uint32_t parameter;      // Window in ms, or samples needed
+  uint32_t rate;           // Sampling rate (Hz)
+
+  // Results
+  uint32_t latencyP50;     // Microseconds
+  uint32_t latencyP99;
+  uint32_t falseTriggers;
+  uint32_t missed;
+  uint32_t transitions;
+
+  double errorsPerThousand() const {
+    return transitions ? 1000.0 * (falseTriggers + missed) / transitions : 0;
+  }
+};
+
+static std::vector<BounceTrace> traces;
+static std::vector<double> phases;     // Sample phase per trace, 0-1 of a period
+static uint32_t quietUs = TRACE_QUIET_US;
+
+static void evaluate(SweepPoint& point) {
+  ReplayConfig config;
+  config.samplePeriodUs = 1000000UL / point.rate;
+  config.quietUs = quietUs;
+  config.leadInUs = LEAD_IN_US;
+  config.tailUs = TAIL_US;
+
+  TimeTarget timeTarget(point.parameter * point.rate / 1000);
+  CounterTarget counterTarget(point.parameter);
+  VerticalTarget verticalTarget;
+  ReplayTarget* target = &verticalTarget;
+  if (point.strategy == SWEEP_TIME) {
+    target = &timeTarget;
+  } else if (point.strategy == SWEEP_COUNTER) {
+    target = &counterTarget;
+  }
+
+  ReplayStats stats;
+  for (size_t i = 0; i < traces.size(); i++) {
+    replayTrace(traces[i], *target, config, (uint32_t)(phases[i] * config.samplePeriodUs), stats);
+  }
+
+  // Presses and releases together
+  std::vector<uint32_t> latencies = stats.pressLatency;
+  latencies.insert(latencies.end(), stats.releaseLatency.begin(), stats.releaseLatency.end());
+  point.latencyP50 = latencyPercentile(latencies, 500);
+  point.latencyP99 = latencyPercentile(latencies, 990);
+  point.falseTriggers = stats.falseTriggers;
+  point.missed = stats.missed;
+  point.transitions = stats.transitions;
+}
+
+static std::vector<SweepPoint> buildGrid() {
+  std::vector<SweepPoint> grid;
+  SweepPoint point = {};
+  for (uint32_t rate : SAMPLE_RATES) {
+    point.rate = rate;
+    point.strategy = SWEEP_TIME;
+    for (uint32_t ms = 1; ms <= MAX_WINDOW_MS; ms++) {
+      point.parameter = ms;
+      grid.push_back(point);
+    }
+    point.strategy = SWEEP_COUNTER;
+    for (uint32_t count = 1; count <= MAX_COUNT; count++) {
+      point.parameter = count;
+      grid.push_back(point);
+    }
+    point.strategy = SWEEP_VERTICAL;
+    point.parameter = PORT_DEBOUNCE_SAMPLES;
+    grid.push_back(point);
+  }
+  return grid;
+}
+
+// Points not beaten on both latency and errors by any other point
+static std::vector<SweepPoint> paretoFront(std::vector<SweepPoint> points) {
+  std::sort(points.begin(), points.end(), [](const SweepPoint& a, const SweepPoint& b) {
+    if (a.latencyP99 != b.latencyP99) {
+      return a.latencyP99 < b.latencyP99;
+    }
+    return a.errorsPerThousand() < b.errorsPerThousand();
+  });
+
+  std::vector<SweepPoint> front;
+  for (const SweepPoint& point : points) {
+    if (front.empty() || point.errorsPerThousand() < front.back().errorsPerThousand()) {
+      front.push_back(point);
+    }
+  }
+  return front;
+}
+
+static void printPoint(const SweepPoint& point) {
+  printf("  %-17s %4lu %-7s %5lu Hz %8.1f %8.1f %9lu %7lu %9.2f\n",
+         STRATEGY_NAMES[point.strategy], (unsigned long)point.parameter,
+         PARAMETER_UNITS[point.strategy], (unsigned long)point.rate,
+         point.latencyP50 / 1000.0, point.latencyP99 / 1000.0,
+         (unsigned long)point.falseTriggers, (unsigned long)point.missed,
+         point.errorsPerThousand());
+}
+
+static void printHeader() {
+  printf("  %-17s %12s %8s %8s %8s %9s %7s %9s\n", "strategy", "setting", "rate",
+         "p50 ms", "p99 ms", "false", "missed", "err/1000");
+}
+
+static void usage() {
+  fprintf(stderr,
+          "usage: sweep [--threads N] [--count N] [--seed S] [--quiet MS]\n"
+          "             [--csv FILE] [trace files...]\n");
+}
+
+int main(int argc, char** argv) {
+  unsigned threads = 0;
+  uint32_t count = DEFAULT_TRACES;
+  uint32_t seed = 12345;
+  const char* csvPath = NULL;
+  std::vector<const char*> files;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+      threads = strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--count") && i + 1 < argc) {
+      count = strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+      seed = strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--quiet") && i + 1 < argc) {
+      quietUs = strtoul(argv[++i], NULL, 10) * 1000;
+    } else if (!strcmp(argv[i], "--csv") && i + 1 < argc) {
+      csvPath = argv[++i];
+    } else if (argv[i][0] != '-') {
+      files.push_back(argv[i]);
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  if (quietUs == 0) {
+    usage();
+    return 2;
+  }
+
+  // Recorded traces plus synthetic ones
+  for (const char* path : files) {
+    FILE* in = fopen(path, "r");
+    if (in == NULL) {
+      fprintf(stderr, "sweep: cannot open %s\n", path);
+      return 2;
+    }
+    size_t skipped = 0;
+    size_t read = readTraces(in, traces, &skipped);
+    fclose(in);
+    printf("%s: %lu traces, %lu other lines skipped\n", path, (unsigned long)read,
+           (unsigned long)skipped);
+  }
+  TraceGenerator generator(seed);
+  for (uint32_t i = 0; i < count; i++) {
+    traces.push_back(generator.next());
+  }
+  if (traces.empty()) {
+    fprintf(stderr, "sweep: no traces\n");
+    return 2;
+  }
+
+  // Same sample phases at every grid point
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> phase(0.0, 1.0);
+  for (size_t i = 0; i < traces.size(); i++) {
+    phases.push_back(phase(rng));
+  }
+
+  std::vector<SweepPoint> grid = buildGrid();
+  WorkStealingPool pool(threads);
+  auto started = std::chrono::steady_clock::now();
+  pool.run(grid.size(), [&](size_t i) { evaluate(grid[i]); });
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+  printf("Debounce parameter sweep: %lu points x %lu traces on %u threads in %.2f s\n",
+         (unsigned long)grid.size(), (unsigned long)traces.size(), pool.threads(), seconds);
+  printf("  Latency from the first edge to the debounced change; err = false + missed\n\n");
+
+  printf("Pareto front (p99 latency vs errors)\n");
+  printHeader();
+  for (const SweepPoint& point : paretoFront(grid)) {
+    printPoint(point);
+  }
+
+  printf("\nCurrent settings\n");
+  printHeader();
+  for (const SweepPoint& point : grid) {
+    if (point.rate == CURRENT_RATE &&
+        ((point.strategy == SWEEP_TIME && point.parameter == CURRENT_WINDOW_MS) ||
+         (point.strategy == SWEEP_COUNTER && point.parameter == CURRENT_COUNT))) {
+      printPoint(point);
+    }
+  }
+
+  if (csvPath != NULL) {
+    FILE* out = fopen(csvPath, "w");
+    if (out == NULL) {
+      fprintf(stderr, "sweep: cannot write %s\n", csvPath);
+      return 2;
+    }
+    fprintf(out, "strategy,setting,rate_hz,p50_us,p99_us,false_triggers,missed,transitions\n");
+    for (const SweepPoint& point : grid) {
+      fprintf(out, "%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n", STRATEGY_NAMES[point.strategy],
+              (unsigned long)point.parameter, (unsigned long)point.rate,
+              (unsigned long)point.latencyP50, (unsigned long)point.latencyP99,
+              (unsigned long)point.falseTriggers, (unsigned long)point.missed,
+              (unsigned long)point.transitions);
+    }
+    fclose(out);
+  }
+  return 0;
+}
@@ -0,0 +1,160 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <NativeHal.h>
+#include <ButtonGesture.h>
+
+/**
+ * ButtonGesture timing tests (host)
+ *
+ * Each test holds or releases the button for a number of milliseconds,
+ * stepping the NativeHal clock 1 ms at a time and calling update() with
+ * millis() as the sketch's loop() does, and checks which gestures came
+ * out and at which millisecond.
+ *
+ * Run with: pio test -e test
+ */
+
+const byte LOG_MAX = 32;
+
+struct LoggedGesture {
+  GestureEvent event;
+  uint32_t at;          // millis() since the test started
+};
+
+static LoggedGesture gestureLog[LOG_MAX];
+static byte logSize;
+static uint32_t start;
+
+// Keep the button pressed or released for `ms` milliseconds
+static void run(ButtonGesture& gesture, bool pressed, uint32_t ms) {
+  for (uint32_t i = 0; i < ms; i++) {
+    nativeAdvanceMillis(1);
+    GestureEvent event = gesture.update(pressed, millis());
+    if (event != GESTURE_NONE && logSize < LOG_MAX) {
+      gestureLog[logSize].event = event;
+      gestureLog[logSize].at = millis() - start;
+      logSize++;
+    }
+  }
+}
+
+static void expectGesture(byte index, GestureEvent event, uint32_t at) {
+  TEST_ASSERT_TRUE_MESSAGE(index < logSize, "missing gesture");
+  TEST_ASSERT_EQUAL_MESSAGE(event, gestureLog[index].event, "gesture");
+  TEST_ASSERT_EQUAL_MESSAGE(at, gestureLog[index].at, "time");
+}
+
+void setUp() {
+  logSize = 0;
+  start = millis();
+}
+
+void tearDown() {
+}
+
+// Default timing: 300 ms double-click gap, 1000 ms long press, first
+// repeat 500 ms later, then every 200 ms
+
+void test_click_waits_for_the_double_click_gap() {
+  ButtonGesture gesture;
+  run(gesture, false, 10);
+  run(gesture, true, 100);      // Pressed at 11, released at 111
+  run(gesture, false, 500);
+
+  TEST_ASSERT_EQUAL(1, logSize);
+  expectGesture(0, GESTURE_CLICK, 111 + 300);
+}
+
+void test_click_on_release_without_double_clicks() {
+  GestureTiming timing = GESTURE_DEFAULT_TIMING;
+  timing.doubleClickMs = 0;
+  ButtonGesture gesture(timing);
+  run(gesture, true, 100);      // Pressed at 1, released at 101
+  run(gesture, false, 500);
+
+  TEST_ASSERT_EQUAL(1, logSize);
+  expectGesture(0, GESTURE_CLICK, 101);
+}
+
+void test_double_click() {
+  ButtonGesture gesture;
+  run(gesture, true, 80);       // Released at 81
+  run(gesture, false, 150);
+  run(gesture, true, 80);       // Second press at 231
+  run(gesture, false, 500);
+
+  TEST_ASSERT_EQUAL(1, logSize);
+  expectGesture(0, GESTURE_DOUBLE_CLICK, 231);
+}
+
+void test_second_press_too_late_is_two_clicks() {
+  ButtonGesture gesture;
+  run(gesture, true, 80);       // Released at 81
+  run(gesture, false, 400);
+  run(gesture, true, 80);       // Pressed at 481, released at 561
+  run(gesture, false, 500);
+
+  TEST_ASSERT_EQUAL(2, logSize);
+  expectGesture(0, GESTURE_CLICK, 81 + 300);
+  expectGesture(1, GESTURE_CLICK, 561 + 300);
+}
+
+void test_long_press_and_repeats() {
+  ButtonGesture gesture;
+  run(gesture, true, 2000);     // Pressed at 1
+  run(gesture, false, 500);
+
+  // Long press at 1 + 1000, repeats 500 ms later and then every 200 ms
+  // up to the release at 2001; no click after a long press
+  TEST_ASSERT_EQUAL(4, logSize);
+  expectGesture(0, GESTURE_LONG_PRESS, 1001);
+  expectGesture(1, GESTURE_REPEAT, 1501);
+  expectGesture(2, GESTURE_REPEAT, 1701);
+  expectGesture(3, GESTURE_REPEAT, 1901);
+}
+
+void test_zero_repeat_delay_disables_repeats() {
+  GestureTiming timing = GESTURE_DEFAULT_TIMING;
+  timing.repeatDelayMs = 0;
+  ButtonGesture gesture(timing);
+  run(gesture, true, 3000);
+  run(gesture, false, 500);
+
+  TEST_ASSERT_EQUAL(1, logSize);
+  expectGesture(0, GESTURE_LONG_PRESS, 1001);
+}
+
+void test_zero_repeat_interval_disables_repeats() {
+  GestureTiming timing = GESTURE_DEFAULT_TIMING;
+  timing.repeatIntervalMs = 0;
+  ButtonGesture gesture(timing);
+  run(gesture, true, 3000);
+  run(gesture, false, 500);
+
+  TEST_ASSERT_EQUAL(1, logSize);
+  expectGesture(0, GESTURE_LONG_PRESS, 1001);
+}
+
+void test_zero_long_press_disables_long_press() {
+  GestureTiming timing = GESTURE_DEFAULT_TIMING;
+  timing.longPressMs = 0;
+  ButtonGesture gesture(timing);
+  run(gesture, true, 3000);     // Released at 3001
+  run(gesture, false, 500);
+
+  TEST_ASSERT_EQUAL(1, logSize);
+  expectGesture(0, GESTURE_CLICK, 3001 + 300);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_click_waits_for_the_double_click_gap);
+  RUN_TEST(test_click_on_release_without_double_clicks);
+  RUN_TEST(test_double_click);
+  RUN_TEST(test_second_press_too_late_is_two_clicks);
+  RUN_TEST(test_long_press_and_repeats);
+  RUN_TEST(test_zero_repeat_delay_disables_repeats);
+  RUN_TEST(test_zero_repeat_interval_disables_repeats);
+  RUN_TEST(test_zero_long_press_disables_long_press);
+  return UNITY_END();
+}
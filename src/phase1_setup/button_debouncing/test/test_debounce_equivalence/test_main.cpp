@@ -0,0 +1,211 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <Debouncer.h>
+#include <PortDebouncer.h>
+#include "DebounceMethods.h"
+
+/**
+ * Debounce equivalence tests (host)
+ *
+ * TimeDebouncer and CounterDebouncer are wrappers over the Debouncer
+ * library's DebounceWindow and DebounceCount, and the Debouncer<Pin>
+ * strategies replaced hand-written debounce blocks in the sketches. Each
+ * test feeds the same bouncy signal to a strategy and to a reference
+ * copy of the code it replaced, and checks that both report the same
+ * changes at the same samples with the same level afterwards.
+ *
+ * Run with: pio test -e test
+ */
+
+const uint32_t SAMPLES = 100000;
+
+// The debouncers as they were before the Debouncer library (references)
+
+class ReferenceTimeDebouncer {
+  private:
+    byte lastReading;
+    byte state;
+    uint32_t lastChange;
+    uint32_t window;
+
+  public:
+    ReferenceTimeDebouncer(uint32_t windowTicks, byte initialState) {
+      lastReading = initialState;
+      state = initialState;
+      lastChange = 0;
+      window = windowTicks;
+    }
+
+    bool update(byte reading, uint32_t tick) {
+      if (reading != lastReading) {
+        lastChange = tick;
+        lastReading = reading;
+      }
+      if ((tick - lastChange) > window && reading != state) {
+        state = reading;
+        return true;
+      }
+      return false;
+    }
+
+    byte getState() const {
+      return state;
+    }
+};
+
+class ReferenceCounterDebouncer {
+  private:
+    byte state;
+    byte count;
+    byte maxCount;
+
+  public:
+    ReferenceCounterDebouncer(byte requiredCount, byte initialState) {
+      state = initialState;
+      count = 0;
+      maxCount = requiredCount;
+    }
+
+    bool update(byte reading) {
+      if (reading == state) {
+        count = 0;
+        return false;
+      }
+      count++;
+      if (count >= maxCount) {
+        state = reading;
+        count = 0;
+        return true;
+      }
+      return false;
+    }
+
+    byte getState() const {
+      return state;
+    }
+};
+
+// Button signal: a press every 200 samples, held for 100, with 0-12
+// bounce toggles in the 40 samples after each edge and rare single-sample
+// glitches in between. Own generator, so the signal does not depend on
+// the shim's random()
+static byte signal[SAMPLES];
+
+static uint32_t nextRandom(uint32_t& state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+static void buildSignal(uint32_t seed) {
+  uint32_t state = seed;
+  for (uint32_t i = 0; i < SAMPLES; i++) {
+    uint32_t phase = i % 200;
+    signal[i] = (phase >= 50 && phase < 150) ? LOW : HIGH;
+  }
+  for (uint32_t edge = 50; edge < SAMPLES; edge += 100) {
+    uint32_t bounces = nextRandom(state) % 13;
+    for (uint32_t k = 0; k < bounces; k++) {
+      uint32_t at = edge + nextRandom(state) % 40;
+      if (at < SAMPLES) {
+        signal[at] ^= 1;
+      }
+    }
+  }
+  for (uint32_t k = 0; k < SAMPLES / 500; k++) {
+    signal[nextRandom(state) % SAMPLES] ^= 1;
+  }
+}
+
+void setUp() {
+  buildSignal(0x2545F491);
+}
+
+void tearDown() {
+}
+
+void test_time_debouncer_matches_reference() {
+  const uint32_t windows[] = {0, 1, 5, 20, 50, 80};
+  for (uint32_t window : windows) {
+    TimeDebouncer debouncer(window, HIGH);
+    ReferenceTimeDebouncer reference(window, HIGH);
+    uint32_t changes = 0;
+    for (uint32_t i = 0; i < SAMPLES; i++) {
+      bool changed = debouncer.update(signal[i], i);
+      TEST_ASSERT_EQUAL_MESSAGE(reference.update(signal[i], i), changed, "change");
+      TEST_ASSERT_EQUAL_MESSAGE(reference.getState(), debouncer.getState(), "state");
+      changes += changed;
+    }
+    TEST_ASSERT_TRUE(changes > 0);
+  }
+}
+
+// Tick counters wrap; the window must still work across the wrap
+void test_time_debouncer_across_tick_wrap() {
+  TimeDebouncer debouncer(20, HIGH);
+  ReferenceTimeDebouncer reference(20, HIGH);
+  uint32_t start = 0xFFFFFFFFUL - SAMPLES / 2;
+  for (uint32_t i = 0; i < SAMPLES; i++) {
+    TEST_ASSERT_EQUAL_MESSAGE(reference.update(signal[i], start + i),
+                              debouncer.update(signal[i], start + i), "change");
+  }
+  TEST_ASSERT_EQUAL(reference.getState(), debouncer.getState());
+}
+
+void test_counter_debouncer_matches_reference() {
+  const byte counts[] = {1, 2, 5, 10, 50, 127};
+  for (byte count : counts) {
+    CounterDebouncer debouncer(count, HIGH);
+    ReferenceCounterDebouncer reference(count, HIGH);
+    for (uint32_t i = 0; i < SAMPLES; i++) {
+      TEST_ASSERT_EQUAL_MESSAGE(reference.update(signal[i]), debouncer.update(signal[i]), "change");
+      TEST_ASSERT_EQUAL_MESSAGE(reference.getState(), debouncer.getState(), "state");
+    }
+  }
+}
+
+// Debouncer<Pin>'s strategies against the same references, with the
+// 16-bit millis() the sketches feed them
+void test_time_window_strategy_matches_reference() {
+  DebounceTimeWindow<50> strategy;
+  strategy.reset(HIGH);
+  ReferenceTimeDebouncer reference(50, HIGH);
+  for (uint32_t i = 0; i < SAMPLES; i++) {
+    TEST_ASSERT_EQUAL_MESSAGE(reference.update(signal[i], i),
+                              strategy.update(signal[i], (uint16_t)i), "change");
+    TEST_ASSERT_EQUAL_MESSAGE(reference.getState(), strategy.level(), "level");
+  }
+}
+
+void test_integrator_strategy_matches_reference() {
+  DebounceIntegrator<10> strategy;
+  strategy.reset(HIGH);
+  ReferenceCounterDebouncer reference(10, HIGH);
+  for (uint32_t i = 0; i < SAMPLES; i++) {
+    TEST_ASSERT_EQUAL_MESSAGE(reference.update(signal[i]), strategy.update(signal[i], 0), "change");
+    TEST_ASSERT_EQUAL_MESSAGE(reference.getState(), strategy.level(), "level");
+  }
+}
+
+void test_vertical_counter_strategy_matches_port_debouncer() {
+  DebounceVerticalCounter strategy;
+  strategy.reset(HIGH);
+  PortDebouncer port(0xFF);
+  for (uint32_t i = 0; i < SAMPLES; i++) {
+    byte toggled = port.update(signal[i] ? 0xFF : 0x00);
+    TEST_ASSERT_EQUAL_MESSAGE(toggled & 0x01, strategy.update(signal[i], 0), "change");
+    TEST_ASSERT_EQUAL_MESSAGE(port.levels() & 0x01, strategy.level(), "level");
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_time_debouncer_matches_reference);
+  RUN_TEST(test_time_debouncer_across_tick_wrap);
+  RUN_TEST(test_counter_debouncer_matches_reference);
+  RUN_TEST(test_time_window_strategy_matches_reference);
+  RUN_TEST(test_integrator_strategy_matches_reference);
+  RUN_TEST(test_vertical_counter_strategy_matches_port_debouncer);
+  return UNITY_END();
+}
@@ -0,0 +1,214 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <UartSerial.h>
+
+/**
+ * UartSerial overflow tests (host)
+ *
+ * Under the drop policy a full TX ring must never tear a line into the
+ * next one, and a dropped TokenLog frame must not stop later frames.
+ * The tests write text lines and COBS-style frames (0x00 ... 0x00) much
+ * faster than the "UART" drains them - the test calls the data register
+ * empty handler itself and collects UDR0 - and then parse the output.
+ *
+ * Run with: pio test -e test
+ */
+
+const uint32_t OUTPUT_MAX = 200000;
+
+static byte output[OUTPUT_MAX];
+static uint32_t outputSize;
+
+static uint32_t nextRandom(uint32_t& state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+// Let the UART send up to `bytes` queued bytes
+static void drain(UartSerial& uart, uint32_t bytes) {
+  for (uint32_t i = 0; i < bytes; i++) {
+    if (uart.availableForWrite() == UART_TX_BUFFER_SIZE - 1) {
+      return;
+    }
+    uart.handleTxReady();
+    if (outputSize < OUTPUT_MAX) {
+      output[outputSize++] = UDR0;
+    }
+  }
+}
+
+static void drainAll(UartSerial& uart) {
+  drain(uart, UART_TX_BUFFER_SIZE);
+}
+
+// Text line `id`: "L<id> " then a payload of id % 40 + 1 letters, sent
+// in three writes like print(label); print(value); println(text)
+static void expectedLine(uint32_t id, char* line) {
+  byte length = sprintf(line, "L%lu ", (unsigned long)id);
+  for (byte i = 0; i < id % 40 + 1; i++) {
+    line[length++] = 'a' + (id + i) % 26;
+  }
+  line[length] = 0;
+}
+
+static void writeLine(UartSerial& uart, uint32_t id) {
+  char line[64];
+  expectedLine(id, line);
+  char* value = strchr(line, ' ');
+  uart.print("L");
+  uart.write((const uint8_t*)line + 1, value - line);
+  uart.println(value + 1);
+}
+
+// Frame `id`: 0x00, id as 4 non-zero bytes, 0xF5, 0x00
+static void frameBytes(uint32_t id, byte* frame) {
+  frame[0] = 0;
+  for (byte i = 0; i < 4; i++) {
+    frame[1 + i] = (byte)(0x80 | ((id >> (7 * i)) & 0x7F));
+  }
+  frame[5] = 0xF5;
+  frame[6] = 0;
+}
+
+static void writeFrame(UartSerial& uart, uint32_t id) {
+  byte frame[7];
+  frameBytes(id, frame);
+  uart.write(frame, sizeof(frame));
+}
+
+// Check one received text line: "L<id> ..." and a prefix of line id
+static bool lineValid(const char* text, uint32_t length) {
+  if (length == 0 || text[0] != 'L') {
+    return false;
+  }
+  uint32_t id = strtoul(text + 1, NULL, 10);
+  char line[64];
+  expectedLine(id, line);
+  if (length > strlen(line) || memcmp(text, line, length) != 0) {
+    return false;
+  }
+  // A shortened line stops at a write boundary ("L", "L<id> ") or is whole
+  return length == 1 || length == (uint32_t)(strchr(line, ' ') - line) + 1 ||
+         length == strlen(line);
+}
+
+void setUp() {
+  outputSize = 0;
+}
+
+void tearDown() {
+}
+
+void test_partial_line_is_ended_before_the_next() {
+  UartSerial uart;
+  uart.begin(115200);
+
+  // Fill the ring so "Raw: " just fits and "PRESSED" does not
+  char filler[UART_TX_BUFFER_SIZE];
+  memset(filler, 'x', sizeof(filler));
+  uint16_t fill = UART_TX_BUFFER_SIZE - 1 - 2 - 5 - UART_LINE_END_RESERVE;
+  filler[fill] = 0;
+  uart.println(filler);
+  uart.print("Raw: ");
+  uart.println("PRESSED");
+  TEST_ASSERT_EQUAL(1, uart.droppedWrites());
+
+  drainAll(uart);
+  uart.println("next");
+  drainAll(uart);
+
+  const char* tail = "Raw: \r\nnext\r\n";
+  TEST_ASSERT_TRUE(outputSize == fill + 2 + strlen(tail));
+  TEST_ASSERT_TRUE(memcmp(output + fill + 2, tail, strlen(tail)) == 0);
+}
+
+void test_dropped_frame_does_not_block_later_frames() {
+  UartSerial uart;
+  uart.begin(115200);
+
+  // A frame that does not fit is dropped on its own
+  char filler[UART_TX_BUFFER_SIZE];
+  memset(filler, 'x', sizeof(filler));
+  filler[UART_TX_BUFFER_SIZE - 1 - 2 - 3] = 0;
+  uart.println(filler);
+  writeFrame(uart, 1);
+  TEST_ASSERT_EQUAL(1, uart.droppedWrites());
+
+  // The next frame and text line get through once there is room
+  drainAll(uart);
+  uint32_t start = outputSize;
+  writeFrame(uart, 2);
+  uart.println("after");
+  drainAll(uart);
+
+  byte frame[7];
+  frameBytes(2, frame);
+  TEST_ASSERT_TRUE(outputSize == start + sizeof(frame) + 7);
+  TEST_ASSERT_TRUE(memcmp(output + start, frame, sizeof(frame)) == 0);
+  TEST_ASSERT_TRUE(memcmp(output + start + sizeof(frame), "after\r\n", 7) == 0);
+}
+
+void test_back_pressure_never_tears_a_line() {
+  UartSerial uart;
+  uart.begin(115200);
+
+  uint32_t state = 0x2545F491;
+  uint32_t nextLine = 0;
+  uint32_t nextFrame = 0;
+  for (uint32_t i = 0; i < 10000; i++) {
+    if (nextRandom(state) % 4 == 0) {
+      writeFrame(uart, nextFrame++);
+    } else {
+      writeLine(uart, nextLine++);
+    }
+    // The UART sends fewer bytes than are written
+    drain(uart, nextRandom(state) % 24);
+  }
+  drainAll(uart);
+  TEST_ASSERT_TRUE(uart.droppedWrites() > 0);
+  TEST_ASSERT_TRUE(outputSize < OUTPUT_MAX);
+
+  // Walk the output: frames between 0x00 delimiters, text lines ending
+  // in "\r\n"
+  uint32_t lines = 0;
+  uint32_t frames = 0;
+  uint32_t lastFrame = 0;
+  uint32_t pos = 0;
+  while (pos < outputSize) {
+    if (output[pos] == 0) {
+      byte frame[7];
+      TEST_ASSERT_TRUE(pos + sizeof(frame) <= outputSize);
+      uint32_t id = 0;
+      for (byte i = 0; i < 4; i++) {
+        id |= (uint32_t)(output[pos + 1 + i] & 0x7F) << (7 * i);
+      }
+      frameBytes(id, frame);
+      TEST_ASSERT_TRUE_MESSAGE(memcmp(output + pos, frame, sizeof(frame)) == 0, "torn frame");
+      TEST_ASSERT_TRUE_MESSAGE(frames == 0 || id > lastFrame, "frame order");
+      lastFrame = id;
+      frames++;
+      pos += sizeof(frame);
+    } else {
+      uint32_t end = pos;
+      while (end + 1 < outputSize && !(output[end] == '\r' && output[end + 1] == '\n')) {
+        end++;
+      }
+      TEST_ASSERT_TRUE_MESSAGE(end + 1 < outputSize, "unterminated line");
+      TEST_ASSERT_TRUE_MESSAGE(lineValid((const char*)output + pos, end - pos), "torn line");
+      lines++;
+      pos = end + 2;
+    }
+  }
+  TEST_ASSERT_TRUE(lines > 0);
+  TEST_ASSERT_TRUE(frames > 0);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_partial_line_is_ended_before_the_next);
+  RUN_TEST(test_dropped_frame_does_not_block_later_frames);
+  RUN_TEST(test_back_pressure_never_tears_a_line);
+  return UNITY_END();
+}
@@ -0,0 +1,174 @@
+#include <NativeHal.h>
+#include <MicroBench.h>
+#include <FastRandom.h>
+#include <ShiftChain.h>
+#include "BitPatterns.h"
+
+/**
+ * Bit Pattern Benchmark (host)
+ *
+ * Times one step of every pattern program (runCurrentPattern(), a
+ * PatternVm step, plus the port write in updateLeds()) and a whole
+ * loop() pass with nothing due. The sketch's setup()/loop() are linked
+ * in unchanged; the virtual clock is never advanced during the timed
+ * loop() runs.
+ *
+ * Also counts LED pin changes per step from the pin trace, as a check
+ * that each generator still produces the same sequence.
+ *
+ * Built with LED_SHIFT_BYTES (env:native_shift) the LEDs are on the mock
+ * 74HC595 chain instead: LED changes are counted from the chain's
+ * latched outputs, every step is checked against ledState, and the
+ * interrupt-driven ShiftChain.send() is checked the same way.
+ *
+ * Last, the cost of one random LED frame (NUM_LEDS LEDs) from random()
+ * - a byte or a bit per call, as the patterns used to - and from
+ * FastRandom. The host random() runs avr-libc's algorithm (a 32-bit
+ * divide per call), but the board has no divide instruction, so there
+ * the gap is wider than here: the uno_bench firmware times the same
+ * three frames in simavr (markers 3-5, tools/avrbench).
+ *
+ * Run with: pio run -e native -t exec (or -e native_shift)
+ */
+
+void setup();
+void loop();
+
+const uint32_t STEPS = 200000;
+const uint32_t TRACE_STEPS = 1024;
+
+static void step() {
+  runCurrentPattern();
+  updateLeds();
+  patternStep++;
+}
+
+static void startPattern(PatternType pattern) {
+  currentPattern = pattern;
+  patternStep = 0;
+  clearLeds();
+  restartPattern();
+  FastRandom.seed(1);
+}
+
+static byte randomFrame[LED_BYTES];
+
+// random(256) for every byte of the frame
+static void randomFrameBytes() {
+  for (byte i = 0; i < LED_BYTES; i++) {
+    randomFrame[i] = random(256);
+  }
+}
+
+// random(2) for every LED of the frame
+static void randomFrameBits() {
+  memset(randomFrame, 0, LED_BYTES);
+  for (uint16_t led = 0; led < NUM_LEDS; led++) {
+    if (random(2)) {
+      randomFrame[led >> 3] |= 1 << (led & 7);
+    }
+  }
+}
+
+#ifdef LED_SHIFT_BYTES
+static byte chainOutput[LED_BYTES];
+
+// Latched chain outputs into chainOutput; returns how many LEDs changed
+static uint32_t readChain() {
+  uint32_t changes = 0;
+  for (byte i = 0; i < LED_BYTES; i++) {
+    byte value = nativeShiftChainOutput(i);
+    changes += __builtin_popcount(value ^ chainOutput[i]);
+    chainOutput[i] = value;
+  }
+  return changes;
+}
+
+// Average LED changes per step over a short run, counting steps where the
+// chain does not show ledState. With async, frames go out with send()
+static double chainChangesPerStep(PatternType pattern, bool async, uint32_t& mismatches) {
+  startPattern(pattern);
+  readChain();
+  uint32_t changes = 0;
+  for (uint32_t i = 0; i < TRACE_STEPS; i++) {
+    runCurrentPattern();
+    if (async) {
+      ShiftChain.send(ledState);
+    } else {
+      updateLeds();
+    }
+    patternStep++;
+    nativeAdvanceMillis(1);   // Runs the SPI interrupts of a send()
+    changes += readChain();
+    if (memcmp(chainOutput, ledState, LED_BYTES) != 0) {
+      mismatches++;
+    }
+  }
+  return (double)changes / TRACE_STEPS;
+}
+#else
+
+// Average LED pin changes per step over a short traced run
+static double changesPerStep(PatternType pattern) {
+  startPattern(pattern);
+  nativeTraceClear();
+  nativeTraceEnable(true);
+  for (uint32_t i = 0; i < TRACE_STEPS; i++) {
+    step();
+    nativeAdvanceMillis(1);
+  }
+  nativeTraceEnable(false);
+  return (double)nativeTraceSize() / TRACE_STEPS;
+}
+#endif
+
+int main() {
+  Serial.setMuted(true);
+  nativeReset();
+  nativeSetInput(BUTTON_PIN, HIGH);   // Button released
+#ifdef LED_SHIFT_BYTES
+  nativeShiftChainBegin(SHIFT_LATCH_PIN, LED_BYTES);
+#endif
+  setup();
+
+#ifdef LED_SHIFT_BYTES
+  uint32_t writeMismatches = 0;
+  uint32_t sendMismatches = 0;
+#endif
+
+  MicroBench bench("Bit manipulation patterns");
+  for (byte p = 0; p < PATTERN_COUNT; p++) {
+    PatternType pattern = (PatternType)p;
+    // Flash strings are plain strings on the host
+    const char* patternLabel = (const char*)patternName(pattern);
+    char name[48];
+    snprintf(name, sizeof(name), "%s step", patternLabel);
+    bench.run(name, STEPS, [&] { startPattern(pattern); }, [](uint32_t) { step(); });
+#ifdef LED_SHIFT_BYTES
+    snprintf(name, sizeof(name), "%s LED changes", patternLabel);
+    bench.note(name, chainChangesPerStep(pattern, false, writeMismatches), "per step");
+    chainChangesPerStep(pattern, true, sendMismatches);
+#else
+    snprintf(name, sizeof(name), "%s pin changes", patternLabel);
+    bench.note(name, changesPerStep(pattern), "per step");
+#endif
+  }
+
+#ifdef LED_SHIFT_BYTES
+  // Chain outputs that did not match ledState after a step (should be 0)
+  bench.note("chain mismatches, write()", writeMismatches, "steps");
+  bench.note("chain mismatches, send()", sendMismatches, "steps");
+#endif
+
+  // Button poll and interval check only
+  bench.run("loop() with nothing due", STEPS, [](uint32_t) { loop(); });
+  printf("\n");
+
+  MicroBench frames("Random LED frame");
+  frames.run("random(256) per byte", STEPS, [](uint32_t) { randomFrameBytes(); });
+  frames.run("random(2) per LED", STEPS, [](uint32_t) { randomFrameBits(); });
+  frames.run("FastRandom.fillBits()", STEPS, [](uint32_t) {
+    FastRandom.fillBits(randomFrame, NUM_LEDS);
+  });
+  return 0;
+}
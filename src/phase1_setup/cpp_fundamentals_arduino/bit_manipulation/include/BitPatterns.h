@@ -0,0 +1,59 @@
+#ifndef BIT_PATTERNS_H
+#define BIT_PATTERNS_H
+
+#include <Arduino.h>
+#include <PatternRegistry.h>
+
+/**
+ * BitPatterns - Pattern state and generators shared by the sketch and
+ * the host benchmark (bench/)
+ */
+
+// LED output: 8 LEDs on pins 2-9, or with LED_SHIFT_BYTES set (see
+// platformio.ini) that many chained 74HC595s on the SPI pins
+#ifdef LED_SHIFT_BYTES
+const byte LED_BYTES = LED_SHIFT_BYTES;
+const byte BUTTON_PIN = 2;       // Pin 10 is the shift register latch
+#else
+const byte LED_BYTES = 1;
+const byte BUTTON_PIN = 10;      // Button on pin 10
+#endif
+const uint16_t NUM_LEDS = LED_BYTES * 8;
+
+// Every pattern, declared once: enum value, name, step interval (ms)
+// and its PatternVm program (patterns/BitPrograms.pvasm). The enum and
+// the flash table in main.cpp are generated from this list with the
+// PatternRegistry expanders, so a new pattern is one line here plus its
+// program.
+#define BIT_PATTERN_LIST(PATTERN) \
+  PATTERN(PATTERN_BINARY_COUNT, "Binary Counter",   100, PROGRAM_BINARY_COUNT)  /* Binary counting */ \
+  PATTERN(PATTERN_SHIFT_LEFT,   "Shift Left",       150, PROGRAM_SHIFT_LEFT)    /* Left shifting */ \
+  PATTERN(PATTERN_SHIFT_RIGHT,  "Shift Right",      150, PROGRAM_SHIFT_RIGHT)   /* Right shifting */ \
+  PATTERN(PATTERN_ALTERNATE,    "Alternating Bits", 300, PROGRAM_ALTERNATE)     /* Alternating bits */ \
+  PATTERN(PATTERN_RANDOM_BITS,  "Random Bits",       80, PROGRAM_RANDOM_BITS)   /* Random bits */ \
+  PATTERN(PATTERN_KNIGHT_RIDER, "Knight Rider",     100, PROGRAM_KNIGHT_RIDER)  /* Back and forth */
+
+// Pattern definitions
+enum PatternType {
+  BIT_PATTERN_LIST(PATTERN_REGISTRY_ENUM)
+  PATTERN_COUNT             // Total number of patterns
+};
+
+// One registry entry (in flash): the pattern's PatternVm program (PROGMEM)
+typedef PatternEntry<const byte*> BitPatternInfo;
+
+// Pattern state (defined in main.cpp)
+extern PatternType currentPattern;
+extern byte ledState[LED_BYTES];  // LED i is bit i % 8 of byte i / 8
+extern unsigned int patternStep;
+
+// Function prototypes
+void updateLeds();
+void clearLeds();
+void handleButton();
+void restartPattern();
+void runCurrentPattern();
+void displayPatternName();
+const __FlashStringHelper* patternName(PatternType pattern);
+
+#endif
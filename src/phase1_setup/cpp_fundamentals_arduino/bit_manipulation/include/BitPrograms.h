@@ -0,0 +1,81 @@
+// Generated by tools/patternvm/pvasm.py from BitPrograms.pvasm - do not edit
+#ifndef BIT_PROGRAMS_H
+#define BIT_PROGRAMS_H
+
+#include <PatternVm.h>
+
+// binary_count: 8 bytes
+const byte PROGRAM_BINARY_COUNT[] PROGMEM = {
+  0x02, 0x00,   //         fill 0
+  0x01, 0x01,   // top:    wait 1
+  0x0b,         //         inc
+  0x11, 0x02,   //         jump top
+  0x00          //         end
+};
+
+// shift_left: 9 bytes
+const byte PROGRAM_SHIFT_LEFT[] PROGMEM = {
+  0x03, 0x00,   //         only 0
+  0x01, 0x01,   // top:    wait 1
+  0x09, 0x01,   //         rol 1
+  0x11, 0x02,   //         jump top
+  0x00          //         end
+};
+
+// shift_right: 9 bytes
+const byte PROGRAM_SHIFT_RIGHT[] PROGMEM = {
+  0x03, 0xff,   //         only last
+  0x01, 0x01,   // top:    wait 1
+  0x0a, 0x01,   //         ror 1
+  0x11, 0x02,   //         jump top
+  0x00          //         end
+};
+
+// alternate: 9 bytes
+const byte PROGRAM_ALTERNATE[] PROGMEM = {
+  0x02, 0x55,   //         fill 0x55
+  0x01, 0x01,   // top:    wait 1
+  0x06, 0xff,   //         xor 0xff
+  0x11, 0x02,   //         jump top
+  0x00          //         end
+};
+
+// random_bits: 35 bytes
+const byte PROGRAM_RANDOM_BITS[] PROGMEM = {
+  0x0c,         //         random
+  0x0d,         //         save
+  0x0e, 0x00,   //         mask_saved 0x00
+  0x01, 0x01,   //         wait 1
+  0x0e, 0x01,   //         mask_saved 0x01
+  0x01, 0x01,   //         wait 1
+  0x0e, 0x03,   //         mask_saved 0x03
+  0x01, 0x01,   //         wait 1
+  0x0e, 0x07,   //         mask_saved 0x07
+  0x01, 0x01,   //         wait 1
+  0x0e, 0x0f,   //         mask_saved 0x0f
+  0x01, 0x01,   //         wait 1
+  0x0e, 0x1f,   //         mask_saved 0x1f
+  0x01, 0x01,   //         wait 1
+  0x0e, 0x3f,   //         mask_saved 0x3f
+  0x01, 0x01,   //         wait 1
+  0x0e, 0x7f,   //         mask_saved 0x7f
+  0x01, 0x01,   //         wait 1
+  0x00          //         end
+};
+
+// knight_rider: 19 bytes
+const byte PROGRAM_KNIGHT_RIDER[] PROGMEM = {
+  0x03, 0x00,   //         only 0
+  0x0f, 0x00,   // top:    repeat leds-1
+  0x01, 0x01,   //         wait 1
+  0x07, 0x01,   //         shl 1
+  0x10,         //         next
+  0x0f, 0x00,   //         repeat leds-1
+  0x01, 0x01,   //         wait 1
+  0x08, 0x01,   //         shr 1
+  0x10,         //         next
+  0x11, 0x02,   //         jump top
+  0x00          //         end
+};
+
+#endif
@@ -1,4 +1,12 @@
 #include <Arduino.h>
+#include <CycleMarker.h>
+#include <Debouncer.h>
+#include <FastRandom.h>
+#include <PatternVm.h>
+#include <ShiftChain.h>
+#include <TokenLog.h>
+#include "BitPatterns.h"
+#include "BitPrograms.h"
 
 /*
  * LED Bit Manipulation Demo
@@ -7,56 +15,90 @@
  * to control 8 LEDs connected to pins 2-9. The program cycles
  * through various LED patterns using bitwise operations.
  * 
- * Button on pin 10 changes the active pattern.
+ * The patterns are PatternVm byte programs (patterns/BitPrograms.pvasm)
+ * whose ops are the bitwise operations themselves: shifts, rotates,
+ * masks and xor.
+ * 
+ * Button on pin 10 changes the active pattern. A0 is left unconnected:
+ * its noise seeds the random patterns.
+ * 
+ * Built with LED_SHIFT_BYTES=N (env:uno_shift), the LEDs are instead
+ * on N chained 74HC595s driven over SPI (8 x N LEDs, see ShiftChain.h)
+ * and the button moves to pin 2.
  */
 
 // Pin configurations
 const byte FIRST_LED_PIN = 2;    // First LED is on pin 2
-const byte NUM_LEDS = 8;         // Total of 8 LEDs (pins 2-9)
-const byte BUTTON_PIN = 10;      // Button on pin 10
-
-// Pattern definitions
-enum PatternType {
-  PATTERN_BINARY_COUNT,     // Binary counting pattern (0-255)
-  PATTERN_SHIFT_LEFT,       // Left shifting pattern
-  PATTERN_SHIFT_RIGHT,      // Right shifting pattern
-  PATTERN_ALTERNATE,        // Alternating bits pattern
-  PATTERN_RANDOM_BITS,      // Random bit pattern
-  PATTERN_KNIGHT_RIDER,     // Back and forth pattern
-  PATTERN_COUNT             // Total number of patterns
-};
+
+// Button debounced with a 50 ms window (reads the pin's PINx register directly)
+Debouncer<BUTTON_PIN, DebounceTimeWindow<50> > button;
+
+// simavr benchmark marker ids (see tools/avrbench/benchmarks.json)
+const byte MARK_UPDATE_LEDS = 1;
+const byte MARK_RUN_PATTERN = 2;
+const byte MARK_FRAME_RANDOM_BYTES = 3;
+const byte MARK_FRAME_RANDOM_BITS = 4;
+const byte MARK_FRAME_FAST_RANDOM = 5;
+
+#if CYCLE_MARKERS
+const byte RANDOM_FRAME_RUNS = 16;   // Frames timed per method
+void benchRandomFrames();
+#endif
 
 // Global variables
 PatternType currentPattern = PATTERN_BINARY_COUNT;
-byte ledState = 0;          // Current state of all LEDs as a byte
+byte ledState[LED_BYTES];   // Current state of all LEDs, 8 per byte
 unsigned long lastUpdate = 0;
 unsigned long updateInterval = 100; // Default 100ms between updates
-unsigned long lastDebounceTime = 0;
-byte lastButtonState = HIGH;
-byte buttonState = HIGH;
 unsigned int patternStep = 0;
-byte randomByte = 0;       // For random pattern
 
-// Function prototypes
-void updateLeds();
-void handleButton();
-void runCurrentPattern();
-void displayPatternName();
+// Pattern registry, generated from BIT_PATTERN_LIST (BitPatterns.h)
+BIT_PATTERN_LIST(PATTERN_REGISTRY_NAME)
+
+const BitPatternInfo PATTERNS[] PROGMEM = {
+  BIT_PATTERN_LIST(PATTERN_REGISTRY_ENTRY)
+};
+PATTERN_REGISTRY_CHECK(PATTERNS, PATTERN_COUNT);
+PatternVm patternVm;
 
 void setup() {
+#ifdef LED_SHIFT_BYTES
+  // Shift register chain on the SPI pins (latch on pin 10)
+  ShiftChain.begin(LED_BYTES);
+#else
   // Initialize all LED pins as outputs
   for (byte i = 0; i < NUM_LEDS; i++) {
     pinMode(FIRST_LED_PIN + i, OUTPUT);
   }
+#endif
   
   // Initialize button pin as input with pull-up resistor
-  pinMode(BUTTON_PIN, INPUT_PULLUP);
+  button.begin();
   
   // Initialize Serial for debugging
   Serial.begin(9600);
   Serial.println(F("LED Bit Manipulation Demo"));
   Serial.println(F("Press button to change patterns"));
   
+  // Pattern names are sent as TokenLog records
+  // (decode with tools/tokenlog/decode_log.py)
+  TokenLog.begin(Serial);
+  
+  // Marker cost for the simavr benchmarks (nothing in normal builds)
+  CYCLE_MARK_CALIBRATE();
+  
+#if CYCLE_MARKERS
+  // One random frame three ways, timed before the patterns start
+  benchRandomFrames();
+#endif
+  
+  // Random Bits starts somewhere different on every boot (A0 floating)
+  FastRandom.seedFromNoise(A0);
+  
+  // Patterns draw straight into ledState
+  patternVm.begin(ledState, LED_BYTES);
+  restartPattern();
+  
   // Display initial pattern
   displayPatternName();
 }
@@ -81,8 +123,43 @@ void loop() {
   }
 }
 
-// Update all LEDs based on ledState byte
+#if CYCLE_MARKERS
+// Fill ledState with a random frame from avr-libc's random() - a byte
+// or a bit per call, as the random patterns used to - and from
+// FastRandom, each RANDOM_FRAME_RUNS times (simavr benchmark only)
+void benchRandomFrames() {
+  for (byte run = 0; run < RANDOM_FRAME_RUNS; run++) {
+    CYCLE_MARK_BEGIN(MARK_FRAME_RANDOM_BYTES);
+    for (byte i = 0; i < LED_BYTES; i++) {
+      ledState[i] = random(256);
+    }
+    CYCLE_MARK_END(MARK_FRAME_RANDOM_BYTES);
+    
+    CYCLE_MARK_BEGIN(MARK_FRAME_RANDOM_BITS);
+    clearLeds();
+    for (uint16_t led = 0; led < NUM_LEDS; led++) {
+      if (random(2)) {
+        ledState[led >> 3] |= 1 << (led & 7);
+      }
+    }
+    CYCLE_MARK_END(MARK_FRAME_RANDOM_BITS);
+    
+    CYCLE_MARK_BEGIN(MARK_FRAME_FAST_RANDOM);
+    FastRandom.fillBits(ledState, NUM_LEDS);
+    CYCLE_MARK_END(MARK_FRAME_FAST_RANDOM);
+  }
+  clearLeds();
+}
+#endif
+
+// Update all LEDs based on the ledState bytes
 void updateLeds() {
+  CYCLE_MARK_SCOPE(MARK_UPDATE_LEDS);
+  
+#ifdef LED_SHIFT_BYTES
+  // One SPI burst to the whole chain (~1 us per register)
+  ShiftChain.write(ledState);
+#else
   // Method 1: Using individual digitalWrite calls
   /*
   for (byte i = 0; i < NUM_LEDS; i++) {
@@ -95,140 +172,56 @@ void updateLeds() {
   // Method 2: Using direct port manipulation (much faster)
   // For pins 2-7 (PORTD)
   DDRD |= 0b11111100;  // Set pins 2-7 as outputs (bits 2-7)
-  PORTD = (PORTD & 0b00000011) | ((ledState << 2) & 0b11111100);
+  PORTD = (PORTD & 0b00000011) | ((ledState[0] << 2) & 0b11111100);
   
   // For pins 8-9 (PORTB)
   DDRB |= 0b00000011;  // Set pins 8-9 as outputs (bits 0-1)
-  PORTB = (PORTB & 0b11111100) | ((ledState >> 6) & 0b00000011);
+  PORTB = (PORTB & 0b11111100) | ((ledState[0] >> 6) & 0b00000011);
+#endif
 }
 
 // Handle button press with debouncing
 void handleButton() {
-  // Read the button state (LOW when pressed with pull-up)
-  byte reading = digitalRead(BUTTON_PIN);
-  
-  // If the button state changed, reset debounce timer
-  if (reading != lastButtonState) {
-    lastDebounceTime = millis();
-  }
-  
-  // If debounce delay has passed, check if button state is stable
-  if ((millis() - lastDebounceTime) > 50) {
-    // If the button state has changed and is now stable
-    if (reading != buttonState) {
-      buttonState = reading;
-      
-      // If button is pressed (LOW with pull-up resistor)
-      if (buttonState == LOW) {
-        // Switch to next pattern
-        currentPattern = (PatternType)((currentPattern + 1) % PATTERN_COUNT);
-        
-        // Reset pattern step and ledState
-        patternStep = 0;
-        ledState = 0;
-        
-        // Display the name of the new pattern
-        displayPatternName();
-      }
-    }
+  // Switch pattern on each new (debounced) press
+  if (button.update() == DEBOUNCE_PRESSED) {
+    // Switch to next pattern
+    currentPattern = (PatternType)((currentPattern + 1) % PATTERN_COUNT);
+    
+    // Reset pattern step and ledState
+    patternStep = 0;
+    clearLeds();
+    restartPattern();
+    
+    // Display the name of the new pattern
+    displayPatternName();
   }
-  
-  // Save the current reading for the next comparison
-  lastButtonState = reading;
+}
+
+// Turn every LED off
+void clearLeds() {
+  memset(ledState, 0, LED_BYTES);
+}
+
+// Start the current pattern: its program from the top, at its step interval
+void restartPattern() {
+  patternVm.start(patternEntryStep(PATTERNS, currentPattern));
+  updateInterval = patternEntryInterval(PATTERNS, currentPattern);
 }
 
 // Run the currently selected pattern
 void runCurrentPattern() {
-  switch (currentPattern) {
-    case PATTERN_BINARY_COUNT:
-      // Simple binary counter (0-255)
-      ledState = patternStep & 0xFF; // Wrap around at 255
-      break;
-      
-    case PATTERN_SHIFT_LEFT:
-      // Left shift pattern (1 bit moving left, wrapping around)
-      if (patternStep % NUM_LEDS == 0) {
-        ledState = 1; // Start with just the rightmost bit
-      } else {
-        // Shift left by 1 bit
-        ledState = (ledState << 1) | (ledState >> (NUM_LEDS - 1)); // Rotating left shift
-      }
-      break;
-      
-    case PATTERN_SHIFT_RIGHT:
-      // Right shift pattern (1 bit moving right, wrapping around)
-      if (patternStep % NUM_LEDS == 0) {
-        ledState = 0x80; // Start with just the leftmost bit
-      } else {
-        // Shift right by 1 bit
-        ledState = (ledState >> 1) | (ledState << (NUM_LEDS - 1)); // Rotating right shift
-      }
-      break;
-      
-    case PATTERN_ALTERNATE:
-      // Alternating bits pattern (toggle between 01010101 and 10101010)
-      if (patternStep % 2 == 0) {
-        ledState = 0x55; // 01010101 in binary
-      } else {
-        ledState = 0xAA; // 10101010 in binary
-      }
-      break;
-      
-    case PATTERN_RANDOM_BITS:
-      // Generate new random pattern every 8 steps
-      if (patternStep % 8 == 0) {
-        // Generate a new random byte
-        randomByte = random(256);
-      }
-      
-      // Use a different mask based on step to create interesting effects
-      {
-        byte mask = (1 << (patternStep % 8)) - 1;
-        ledState = randomByte & mask;
-      }
-      break;
-      
-    case PATTERN_KNIGHT_RIDER:
-      // Knight Rider/KITT pattern (light moves back and forth)
-      {
-        byte pos = patternStep % (2 * NUM_LEDS - 2);
-        if (pos >= NUM_LEDS) {
-          pos = 2 * NUM_LEDS - 2 - pos; // Reverse direction
-        }
-        ledState = 1 << pos; // Set only the bit at position 'pos'
-      }
-      break;
-  }
+  CYCLE_MARK_SCOPE(MARK_RUN_PATTERN);
+  
+  // One step of the pattern program: draws the next frame into ledState
+  patternVm.step();
 }
 
 // Display the name of the current pattern
 void displayPatternName() {
-  Serial.print(F("Pattern: "));
-  
-  switch (currentPattern) {
-    case PATTERN_BINARY_COUNT:
-      Serial.println(F("Binary Counter"));
-      updateInterval = 100;
-      break;
-    case PATTERN_SHIFT_LEFT:
-      Serial.println(F("Shift Left"));
-      updateInterval = 150;
-      break;
-    case PATTERN_SHIFT_RIGHT:
-      Serial.println(F("Shift Right"));
-      updateInterval = 150;
-      break;
-    case PATTERN_ALTERNATE:
-      Serial.println(F("Alternating Bits"));
-      updateInterval = 300;
-      break;
-    case PATTERN_RANDOM_BITS:
-      Serial.println(F("Random Bits"));
-      updateInterval = 80;
-      break;
-    case PATTERN_KNIGHT_RIDER:
-      Serial.println(F("Knight Rider"));
-      updateInterval = 100;
-      break;
-  }
+  TLOG("Pattern: %s", patternName(currentPattern));
+}
+
+// Name of a pattern (a flash string)
+const __FlashStringHelper* patternName(PatternType pattern) {
+  return patternEntryName(PATTERNS, pattern);
 }
@@ -0,0 +1,166 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <FastRandom.h>
+#include <PatternVm.h>
+#include "BitPatterns.h"
+#include "BitPrograms.h"
+
+/**
+ * Bit pattern program tests (host)
+ *
+ * Runs every program in BIT_PATTERN_LIST on PatternVm for FRAMES steps,
+ * with 8 LEDs (the port backend) and 64 LEDs (8 shift registers), and
+ * checks each frame against a reference generator written directly from
+ * the pattern's description, the way the hand-written switch cases
+ * computed it. Also checks the interpreter's repeat/next handling.
+ *
+ * Run with: pio test -e test
+ */
+
+const uint16_t FRAMES = 1000;     // Several periods of every pattern at 64 LEDs
+const uint32_t SEED = 12345;
+
+// Every pattern's program, from the registry
+#define TEST_PROGRAM(id, name, intervalMs, program) program,
+static const byte* const PROGRAMS[PATTERN_COUNT] = {
+  BIT_PATTERN_LIST(TEST_PROGRAM)
+};
+
+// Reference frames
+
+static void showOnly(byte* state, byte bytes, uint16_t led) {
+  memset(state, 0, bytes);
+  state[led >> 3] = 1 << (led & 7);
+}
+
+// Frame `step` of a pattern on `bytes` bytes of LEDs. The random pattern
+// draws from its own generator, seeded like the one the VM uses
+static void referenceFrame(PatternType pattern, uint16_t step, byte* state, byte bytes,
+                           FastRandomEngine& random, byte* randomBytes) {
+  uint16_t leds = bytes * 8;
+  switch (pattern) {
+    case PATTERN_BINARY_COUNT:
+      // The step count as one binary number across all LEDs
+      for (byte i = 0; i < bytes; i++) {
+        state[i] = i < sizeof(step) ? step >> (8 * i) : 0;
+      }
+      break;
+
+    case PATTERN_SHIFT_LEFT:
+      showOnly(state, bytes, step % leds);
+      break;
+
+    case PATTERN_SHIFT_RIGHT:
+      showOnly(state, bytes, leds - 1 - step % leds);
+      break;
+
+    case PATTERN_ALTERNATE:
+      memset(state, step % 2 == 0 ? 0x55 : 0xAA, bytes);
+      break;
+
+    case PATTERN_RANDOM_BITS:
+      // New random bytes every 8 steps, shown through a growing mask
+      if (step % 8 == 0) {
+        random.fill(randomBytes, bytes);
+      }
+      for (byte i = 0; i < bytes; i++) {
+        state[i] = randomBytes[i] & ((1 << (step % 8)) - 1);
+      }
+      break;
+
+    case PATTERN_KNIGHT_RIDER:
+      {
+        uint16_t pos = step % (2 * leds - 2);
+        if (pos >= leds) {
+          pos = 2 * leds - 2 - pos;
+        }
+        showOnly(state, bytes, pos);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+// Run one program and compare every frame with the reference
+static void checkProgram(PatternType pattern, byte bytes) {
+  byte state[PVM_MAX_BYTES] = {0};
+  byte expected[PVM_MAX_BYTES] = {0};
+  byte randomBytes[PVM_MAX_BYTES] = {0};
+  FastRandomEngine random;
+  random.seed(SEED);
+  FastRandom.seed(SEED);
+
+  PatternVm vm;
+  vm.begin(state, bytes);
+  vm.start(PROGRAMS[pattern]);
+  for (uint16_t step = 0; step < FRAMES; step++) {
+    vm.step();
+    referenceFrame(pattern, step, expected, bytes, random, randomBytes);
+    for (byte i = 0; i < bytes; i++) {
+      if (state[i] != expected[i]) {
+        char message[80];
+        snprintf(message, sizeof(message), "pattern %d, %d LEDs, step %u, byte %d",
+                 pattern, bytes * 8, step, i);
+        TEST_ASSERT_EQUAL_UINT8_MESSAGE(expected[i], state[i], message);
+      }
+    }
+  }
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_programs_match_reference_8_leds() {
+  for (byte pattern = 0; pattern < PATTERN_COUNT; pattern++) {
+    checkProgram((PatternType)pattern, 1);
+  }
+}
+
+void test_programs_match_reference_64_leds() {
+  for (byte pattern = 0; pattern < PATTERN_COUNT; pattern++) {
+    checkProgram((PatternType)pattern, 8);
+  }
+}
+
+// A repeat past PVM_MAX_DEPTH runs its block once; its next must not
+// close the loop around it. pvasm rejects such programs, so this one is
+// written out by hand: the outer loop runs 3 times and shows 3 frames
+void test_repeat_past_max_depth_runs_once() {
+  static const byte PROGRAM[] PROGMEM = {
+    PVM_FILL, 0,
+    PVM_REPEAT, 3,        // 0 - outer, counted
+    PVM_REPEAT, 2,        // 1 - counted
+    PVM_REPEAT, 5,        // 2 - too deep: runs once
+    PVM_INC,
+    PVM_NEXT,             // Closes the skipped block
+    PVM_NEXT,             // Closes the 2-times block
+    PVM_WAIT, 1,
+    PVM_NEXT,             // Closes the outer block
+    PVM_FILL, 0xFF,
+    PVM_WAIT, 1,
+    PVM_END
+  };
+  byte state = 0;
+  PatternVm vm;
+  vm.begin(&state, 1);
+  vm.start(PROGRAM);
+  for (byte frame = 1; frame <= 3; frame++) {
+    vm.step();
+    TEST_ASSERT_EQUAL_UINT8(frame * 2, state);
+  }
+  vm.step();
+  TEST_ASSERT_EQUAL_UINT8(0xFF, state);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_programs_match_reference_8_leds);
+  RUN_TEST(test_programs_match_reference_64_leds);
+  RUN_TEST(test_repeat_past_max_depth_runs_once);
+  return UNITY_END();
+}
@@ -1,4 +1,10 @@
 #include <Arduino.h>
+#include <Debouncer.h>
+#include <IdleSleep.h>
+
+// The CPU sleeps whenever nothing is pending and the button's pin-change
+// interrupt wakes it. With every LED off it powers down completely;
+// otherwise it idles so the PWM outputs keep running.
 
 // Pin definitions
 const byte BUTTON_PIN = 2;
@@ -19,11 +25,8 @@ enum SystemState {
 SystemState currentState = STATE_OFF;
 byte buttonPresses = 0;
 
-// Timing variables for non-blocking operation
-unsigned long lastDebounceTime = 0;
-const unsigned long debounceDelay = 50;
-int lastButtonState = HIGH;
-int buttonState = HIGH;
+// Button with a 50 ms debounce window (direct port read, 3 bytes of state)
+Debouncer<BUTTON_PIN, DebounceTimeWindow<50> > button;
 
 // LED brightness levels
 const byte brightness[] = {0, 64, 150, 255};  // For OFF, LOW, MED, HIGH
@@ -33,7 +36,7 @@ void updateLeds();
 
 void setup() {
   // Configure pins
-  pinMode(BUTTON_PIN, INPUT_PULLUP);
+  button.begin();
   pinMode(RED_LED, OUTPUT);
   pinMode(GREEN_LED, OUTPUT);
   pinMode(BLUE_LED, OUTPUT);
@@ -44,55 +47,57 @@ void setup() {
   Serial.begin(9600);
   Serial.println(F("Button State Machine Example"));
   Serial.println(F("Press button to cycle through states"));
+  
+  // Any change on the button ends a sleep
+  IdleSleep.wakeOnPin(BUTTON_PIN);
 }
 
 void loop() {
-  // Read button with debouncing
-  int reading = digitalRead(BUTTON_PIN);
-  
-  // If button state changed, reset debounce timer
-  if (reading != lastButtonState) {
-    lastDebounceTime = millis();
+  // Read button with debouncing; act on a new press
+  if (button.update() == DEBOUNCE_PRESSED) {
+    // Cycle to next state
+    buttonPresses++;
+    currentState = (SystemState)(buttonPresses % NUM_STATES);
+    
+    // Update LEDs based on new state
+    updateLeds();
+    
+    // Print the current state
+    Serial.print(F("Changed to state: "));
+    
+    switch (currentState) {
+      case STATE_OFF:
+        Serial.println(F("OFF"));
+        break;
+      case STATE_LOW:
+        Serial.println(F("LOW"));
+        break;
+      case STATE_MEDIUM:
+        Serial.println(F("MEDIUM"));
+        break;
+      case STATE_HIGH:
+        Serial.println(F("HIGH"));
+        break;
+    }
+    
+    // Show how quickly the button woke us
+    IdleSleep.report(Serial);
   }
   
-  // If debounce delay passed, check if button state is stable
-  if ((millis() - lastDebounceTime) > debounceDelay) {
-    // If the button state has changed and is now stable
-    if (reading != buttonState) {
-      buttonState = reading;
-      
-      // If button is pressed (LOW with pull-up resistor)
-      if (buttonState == LOW) {
-        // Cycle to next state
-        buttonPresses++;
-        currentState = (SystemState)(buttonPresses % NUM_STATES);
-        
-        // Update LEDs based on new state
-        updateLeds();
-        
-        // Print the current state
-        Serial.print(F("Changed to state: "));
-        
-        switch (currentState) {
-          case STATE_OFF:
-            Serial.println(F("OFF"));
-            break;
-          case STATE_LOW:
-            Serial.println(F("LOW"));
-            break;
-          case STATE_MEDIUM:
-            Serial.println(F("MEDIUM"));
-            break;
-          case STATE_HIGH:
-            Serial.println(F("HIGH"));
-            break;
-        }
-      }
-    }
+  // Sleep until the button changes, or until a running debounce window
+  // has passed
+  uint32_t sleepMs = IDLE_SLEEP_FOREVER;
+  if (!button.isSettled()) {
+    sleepMs = button.remainingMs();
   }
   
-  // Save current reading for next comparison
-  lastButtonState = reading;
+  // PWM needs Timer1/Timer2 running, so only power down with every LED off
+  // (and let the last message leave the UART first)
+  IdleSleep.setPowerDown(currentState == STATE_OFF);
+  if (IdleSleep.isPowerDown()) {
+    Serial.flush();
+  }
+  IdleSleep.sleepFor(sleepMs);
 }
 
 // Function to update LED outputs based on current state
@@ -0,0 +1,178 @@
+#include <NativeHal.h>
+#include <MicroBench.h>
+#include "LedPatterns.h"
+#include "LedGroups.h"
+
+/**
+ * LedPatterns Benchmark (host)
+ *
+ * Times one animation step (update() with a step due: render + commit)
+ * of every pattern on both output backends, and the cost of an update()
+ * pass with nothing due. The virtual clock is advanced by hand, so the
+ * numbers only contain the pattern code and the backend.
+ *
+ * It then runs GROUPS groups of two LEDs both ways - one LedPatterns
+ * object per group and one LedGroups manager - on a backend that only
+ * stores the levels, to compare the loop() cost of the two.
+ *
+ * For the port backend it also counts output pin changes per step from
+ * the pin trace: a jump there means the diff commit stopped working.
+ * (BitAngle drives its pins from the Timer2 interrupt, which does not
+ * run on the host.)
+ *
+ * Run with: pio run -e native -t exec
+ */
+
+constexpr byte BENCH_PINS[] = {9, 10, 11};
+const byte BENCH_LED_COUNT = sizeof(BENCH_PINS);
+const uint32_t STEPS = 100000;
+const uint32_t TRACE_STEPS = 1000;
+const unsigned long STEP_MS = 10;
+
+const PatternState PATTERNS[] = {PATTERN_BLINK, PATTERN_CHASE, PATTERN_FADE, PATTERN_RANDOM};
+const byte GROUPS = 8;
+const byte GROUP_LEDS = 2;
+
+// Backend that only stores what it is given (no pins, no timer)
+class MemoryLedOutput : public LedOutput {
+  private:
+    byte ledCount;
+    byte levels[LED_GROUP_MAX_LEDS];
+
+  public:
+    MemoryLedOutput(byte count) {
+      ledCount = count;
+      memset(levels, 0, sizeof(levels));
+    }
+
+    void begin() {
+    }
+
+    byte count() {
+      return ledCount;
+    }
+
+    void writeMask(LedMask mask) {
+      for (byte i = 0; i < ledCount; i++) {
+        levels[i] = (mask & ((LedMask)1 << i)) ? 255 : 0;
+      }
+    }
+
+    void writeMasked(LedMask mask, LedMask which) {
+      for (byte i = 0; i < ledCount; i++) {
+        if (which & ((LedMask)1 << i)) {
+          levels[i] = (mask & ((LedMask)1 << i)) ? 255 : 0;
+        }
+      }
+    }
+
+    void writeLevel(byte index, byte level) {
+      levels[index] = level;
+    }
+};
+
+// Average output changes per step over a short traced run
+static double changesPerStep(LedPatterns& patterns) {
+  nativeTraceClear();
+  nativeTraceEnable(true);
+  for (uint32_t i = 0; i < TRACE_STEPS; i++) {
+    nativeAdvanceMillis(STEP_MS);
+    patterns.update();
+  }
+  nativeSyncPorts();
+  nativeTraceEnable(false);
+  return (double)nativeTraceSize() / TRACE_STEPS;
+}
+
+static void benchBackend(const char* title, LedOutput& output, bool tracePins) {
+  nativeReset();
+  LedPatterns patterns(output);
+  patterns.begin();
+
+  MicroBench bench(title);
+  for (PatternState pattern : PATTERNS) {
+    patterns.setPattern(pattern);
+    patterns.setStepDuration(STEP_MS);
+    // Flash strings are plain strings on the host
+    const char* patternName = (const char*)patterns.getPatternName();
+    char name[48];
+    snprintf(name, sizeof(name), "%s step", patternName);
+    bench.run(name, STEPS, [&](uint32_t) {
+      nativeAdvanceMillis(STEP_MS);
+      patterns.update();
+    });
+    if (tracePins) {
+      snprintf(name, sizeof(name), "%s pin changes", patternName);
+      bench.note(name, changesPerStep(patterns), "per step");
+    }
+  }
+
+  // Polling cost: the clock does not move, so nothing is due
+  bench.run("update() with nothing due", STEPS, [&](uint32_t) {
+    patterns.update();
+  });
+  printf("\n");
+}
+
+// One group as its own LedPatterns object
+struct SeparateGroup {
+  MemoryLedOutput output;
+  LedPatterns patterns;
+
+  SeparateGroup() : output(GROUP_LEDS), patterns(output) {
+  }
+};
+
+// GROUPS groups, all stepping every STEP_MS: separate objects vs LedGroups
+static void benchGroups() {
+  nativeReset();
+  MicroBench bench("LED groups - 8 groups of 2 LEDs, all due together");
+
+  static SeparateGroup separate[GROUPS];
+  for (byte g = 0; g < GROUPS; g++) {
+    separate[g].patterns.begin();
+    separate[g].patterns.setPattern(PATTERNS[g % 4]);
+    separate[g].patterns.setStepDuration(STEP_MS);
+  }
+  bench.run("LedPatterns objects, step", STEPS, [&](uint32_t) {
+    nativeAdvanceMillis(STEP_MS);
+    for (byte g = 0; g < GROUPS; g++) {
+      separate[g].patterns.update();
+    }
+  });
+  bench.run("LedPatterns objects, nothing due", STEPS, [&](uint32_t) {
+    for (byte g = 0; g < GROUPS; g++) {
+      separate[g].patterns.update();
+    }
+  });
+
+  MemoryLedOutput groupOutput(GROUPS * GROUP_LEDS);
+  LedGroups groups(groupOutput);
+  for (byte g = 0; g < GROUPS; g++) {
+    byte id = groups.add(g * GROUP_LEDS, GROUP_LEDS, PATTERNS[g % 4]);
+    groups.setInterval(id, STEP_MS);
+  }
+  groups.begin();
+  bench.run("LedGroups, step", STEPS, [&](uint32_t) {
+    nativeAdvanceMillis(STEP_MS);
+    groups.update();
+  });
+  bench.run("LedGroups, nothing due", STEPS, [&](uint32_t) {
+    groups.update();
+  });
+
+  printf("\n");
+}
+
+int main() {
+  Serial.setMuted(true);
+
+  PortLedOutput<BENCH_LED_COUNT, BENCH_PINS> portOutput;
+  benchBackend("LedPatterns - port output backend", portOutput, true);
+
+  BamLedOutput bamOutput(BENCH_PINS, BENCH_LED_COUNT);
+  benchBackend("LedPatterns - BitAngle backend", bamOutput, false);
+
+  benchGroups();
+  return 0;
+}
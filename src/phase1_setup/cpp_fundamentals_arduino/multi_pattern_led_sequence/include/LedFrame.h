@@ -0,0 +1,23 @@
+#ifndef LED_FRAME_H
+#define LED_FRAME_H
+
+#include <Arduino.h>
+#include "LedOutput.h"
+
+// Maximum LEDs per object (sizes the per-LED frame and fade arrays)
+const byte LED_MAX = 16;
+
+/**
+ * LedFrame - Off-screen picture of every LED for one pattern step
+ *
+ * Patterns render into a frame instead of writing pins. A frame is
+ * either digital (mask holds the on/off bits) or levels (level[] holds
+ * a brightness per LED), so the commit stage knows which part to diff.
+ */
+struct LedFrame {
+  LedMask mask;              // On/off state, bit i = LED i
+  byte level[LED_MAX];       // Brightness 0-255 per LED
+  bool useLevels;            // true = level[] is valid, false = mask is valid
+};
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef LED_GROUPS_H
+#define LED_GROUPS_H
+
+#include <Arduino.h>
+#include <WaveTable.h>
+#include "LedOutput.h"
+#include "PatternSteps.h"
+
+/**
+ * LedGroups - Many independent LED groups on one output and one time base
+ *
+ * Running 16 groups as 16 LedPatterns objects means 16 millis() reads,
+ * 16 timers and 16 pairs of frames every loop(), and around 100 bytes of
+ * RAM per group. LedGroups splits one output into up to LED_GROUP_MAX
+ * slices of LEDs and keeps the state of every group in parallel arrays
+ * (struct of arrays). A group costs 11 bytes:
+ *
+ *   pattern (1)  step (2)  interval (2)  phase (2)  next due (2)
+ *   first LED (1)  LED count (1)
+ *
+ * update() reads the clock once and renders every group that is due
+ * into one shared frame, with the same step functions as LedPatterns
+ * (PatternSteps.h): each group is a PatternSlice of the frame. commit()
+ * then writes only the LEDs of the groups that were rendered: the
+ * changed on/off LEDs in one writeMasked() call and the changed levels
+ * of fading groups one by one, so groups that step at the same time
+ * change together.
+ *
+ *   LedGroups groups(ledOutput);
+ *   groups.add(0, 4, PATTERN_CHASE);    // LEDs 0-3
+ *   groups.add(4, 4, PATTERN_FADE);     // LEDs 4-7
+ *   groups.begin();
+ *   ...
+ *   groups.update();                    // in loop()
+ *
+ * Every pattern in LED_PATTERN_LIST works here with the same default
+ * interval. Times are 16-bit and compared as signed differences, so
+ * intervals are 1 to LED_GROUP_MAX_INTERVAL ms and a group must be
+ * updated at least every 32 s to keep its phase.
+ */
+
+#ifndef LED_GROUP_MAX
+#define LED_GROUP_MAX 16        // Groups per manager
+#endif
+
+// LEDs across all groups: one LedMask
+const byte LED_GROUP_MAX_LEDS = sizeof(LedMask) * 8;
+
+const byte LED_GROUP_NONE = 0xFF;
+const uint16_t LED_GROUP_MAX_INTERVAL = 0x7FFF;
+
+class LedGroups {
+  private:
+    LedOutput& output;  // Backend that drives every group's pins
+    byte ledCount;      // LEDs driven (all groups together)
+    byte groupCount;    // Groups added so far
+
+    // Group state, one entry per group
+    byte pattern[LED_GROUP_MAX];        // PatternState
+    uint16_t step[LED_GROUP_MAX];       // Step within the pattern
+    uint16_t interval[LED_GROUP_MAX];   // Time between steps (ms)
+    uint16_t phase[LED_GROUP_MAX];      // Fade phase of the group's first LED
+    uint16_t nextDue[LED_GROUP_MAX];    // Low 16 bits of millis() of the next step
+    byte firstLed[LED_GROUP_MAX];       // First LED of the group
+    byte groupLeds[LED_GROUP_MAX];      // LEDs in the group
+    uint16_t nextWake;                  // Earliest nextDue - nothing to do before it
+
+    // Frame being rendered by the groups: on/off LEDs in mask, fading
+    // groups' LEDs (levelLeds) in level[]
+    LedMask mask;
+    LedMask levelLeds;
+    byte level[LED_GROUP_MAX_LEDS];
+    LedMask dirty;                      // LEDs of groups rendered since the last commit
+
+    // What the outputs show
+    LedMask shownMask;
+    LedMask shownLevelLeds;
+    byte shown[LED_GROUP_MAX_LEDS];
+    bool forceFullCommit;               // Outputs unknown - write everything
+
+    // Fade settings, shared by every fading group
+    FadeSettings fade;
+
+    void renderGroup(byte group);
+
+  public:
+    LedGroups(LedOutput& ledOutput);
+
+    void begin();                 // Initialize pins and show every LED off
+    void update();                // Step all due groups and commit (call in loop)
+    void commit();                // Write the changed LEDs of rendered groups
+
+    // Add a group of `count` LEDs starting at `first`, returns its id or
+    // LED_GROUP_NONE if it does not fit. Groups should not overlap
+    byte add(byte first, byte count, PatternState pattern);
+    byte size();                  // Groups added
+
+    // Per-group control
+    void setPattern(byte group, PatternState pattern);   // Also sets its default interval
+    PatternState getPattern(byte group);
+    void setInterval(byte group, uint16_t ms);
+    uint16_t getInterval(byte group);
+
+    // Fade control (all groups)
+    void setFadeShape(WaveShape shape, bool gammaCorrect);
+    void setFadeIncrement(uint16_t increment);
+};
+
+#endif
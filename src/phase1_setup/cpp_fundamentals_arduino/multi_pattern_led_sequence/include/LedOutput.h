@@ -0,0 +1,145 @@
+#ifndef LED_OUTPUT_H
+#define LED_OUTPUT_H
+
+#include <Arduino.h>
+#include <PinSet.h>
+#include <BitAngle.h>
+
+/**
+ * LedOutput - Output backend used by LedPatterns
+ *
+ * LedPatterns decides what each LED should show; a backend decides how
+ * that reaches the pins. Patterns describe on/off states as a bitmask
+ * (bit i = LED i) so a backend can update every LED in one pass.
+ */
+
+// One bit per LED
+typedef uint16_t LedMask;
+
+class LedOutput {
+  public:
+    virtual void begin() = 0;                            // Configure pins
+    virtual byte count() = 0;                            // Number of LEDs driven
+    virtual void writeMask(LedMask mask) = 0;            // Set all LEDs on/off at once
+    virtual void writeLevel(byte index, byte level) = 0; // Set one LED brightness (0-255)
+    virtual void show() {}                               // End of a step - push buffered changes
+
+    // Set only the LEDs in `which` on/off at once; the others keep what
+    // they show (LedGroups: digital groups next to fading ones)
+    virtual void writeMasked(LedMask mask, LedMask which) {
+      for (byte i = 0; which != 0; i++, which >>= 1) {
+        if (which & 1) {
+          writeLevel(i, (mask & ((LedMask)1 << i)) ? 255 : 0);
+        }
+      }
+    }
+};
+
+/**
+ * PortLedOutput - Direct port backend built from a constexpr pin list
+ *
+ * writeMask() and writeMasked() are a single PinSet write (one store per
+ * AVR port).
+ * writeLevel() uses analogWrite(), so fades need hardware PWM pins.
+ */
+template <byte N, const byte (&Pins)[N]>
+class PortLedOutput : public LedOutput {
+  private:
+    typedef PinSet<N, Pins> Leds;
+    LedMask pwmPins;  // Pins analogWrite() has attached a timer to
+
+    // Port writes do not detach PWM timers, so hand the pins back to
+    // plain I/O once after a fade (digitalWrite turns PWM off)
+    void releasePwm(LedMask which) {
+      LedMask release = pwmPins & which;
+      for (byte i = 0; release != 0; i++, release >>= 1) {
+        if (release & 1) {
+          digitalWrite(Leds::pin(i), LOW);
+        }
+      }
+      pwmPins &= ~which;
+    }
+
+  public:
+    PortLedOutput() {
+      pwmPins = 0;
+    }
+
+    void begin() {
+      Leds::begin();
+    }
+
+    byte count() {
+      return N;
+    }
+
+    void writeMask(LedMask mask) {
+      if (pwmPins != 0) {
+        releasePwm(pwmPins);
+      }
+      Leds::write(mask);
+    }
+
+    void writeMasked(LedMask mask, LedMask which) {
+      if (pwmPins & which) {
+        releasePwm(which);
+      }
+      Leds::write(mask, which);
+    }
+
+    void writeLevel(byte index, byte level) {
+      if (index < N) {
+        analogWrite(Leds::pin(index), level);
+        pwmPins |= (LedMask)1 << index;
+      }
+    }
+};
+
+/**
+ * BamLedOutput - Software brightness on any pin through the BitAngle engine
+ *
+ * Levels are buffered and pushed to the Timer2 ISR once per step in
+ * show(), so a fade over many LEDs rebuilds the bit planes only once.
+ */
+class BamLedOutput : public LedOutput {
+  private:
+    const byte* pins;
+    byte pinCount;
+    bool dirty;   // Levels changed since the last show()
+
+  public:
+    BamLedOutput(const byte* ledPins, byte count) {
+      pins = ledPins;
+      pinCount = (count > BAM_MAX_CHANNELS) ? BAM_MAX_CHANNELS : count;
+      dirty = false;
+    }
+
+    void begin() {
+      BitAngle.begin(pins, pinCount);
+    }
+
+    byte count() {
+      return pinCount;
+    }
+
+    void writeMask(LedMask mask) {
+      for (byte i = 0; i < pinCount; i++) {
+        BitAngle.setLevel(i, (mask & ((LedMask)1 << i)) ? 255 : 0);
+      }
+      dirty = true;
+    }
+
+    void writeLevel(byte index, byte level) {
+      BitAngle.setLevel(index, level);
+      dirty = true;
+    }
+
+    void show() {
+      if (dirty) {
+        BitAngle.commit();
+        dirty = false;
+      }
+    }
+};
+
+#endif
@@ -2,6 +2,10 @@
 #define LED_PATTERNS_H
 
 #include <Arduino.h>
+#include <WaveTable.h>
+#include "LedOutput.h"
+#include "LedFrame.h"
+#include "PatternSteps.h"
 
 /**
  * LedPatterns - A class for controlling multiple LED pattern animations
@@ -11,21 +15,17 @@
  * - Non-blocking pattern generation with millis()
  * - State machine implementation
  * - Memory-efficient code organization
+ * - Integer wave tables in flash instead of floating point math
+ * - Double-buffered rendering: patterns draw into a frame and only the
+ *   LEDs that changed since the last commit are written out
+ * - A pattern registry in flash: every pattern is declared once, in
+ *   PatternSteps.h, with a step function LedGroups shares
  */
 
-// Pattern state enum - defines all available patterns
-enum PatternState {
-  PATTERN_BLINK,    // All LEDs blink together
-  PATTERN_CHASE,    // LEDs light up in sequence
-  PATTERN_FADE,     // LEDs fade in and out using PWM
-  PATTERN_RANDOM,   // Random LED patterns
-  PATTERN_COUNT     // Total number of patterns (automatically updates)
-};
-
 class LedPatterns {
   private:
     // LED configuration
-    byte* ledPins;      // Array of pin numbers
+    LedOutput& output;  // Backend that drives the pins
     byte ledCount;      // Number of LEDs
     
     // Pattern state
@@ -34,30 +34,47 @@ class LedPatterns {
     unsigned long lastUpdateTime;    // Last time pattern was updated
     unsigned long patternDuration;   // Time between automatic pattern changes
     unsigned long stepDuration;      // Time between steps in animation
+    bool customStepDuration;         // Set by setStepDuration() - setPattern() keeps it
+    
+    // Frame buffers
+    LedFrame frame;                  // Frame being rendered by the patterns
+    LedFrame shownFrame;             // Frame last written to the outputs
+    bool frameDirty;                 // Rendered since the last commit
+    bool forceFullCommit;            // Outputs unknown - write everything
+    unsigned long lastCommitTime;    // Last time the frame was committed
+    unsigned long commitInterval;    // Time between commits (0 = every step)
     
-    // Private methods for pattern implementations
-    void runBlinkPattern();
-    void runChasePattern();
-    void runFadePattern();
-    void runRandomPattern();
-    void setAllLeds(byte value);
+    // Fade pattern state (8.8 fixed-point phase, LEDs spread evenly)
+    uint16_t fadePhase;              // Current wave table phase of LED 0
+    FadeSettings fade;               // Speed, waveform and gamma
+    
+    void renderMask(LedMask mask);
     
   public:
     // Constructor
-    LedPatterns(byte* pins, byte count);
+    LedPatterns(LedOutput& ledOutput);
     
     // Public methods
     void begin();                 // Initialize pins
     void update();                // Update pattern (call this in loop)
+    void render();                // Draw the next step into the frame
+    void commit();                // Write changed LEDs to the outputs
     
     // Pattern control
-    void setPattern(PatternState pattern);
+    void setPattern(PatternState pattern);   // Also sets its default step interval, unless overridden
     PatternState getCurrentPattern();
-    const char* getPatternName();  // Get current pattern name as string
+    const __FlashStringHelper* getPatternName();  // Current pattern name (in flash)
+    static const __FlashStringHelper* patternName(PatternState pattern);
     
     // Timing control
     void setPatternDuration(unsigned long duration);
-    void setStepDuration(unsigned long duration);
+    void setStepDuration(unsigned long duration);    // Kept across setPattern(), 0 = pattern defaults
+    unsigned long getStepDuration();                 // Period for a scheduler driving render()
+    void setCommitInterval(unsigned long interval);  // Output rate, 0 = after every step
+    
+    // Fade control
+    void setFadeShape(WaveShape shape, bool gammaCorrect);
+    void setFadeIncrement(uint16_t increment);  // WAVE_PHASE_ONE_STEP = 256 steps per cycle
 };
 
 #endif
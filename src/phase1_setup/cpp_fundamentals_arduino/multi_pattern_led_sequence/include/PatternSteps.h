@@ -0,0 +1,84 @@
+#ifndef PATTERN_STEPS_H
+#define PATTERN_STEPS_H
+
+#include <Arduino.h>
+#include <PatternRegistry.h>
+#include <WaveTable.h>
+#include "LedFrame.h"
+
+/**
+ * PatternSteps - The pattern step functions, shared by LedPatterns and
+ * LedGroups
+ *
+ * A step function draws one step of a pattern into a PatternSlice: a run
+ * of 1-LED_MAX LEDs with its own step count and fade phase. LedPatterns
+ * hands it the whole output, LedGroups one group's part of the frame, so
+ * every pattern is written once and works for both.
+ *
+ * On/off patterns set mask (bit i = LED i of the slice), the fade writes
+ * level[] instead. A step may leave the slice as it is (random only
+ * changes every 4 steps), so mask, useLevels and phase come in holding
+ * what the slice shows now.
+ */
+
+// Fade settings, shared by every slice of one owner
+struct FadeSettings {
+  uint16_t increment;   // Phase advance per step (WAVE_PHASE_ONE_STEP = 256 steps per cycle)
+  WaveShape shape;      // Waveform
+  bool gamma;           // Gamma-correct the levels
+};
+
+// What a step function draws into
+struct PatternSlice {
+  byte count;                 // LEDs in the slice (1-LED_MAX)
+  uint16_t step;              // Step within the pattern
+  uint16_t phase;             // Fade phase of the first LED; the others are spread evenly
+  LedMask mask;               // On/off state
+  byte* level;                // count brightness values (0-255)
+  bool useLevels;             // true = level[] is what the slice shows, false = mask
+  const FadeSettings* fade;
+};
+
+typedef void (*PatternStep)(PatternSlice& slice);
+
+// Every pattern, declared once: enum value, name, default step interval
+// (ms) and the step function that renders it. The enum and the flash
+// table both LedPatterns and LedGroups index are generated from this
+// list with the PatternRegistry expanders, so a new pattern is one line
+// here plus its step function.
+#define LED_PATTERN_LIST(PATTERN) \
+  PATTERN(PATTERN_BLINK,  "Blink",  100, blinkStep)   /* All LEDs blink together */ \
+  PATTERN(PATTERN_CHASE,  "Chase",  100, chaseStep)   /* LEDs light up in sequence */ \
+  PATTERN(PATTERN_FADE,   "Fade",   100, fadeStep)    /* Fade in and out (needs brightness) */ \
+  PATTERN(PATTERN_RANDOM, "Random", 100, randomStep)  /* Random LED patterns */
+
+#define LED_PATTERN_DECLARE(id, name, stepMs, step) void step(PatternSlice& slice);
+
+// Pattern state enum - defines all available patterns
+enum PatternState {
+  LED_PATTERN_LIST(PATTERN_REGISTRY_ENUM)
+  PATTERN_COUNT     // Total number of patterns (automatically updates)
+};
+
+LED_PATTERN_LIST(LED_PATTERN_DECLARE)
+
+// One registry entry (in flash): the pattern's step function
+typedef PatternEntry<PatternStep> LedPatternInfo;
+
+// Pattern registry (PatternSteps.cpp), indexed by PatternState
+extern const LedPatternInfo LED_PATTERNS[] PROGMEM;
+
+// Registry lookups (flash reads); pattern must be < PATTERN_COUNT
+inline PatternStep ledPatternStep(byte pattern) {
+  return patternEntryStep(LED_PATTERNS, pattern);
+}
+
+inline uint16_t ledPatternStepMs(byte pattern) {
+  return patternEntryInterval(LED_PATTERNS, pattern);
+}
+
+inline const __FlashStringHelper* ledPatternName(byte pattern) {
+  return patternEntryName(LED_PATTERNS, pattern);
+}
+
+#endif
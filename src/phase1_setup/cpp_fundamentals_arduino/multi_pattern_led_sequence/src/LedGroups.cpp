@@ -0,0 +1,191 @@
+#include "LedGroups.h"
+
+/**
+ * LedGroups implementation
+ */
+
+LedGroups::LedGroups(LedOutput& ledOutput) : output(ledOutput) {
+  byte count = output.count();
+  ledCount = (count > LED_GROUP_MAX_LEDS) ? LED_GROUP_MAX_LEDS : count;
+  groupCount = 0;
+  nextWake = 0;
+  mask = 0;
+  levelLeds = 0;
+  dirty = 0;
+  shownMask = 0;
+  shownLevelLeds = 0;
+  forceFullCommit = true;
+  fade.increment = WAVE_PHASE_ONE_STEP;
+  fade.shape = WAVE_SINE;
+  fade.gamma = false;
+  memset(level, 0, sizeof(level));
+  memset(shown, 0, sizeof(shown));
+}
+
+// Initialize pins and set up initial state
+void LedGroups::begin() {
+  output.begin();
+  mask = 0;
+  levelLeds = 0;
+  forceFullCommit = true;
+  commit();
+}
+
+// Main update function - call this frequently
+void LedGroups::update() {
+  // One clock read for every group
+  uint16_t now = (uint16_t)millis();
+  if ((int16_t)(now - nextWake) < 0) {
+    return;
+  }
+
+  uint16_t earliest = now + LED_GROUP_MAX_INTERVAL;
+  for (byte g = 0; g < groupCount; g++) {
+    uint16_t due = nextDue[g];
+    if ((int16_t)(now - due) >= 0) {
+      renderGroup(g);
+
+      // Keep the group's phase; a group a whole period behind restarts from now
+      due += interval[g];
+      if ((int16_t)(now - due) >= 0) {
+        due = now + interval[g];
+      }
+      nextDue[g] = due;
+    }
+    if ((int16_t)(due - earliest) < 0) {
+      earliest = due;
+    }
+  }
+  nextWake = earliest;
+
+  // Every group that stepped goes out together
+  if (dirty != 0) {
+    commit();
+  }
+}
+
+// Draw the next step of one group into its slice of the frame
+void LedGroups::renderGroup(byte group) {
+  byte first = firstLed[group];
+  LedMask leds = (LedMask)(((1UL << groupLeds[group]) - 1) << first);
+
+  PatternSlice slice;
+  slice.count = groupLeds[group];
+  slice.step = step[group];
+  slice.phase = phase[group];
+  slice.mask = (mask & leds) >> first;
+  slice.level = level + first;
+  slice.useLevels = (levelLeds & leds) != 0;
+  slice.fade = &fade;
+
+  ledPatternStep(pattern[group])(slice);
+
+  mask = (mask & ~leds) | ((LedMask)(slice.mask << first) & leds);
+  if (slice.useLevels) {
+    levelLeds |= leds;
+  } else {
+    levelLeds &= ~leds;
+  }
+  phase[group] = slice.phase;
+  step[group]++;
+  dirty |= leds;
+}
+
+// Write the LEDs of the groups rendered since the last commit that
+// changed. No interrupt lock here: writeMasked() is one store per port
+// (PinSet) and BitAngle only shows new levels at show(), so the LEDs of
+// one update() still change together.
+void LedGroups::commit() {
+  LedMask leds = forceFullCommit ? (LedMask)((1UL << ledCount) - 1) : dirty;
+
+  // On/off LEDs that changed, or that were fading until now
+  LedMask digital = leds & ~levelLeds;
+  if (!forceFullCommit) {
+    digital &= (mask ^ shownMask) | shownLevelLeds;
+  }
+  bool changed = digital != 0;
+  if (changed) {
+    output.writeMasked(mask, digital);
+  }
+
+  // Levels that changed, or that were on/off until now
+  LedMask levels = leds & levelLeds;
+  LedMask fresh = forceFullCommit ? levels : (levels & ~shownLevelLeds);
+  LedMask bit = 1;
+  for (byte i = 0; levels >= bit && bit != 0; i++, bit <<= 1) {
+    if ((levels & bit) && ((fresh & bit) || level[i] != shown[i])) {
+      output.writeLevel(i, level[i]);
+      shown[i] = level[i];
+      changed = true;
+    }
+  }
+
+  // Let the backend push buffered changes
+  if (changed) {
+    output.show();
+  }
+
+  shownMask = mask;
+  shownLevelLeds = levelLeds;
+  dirty = 0;
+  forceFullCommit = false;
+}
+
+// Group management
+
+byte LedGroups::add(byte first, byte count, PatternState pattern) {
+  if (groupCount >= LED_GROUP_MAX || count == 0 || first >= ledCount ||
+      count > ledCount - first || pattern >= PATTERN_COUNT) {
+    return LED_GROUP_NONE;
+  }
+  byte group = groupCount;
+  firstLed[group] = first;
+  groupLeds[group] = count;
+  nextDue[group] = (uint16_t)millis();   // First step on the next update()
+  nextWake = nextDue[group];
+  groupCount++;
+  setPattern(group, pattern);
+  return group;
+}
+
+byte LedGroups::size() {
+  return groupCount;
+}
+
+// Set a group's pattern and its default step interval
+void LedGroups::setPattern(byte group, PatternState newPattern) {
+  if (group < groupCount && newPattern < PATTERN_COUNT) {
+    pattern[group] = newPattern;
+    interval[group] = ledPatternStepMs(newPattern);
+    step[group] = 0;
+    phase[group] = 0;
+  }
+}
+
+PatternState LedGroups::getPattern(byte group) {
+  return group < groupCount ? (PatternState)pattern[group] : PATTERN_COUNT;
+}
+
+// Set the time between a group's steps (1 to LED_GROUP_MAX_INTERVAL ms)
+void LedGroups::setInterval(byte group, uint16_t ms) {
+  if (group < groupCount) {
+    interval[group] = constrain(ms, 1, LED_GROUP_MAX_INTERVAL);
+  }
+}
+
+uint16_t LedGroups::getInterval(byte group) {
+  return group < groupCount ? interval[group] : 0;
+}
+
+// Choose the fade waveform and whether to gamma-correct it
+void LedGroups::setFadeShape(WaveShape shape, bool gammaCorrect) {
+  if (shape < WAVE_SHAPE_COUNT) {
+    fade.shape = shape;
+  }
+  fade.gamma = gammaCorrect;
+}
+
+// Set how far the fade phase advances each step (speed of the fade)
+void LedGroups::setFadeIncrement(uint16_t increment) {
+  fade.increment = increment;
+}
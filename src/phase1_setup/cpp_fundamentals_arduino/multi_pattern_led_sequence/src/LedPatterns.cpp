@@ -1,3 +1,4 @@
+#include <CycleMarker.h>
 #include "LedPatterns.h"
 
 /**
@@ -6,138 +7,138 @@
  * Contains all the code that makes the patterns work
  */
 
-// Constructor - initializes the class with LED pins
-LedPatterns::LedPatterns(byte* pins, byte count) {
-  ledPins = pins;
-  ledCount = count;
+// simavr benchmark marker id (see tools/avrbench/benchmarks.json)
+const byte MARK_COMMIT = 2;
+
+// Constructor - initializes the class with the LED output backend
+LedPatterns::LedPatterns(LedOutput& ledOutput) : output(ledOutput) {
+  byte count = output.count();
+  ledCount = (count > LED_MAX) ? LED_MAX : count;
   currentPattern = PATTERN_BLINK;
   patternStep = 0;
   lastUpdateTime = 0;
   patternDuration = 5000;  // 5 seconds default
-  stepDuration = 100;      // 100ms default step time
+  stepDuration = ledPatternStepMs(PATTERN_BLINK);
+  customStepDuration = false;
+  fadePhase = 0;
+  fade.increment = WAVE_PHASE_ONE_STEP;  // One table entry per step (256-step cycle)
+  fade.shape = WAVE_SINE;
+  fade.gamma = false;
+  frameDirty = false;
+  forceFullCommit = true;
+  lastCommitTime = 0;
+  commitInterval = 0;
+  memset(&frame, 0, sizeof(frame));
+  memset(&shownFrame, 0, sizeof(shownFrame));
 }
 
 // Initialize pins and set up initial state
 void LedPatterns::begin() {
   // Initialize all LED pins as outputs
-  for (byte i = 0; i < ledCount; i++) {
-    pinMode(ledPins[i], OUTPUT);
-  }
+  output.begin();
   
   // Initialize to known state
-  setAllLeds(LOW);
+  renderMask(0);
+  forceFullCommit = true;
+  commit();
 }
 
 // Main update function - call this frequently
 void LedPatterns::update() {
   unsigned long currentTime = millis();
   
-  // Update the pattern state if enough time has passed
+  // Render the next step if enough time has passed
   if (currentTime - lastUpdateTime >= stepDuration) {
     lastUpdateTime = currentTime;
-    
-    // Run the current pattern
-    switch (currentPattern) {
-      case PATTERN_BLINK:
-        runBlinkPattern();
-        break;
-      case PATTERN_CHASE:
-        runChasePattern();
-        break;
-      case PATTERN_FADE:
-        runFadePattern();
-        break;
-      case PATTERN_RANDOM:
-        runRandomPattern();
-        break;
-      default:
-        // Invalid state - reset to blink
-        currentPattern = PATTERN_BLINK;
-        break;
-    }
-    
-    // Increment pattern step for next update
-    patternStep++;
+    render();
   }
-}
-
-// Pattern implementations
-
-// Simple blink pattern - all LEDs on/off together
-void LedPatterns::runBlinkPattern() {
-  // Toggle between all on and all off every step
-  if (patternStep % 2 == 0) {
-    setAllLeds(HIGH);
-  } else {
-    setAllLeds(LOW);
+  
+  // Commit at its own rate (or straight after each step when 0)
+  if (frameDirty && currentTime - lastCommitTime >= commitInterval) {
+    lastCommitTime = currentTime;
+    commit();
   }
 }
 
-// Chase pattern - one LED at a time, back and forth
-void LedPatterns::runChasePattern() {
-  // Calculate which LED should be on
-  // The pattern reverses direction when it reaches the end
-  byte pos = patternStep % (2 * ledCount - 2);
-  if (pos >= ledCount) {
-    pos = 2 * ledCount - 2 - pos; // Reverse direction
+// Draw the next pattern step into the off-screen frame
+void LedPatterns::render() {
+  if (currentPattern < PATTERN_COUNT) {
+    // The whole output is one slice for the shared step functions
+    PatternSlice slice;
+    slice.count = ledCount;
+    slice.step = patternStep;
+    slice.phase = fadePhase;
+    slice.mask = frame.mask;
+    slice.level = frame.level;
+    slice.useLevels = frame.useLevels;
+    slice.fade = &fade;
+    
+    // Step function straight from the registry
+    ledPatternStep(currentPattern)(slice);
+    
+    frame.mask = slice.mask;
+    frame.useLevels = slice.useLevels;
+    fadePhase = slice.phase;
+  } else {
+    // Invalid state - reset to blink
+    currentPattern = PATTERN_BLINK;
   }
   
-  // Turn all LEDs off
-  setAllLeds(LOW);
+  frameDirty = true;
   
-  // Turn on just the active LED
-  digitalWrite(ledPins[pos], HIGH);
+  // Increment pattern step for next update
+  patternStep++;
 }
 
-// Fade pattern - smoothly fade LEDs using sine wave
-void LedPatterns::runFadePattern() {
-  // Base angle from current step (0-255)
-  byte angle = patternStep % 256;
+// Compare the rendered frame with what is shown and write only the changes
+void LedPatterns::commit() {
+  CYCLE_MARK_SCOPE(MARK_COMMIT);
   
-  // Update each LED with a different phase offset
-  for (byte i = 0; i < ledCount; i++) {
-    // Each LED gets a different phase offset
-    byte ledAngle = (angle + (i * (255 / ledCount))) % 256;
-    
-    // Convert angle to radians (0-2π)
-    float radians = (ledAngle / 255.0) * 2 * PI;
-    
-    // Calculate brightness using sine function (0-255)
-    // sin() returns -1 to 1, so we add 1 and multiply by 127
-    byte brightness = (sin(radians) + 1) * 127;
-    
-    // Set LED brightness using PWM
-    analogWrite(ledPins[i], brightness);
-  }
-}
-
-// Random pattern - random LED states
-void LedPatterns::runRandomPattern() {
-  // Only change pattern every few steps for visibility
-  if (patternStep % 4 == 0) {
-    // Set each LED to a random state
+  // Only render() (from loop) writes the frame, so it is read directly.
+  // The LEDs still change together: a mask goes out as one store per
+  // port (PinSet) and the BitAngle backend only shows new levels at show()
+  
+  // Switching between digital and level frames invalidates what the
+  // outputs show, so every LED is written once
+  bool full = forceFullCommit || (frame.useLevels != shownFrame.useLevels);
+  
+  if (frame.useLevels) {
     for (byte i = 0; i < ledCount; i++) {
-      // 50% chance of on/off for each LED
-      byte state = random(2);
-      digitalWrite(ledPins[i], state);
+      if (full || frame.level[i] != shownFrame.level[i]) {
+        output.writeLevel(i, frame.level[i]);
+      }
     }
+  } else if (full || frame.mask != shownFrame.mask) {
+    // All on/off LEDs go out in one write
+    output.writeMask(frame.mask);
   }
+  
+  // Let the backend push buffered changes
+  output.show();
+  
+  shownFrame = frame;
+  frameDirty = false;
+  forceFullCommit = false;
 }
 
-// Utility to set all LEDs to same state
-void LedPatterns::setAllLeds(byte value) {
-  for (byte i = 0; i < ledCount; i++) {
-    digitalWrite(ledPins[i], value);
-  }
+// Utility to render an on/off frame
+void LedPatterns::renderMask(LedMask mask) {
+  frame.mask = mask;
+  frame.useLevels = false;
 }
 
 // Public methods for pattern control
 
-// Set current pattern
+// Set current pattern, and its default step interval unless one was
+// set with setStepDuration()
 void LedPatterns::setPattern(PatternState pattern) {
   if (pattern < PATTERN_COUNT) {
     currentPattern = pattern;
+    if (!customStepDuration) {
+      stepDuration = ledPatternStepMs(pattern);
+    }
     patternStep = 0;  // Reset step for new pattern
+    fadePhase = 0;
   }
 }
 
@@ -146,20 +147,16 @@ PatternState LedPatterns::getCurrentPattern() {
   return currentPattern;
 }
 
-// Get current pattern name as string
-const char* LedPatterns::getPatternName() {
-  switch (currentPattern) {
-    case PATTERN_BLINK:
-      return "Blink";
-    case PATTERN_CHASE:
-      return "Chase";
-    case PATTERN_FADE:
-      return "Fade";
-    case PATTERN_RANDOM:
-      return "Random";
-    default:
-      return "Unknown";
+// Get current pattern name (a flash string, print it directly)
+const __FlashStringHelper* LedPatterns::getPatternName() {
+  return patternName(currentPattern);
+}
+
+const __FlashStringHelper* LedPatterns::patternName(PatternState pattern) {
+  if (pattern >= PATTERN_COUNT) {
+    return F("Unknown");
   }
+  return ledPatternName(pattern);
 }
 
 // Set duration between pattern changes
@@ -167,7 +164,31 @@ void LedPatterns::setPatternDuration(unsigned long duration) {
   patternDuration = duration;
 }
 
-// Set duration between animation steps
+// Set duration between animation steps for every pattern from now on;
+// 0 goes back to each pattern's default interval
 void LedPatterns::setStepDuration(unsigned long duration) {
-  stepDuration = duration;
+  customStepDuration = duration != 0;
+  stepDuration = customStepDuration ? duration : ledPatternStepMs(currentPattern);
 }
+
+unsigned long LedPatterns::getStepDuration() {
+  return stepDuration;
+}
+
+// Set duration between output commits (independent of the render rate)
+void LedPatterns::setCommitInterval(unsigned long interval) {
+  commitInterval = interval;
+}
+
+// Choose the fade waveform and whether to gamma-correct it
+void LedPatterns::setFadeShape(WaveShape shape, bool gammaCorrect) {
+  if (shape < WAVE_SHAPE_COUNT) {
+    fade.shape = shape;
+  }
+  fade.gamma = gammaCorrect;
+}
+
+// Set how far the fade phase advances each step (speed of the fade)
+void LedPatterns::setFadeIncrement(uint16_t increment) {
+  fade.increment = increment;
+}
\ No newline at end of file
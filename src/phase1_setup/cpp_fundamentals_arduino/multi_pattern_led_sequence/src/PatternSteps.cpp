@@ -0,0 +1,76 @@
+#include <CycleMarker.h>
+#include <FastRandom.h>
+#include "PatternSteps.h"
+
+/**
+ * Pattern step functions, shared by LedPatterns and LedGroups
+ */
+
+// simavr benchmark marker id (see tools/avrbench/benchmarks.json)
+const byte MARK_FADE_PATTERN = 1;
+
+// Pattern registry, generated from LED_PATTERN_LIST (PatternSteps.h)
+LED_PATTERN_LIST(PATTERN_REGISTRY_NAME)
+
+const LedPatternInfo LED_PATTERNS[] PROGMEM = {
+  LED_PATTERN_LIST(PATTERN_REGISTRY_ENTRY)
+};
+PATTERN_REGISTRY_CHECK(LED_PATTERNS, PATTERN_COUNT);
+
+// Mask with one bit set per LED of the slice
+static inline LedMask sliceLeds(const PatternSlice& slice) {
+  return (LedMask)((1UL << slice.count) - 1);
+}
+
+// Simple blink pattern - all LEDs on/off together
+void blinkStep(PatternSlice& slice) {
+  // Toggle between all on and all off every step
+  slice.mask = (slice.step % 2 == 0) ? sliceLeds(slice) : 0;
+  slice.useLevels = false;
+}
+
+// Chase pattern - one LED at a time, back and forth
+void chaseStep(PatternSlice& slice) {
+  // Calculate which LED should be on
+  // The pattern reverses direction when it reaches the end
+  byte count = slice.count;
+  byte pos = 0;
+  if (count > 1) {
+    pos = slice.step % (2 * count - 2);
+    if (pos >= count) {
+      pos = 2 * count - 2 - pos; // Reverse direction
+    }
+  }
+
+  // Just the active LED is on - the others are cleared in the same frame
+  slice.mask = (LedMask)1 << pos;
+  slice.useLevels = false;
+}
+
+// Fade pattern - smoothly fade LEDs using a sine wave table
+void fadeStep(PatternSlice& slice) {
+  CYCLE_MARK_SCOPE(MARK_FADE_PATTERN);
+
+  // The LEDs' phases are spread evenly over one cycle, so a step is an
+  // add and a flash read per LED - no float math
+  const FadeSettings& fade = *slice.fade;
+  uint16_t spacing = (uint16_t)(0x10000UL / slice.count);
+  uint16_t phase = slice.phase;
+  for (byte i = 0; i < slice.count; i++) {
+    byte brightness = waveSample8(fade.shape, phase);
+    slice.level[i] = fade.gamma ? gamma8(brightness) : brightness;
+    phase += spacing;
+  }
+  slice.phase += fade.increment;
+  slice.useLevels = true;
+}
+
+// Random pattern - random LED states
+void randomStep(PatternSlice& slice) {
+  // Only change pattern every few steps for visibility
+  if (slice.step % 4 == 0) {
+    // 50% chance of on/off for each LED: one random bit per LED
+    slice.mask = FastRandom.nextWord() & sliceLeds(slice);
+    slice.useLevels = false;
+  }
+}
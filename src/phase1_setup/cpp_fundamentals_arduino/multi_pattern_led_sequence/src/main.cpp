@@ -1,5 +1,10 @@
 #include <Arduino.h>
+#include <CoopScheduler.h>
+#include <CycleMarker.h>
+#include <Debouncer.h>
+#include <FastRandom.h>
 #include "LedPatterns.h"
+#include "LedGroups.h"
 
 /**
  * Multi-Pattern LED Sequence
@@ -8,31 +13,88 @@
  * by creating a reusable LED pattern library. It implements several
  * different patterns with non-blocking code and a button interface.
  * 
+ * All timing goes through a cooperative scheduler: pattern steps, button
+ * polling and automatic pattern changes are tasks with their own periods,
+ * and loop() only runs the ones that are due.
+ * 
  * Circuit:
  * - 3 LEDs connected to pins 9, 10, 11 (through 220Ω resistors)
+ *   (with the BitAngle backend any digital pins can be used)
  * - Button connected to pin 2 (with internal pull-up)
+ * - A0 left unconnected (its noise seeds the random pattern)
+ *
+ * Built with USE_LED_GROUPS=1 (pio run -e uno_groups) the LEDs run as two
+ * independent LedGroups groups instead - LEDs 9/10 and LED 11, each with
+ * its own pattern and interval - and the button moves both on.
  */
 
+// Output backend selection:
+// 1 = BitAngle software brightness (fades work on any pin, uses Timer2)
+// 0 = direct port writes + analogWrite() (fades need hardware PWM pins)
+#define USE_BAM_OUTPUT 1
+
+// Pattern engine: 0 = one LedPatterns for all LEDs, 1 = LedGroups
+#ifndef USE_LED_GROUPS
+#define USE_LED_GROUPS 0
+#endif
+
+// Loop profiling takes Timer1, which analogWrite() needs on pins 9/10,
+// so it is only available with the BAM backend. Send 'p' over serial to
+// print the profile, 'r' to reset it.
+#define LOOP_PROFILER_ENABLED USE_BAM_OUTPUT
+#include <LoopProfiler.h>
+
 // Pin definitions
-const byte LED_PINS[] = {9, 10, 11};  // Must be PWM pins for fade pattern
-const byte LED_COUNT = 3;
+constexpr byte LED_PINS[] = {9, 10, 11};  // Any pins with BAM, PWM pins otherwise
+const byte LED_COUNT = sizeof(LED_PINS);
 const byte BUTTON_PIN = 2;
 
+// Output backend
+#if USE_BAM_OUTPUT
+BamLedOutput ledOutput(LED_PINS, LED_COUNT);
+#else
+// Pin-to-port mapping is worked out at compile time
+PortLedOutput<LED_COUNT, LED_PINS> ledOutput;
+#endif
+
+#if USE_LED_GROUPS
+// Two groups on the one output; update() steps whichever is due
+LedGroups ledGroups(ledOutput);
+byte pairGroup = LED_GROUP_NONE;     // LEDs 0-1
+byte singleGroup = LED_GROUP_NONE;   // LED 2
+const unsigned long groupPollInterval = 1;
+const uint16_t singleGroupInterval = 20;  // Faster than the registry default
+#else
 // Create LED patterns object
-LedPatterns ledPatterns((byte*)LED_PINS, LED_COUNT);
+LedPatterns ledPatterns(ledOutput);
+#endif
 
-// Button state tracking
-bool lastButtonState = HIGH;  // Pull-up means HIGH when not pressed
-unsigned long lastDebounceTime = 0;
-const unsigned long debounceDelay = 50;  // 50ms debounce period
+// Button sampled every 5ms by the scheduler; 10 matching samples in a
+// row (50ms) accept a change
+const unsigned long buttonPollInterval = 5;
+Debouncer<BUTTON_PIN, DebounceIntegrator<10> > button;
 
 // Timing for automatic pattern changes
-unsigned long lastPatternChangeTime = 0;
 const unsigned long patternChangeDuration = 10000;  // 10 seconds
 
+// Task scheduler and its tasks (created in setup())
+CoopScheduler<4> scheduler;
+TaskId patternTask = TASK_NONE;
+TaskId buttonTask = TASK_NONE;
+TaskId autoChangeTask = TASK_NONE;
+uint32_t nextDeadline = 0;    // ms until the next task was due after the last run
+
+// Profiled tasks (registered in setup())
+ProfileSection patternSection = PROFILE_NO_SECTION;
+ProfileSection buttonSection = PROFILE_NO_SECTION;
+ProfileSection autoChangeSection = PROFILE_NO_SECTION;
+
 // Function prototypes
-void handleButtonPress();
-void checkAutoPatternChange();
+void stepPatterns(void*);
+void handleButtonPress(void*);
+void autoChangePattern(void*);
+void handleCommands();
+void printPatternNames();
 
 void setup() {
   // Initialize serial at higher baud rate for smoother output
@@ -42,81 +104,163 @@ void setup() {
   Serial.println(F("Press button to change patterns"));
   
   // Initialize button pin with pull-up resistor
-  pinMode(BUTTON_PIN, INPUT_PULLUP);
+  button.begin();
+  
+  // Marker cost for the simavr benchmarks (nothing in normal builds)
+  CYCLE_MARK_CALIBRATE();
+  
+  // Random pattern starts somewhere different on every boot (A0 floating)
+  FastRandom.seedFromNoise(A0);
   
+#if USE_LED_GROUPS
+  // Initialize the LED groups, each on a different pattern and interval
+  pairGroup = ledGroups.add(0, 2, PATTERN_CHASE);
+  singleGroup = ledGroups.add(2, 1, PATTERN_FADE);
+  ledGroups.setInterval(singleGroup, singleGroupInterval);
+  ledGroups.begin();
+#else
   // Initialize LED patterns
   ledPatterns.begin();
+#endif
   
-  // Set initial pattern timing
-  ledPatterns.setStepDuration(100);  // 100ms between steps
+#if USE_BAM_OUTPUT
+  // Report what the BAM interrupt costs on this board
+  BamIsrStats bamStats = BitAngle.measureIsr();
+  Serial.print(F("BAM ISR: "));
+  Serial.print(bamStats.isrCycles);
+  Serial.print(F(" cycles of "));
+  Serial.print(bamStats.slotCycles);
+  Serial.print(F(" per slot, CPU load "));
+  Serial.print(bamStats.loadPermille / 10);
+  Serial.print('.');
+  Serial.print(bamStats.loadPermille % 10);
+  Serial.println(F("%"));
+#endif
+  
+#if LOOP_PROFILER_ENABLED
+  patternSection = LoopProfiler.section(F("pattern update"));
+  buttonSection = LoopProfiler.section(F("button"));
+  autoChangeSection = LoopProfiler.section(F("auto change"));
+  LoopProfiler.begin();
+#endif
+  
+  // Register the tasks that make up the main loop
+#if USE_LED_GROUPS
+  // (the groups keep their own due times; the task only polls them)
+  patternTask = scheduler.every(groupPollInterval, stepPatterns);
+#else
+  // (the pattern step period is each pattern's default from the registry)
+  patternTask = scheduler.every(ledPatterns.getStepDuration(), stepPatterns);
+#endif
+  buttonTask = scheduler.every(buttonPollInterval, handleButtonPress);
+  autoChangeTask = scheduler.every(patternChangeDuration, autoChangePattern,
+                                   NULL, patternChangeDuration);
   
   // Display initial pattern
   Serial.print(F("Initial pattern: "));
-  Serial.println(ledPatterns.getPatternName());
+  printPatternNames();
 }
 
 void loop() {
-  // Update LED patterns (non-blocking)
-  ledPatterns.update();
+  // Run whichever tasks are due (non-blocking)
+  nextDeadline = scheduler.run();
   
-  // Handle button presses (with debouncing)
-  handleButtonPress();
-  
-  // Check for automatic pattern changes
-  checkAutoPatternChange();
+  // Serial commands (profile dump)
+  handleCommands();
   
   // Other code can run here without being blocked
   // This demonstrates the non-blocking approach
 }
 
-// Handle button presses with debouncing
-void handleButtonPress() {
-  // Read current button state
-  int reading = digitalRead(BUTTON_PIN);
-  unsigned long currentTime = millis();
-  
-  // If the button state changed, reset debounce timer
-  if (reading != lastButtonState) {
-    lastDebounceTime = currentTime;
-  }
+#if USE_LED_GROUPS
+// Step the groups that are due and show them
+void stepPatterns(void*) {
+  PROFILE_SCOPE(patternSection);
+  ledGroups.update();
+}
+
+// Move a group on to the next pattern
+void nextGroupPattern(byte group) {
+  PatternState nextPattern = (PatternState)((ledGroups.getPattern(group) + 1) % PATTERN_COUNT);
+  ledGroups.setPattern(group, nextPattern);
+}
+
+// Print every group's pattern
+void printPatternNames() {
+  Serial.print(ledPatternName(ledGroups.getPattern(pairGroup)));
+  Serial.print(F(" / "));
+  Serial.println(ledPatternName(ledGroups.getPattern(singleGroup)));
+}
+
+// Advance both groups to their next pattern and say why
+void nextPattern(const __FlashStringHelper* reason) {
+  nextGroupPattern(pairGroup);
+  nextGroupPattern(singleGroup);
+  ledGroups.setInterval(singleGroup, singleGroupInterval);
   
-  // If debounce delay has passed, check if button state is stable
-  if ((currentTime - lastDebounceTime) > debounceDelay) {
-    // If button is newly pressed (LOW due to pull-up)
-    if (reading == LOW && lastButtonState == HIGH) {
-      // Change to next pattern
-      PatternState currentPattern = ledPatterns.getCurrentPattern();
-      PatternState nextPattern = (PatternState)((currentPattern + 1) % PATTERN_COUNT);
-      ledPatterns.setPattern(nextPattern);
-      
-      // Reset automatic pattern change timer
-      lastPatternChangeTime = currentTime;
-      
-      // Display the new pattern name
-      Serial.print(F("Button pressed! Changed to pattern: "));
-      Serial.println(ledPatterns.getPatternName());
-    }
-  }
+  Serial.print(reason);
+  printPatternNames();
+}
+#else
+// Advance the current pattern by one step and show it
+void stepPatterns(void*) {
+  PROFILE_SCOPE(patternSection);
+  ledPatterns.render();
+  ledPatterns.commit();
+}
+
+void printPatternNames() {
+  Serial.println(ledPatterns.getPatternName());
+}
+
+// Advance to the next pattern and say why
+void nextPattern(const __FlashStringHelper* reason) {
+  PatternState currentPattern = ledPatterns.getCurrentPattern();
+  PatternState nextPattern = (PatternState)((currentPattern + 1) % PATTERN_COUNT);
+  ledPatterns.setPattern(nextPattern);
+  scheduler.setPeriod(patternTask, ledPatterns.getStepDuration());
   
-  // Save button state for next comparison
-  lastButtonState = reading;
+  Serial.print(reason);
+  printPatternNames();
 }
+#endif
 
-// Check if it's time for an automatic pattern change
-void checkAutoPatternChange() {
-  unsigned long currentTime = millis();
+// Handle button presses with debouncing (polled every buttonPollInterval)
+void handleButtonPress(void*) {
+  PROFILE_SCOPE(buttonSection);
   
-  // If enough time has passed since last pattern change
-  if (currentTime - lastPatternChangeTime >= patternChangeDuration) {
-    lastPatternChangeTime = currentTime;
-    
-    // Change to next pattern
-    PatternState currentPattern = ledPatterns.getCurrentPattern();
-    PatternState nextPattern = (PatternState)((currentPattern + 1) % PATTERN_COUNT);
-    ledPatterns.setPattern(nextPattern);
+  // A new press (debounced) changes the pattern
+  if (button.update() == DEBOUNCE_PRESSED) {
+    // Change to next pattern and display its name
+    nextPattern(F("Button pressed! Changed to pattern: "));
     
-    // Display the new pattern name
-    Serial.print(F("Auto-switching to pattern: "));
-    Serial.println(ledPatterns.getPatternName());
+    // Restart the automatic pattern change countdown
+    scheduler.reschedule(autoChangeTask, patternChangeDuration);
+  }
+}
+
+// Automatic pattern change - runs patternChangeDuration after the last change
+void autoChangePattern(void*) {
+  PROFILE_SCOPE(autoChangeSection);
+  nextPattern(F("Auto-switching to pattern: "));
+}
+
+// Serial commands: 'p' prints the scheduler state and loop profile,
+// 'r' clears the profile
+void handleCommands() {
+  while (Serial.available() > 0) {
+    char command = Serial.read();
+    if (command == 'p') {
+      Serial.print(F("Next task due in "));
+      Serial.print(nextDeadline);
+      Serial.print(F(" ms, late runs: "));
+      Serial.println(scheduler.lateCount());
+      if (LoopProfiler.isRunning()) {
+        LoopProfiler.report(Serial);
+      }
+    } else if (command == 'r' && LoopProfiler.isRunning()) {
+      LoopProfiler.reset();
+      Serial.println(F("Loop profile reset"));
+    }
   }
 }
@@ -1,4 +1,6 @@
 #include <Arduino.h>
+#include <IdleSleep.h>
+#include <TokenLog.h>
 
 // Pin definitions
 const byte LED_PIN = 13;          // Using byte saves memory over int
@@ -10,6 +12,7 @@ unsigned long startTime = 0;      // For tracking time since start
 
 // Performance tracking
 unsigned int cycleCount = 0;      // Counter for how many times the loop is run (cycles)
+                                  // (only a few per second: loop() sleeps between events)
 byte errorCode = 0;               // Error status code (0 = no error)
 
 // Function to check available RAM
@@ -28,6 +31,9 @@ void setup() {
   pinMode(LED_PIN, OUTPUT);
   pinMode(BUTTON_PIN, INPUT_PULLUP);
   
+  // Sleep between status lines; a button press wakes the CPU at once
+  IdleSleep.wakeOnPin(BUTTON_PIN);
+  
   // Record start time
   startTime = millis();
   
@@ -35,6 +41,10 @@ void setup() {
   Serial.print(F("Free RAM: "));
   Serial.print(freeRam());  // We'll implement this function
   Serial.println(F(" bytes"));
+  
+  // Status lines from here on are compact binary records
+  // (decode with tools/tokenlog/decode_log.py)
+  TokenLog.begin(Serial);
 }
 
 unsigned long lastSecondCheck = 0;
@@ -62,15 +72,25 @@ void loop() {
   // Every second, print status
   if (currentTime- lastSecondCheck >= 1000) {  // Check if we just crossed a second boundary
     lastSecondCheck = currentTime; // Update the timestamp
-    Serial.print(F("Uptime: "));
-    Serial.print(currentTime / 1000);  // Convert to seconds
-    Serial.print(F(" seconds, cycles: "));
-    Serial.println(cycleCount);
+    TLOG("Uptime: %lu seconds, cycles: %u", currentTime / 1000, cycleCount);
+    TLOG("Asleep: %lu ms, wakes pin/timer: %lu/%lu, pin wake latency: %u-%u us",
+         IdleSleep.millisAsleep(), IdleSleep.wakesByPin(), IdleSleep.wakesByTimer(),
+         IdleSleep.minWakeLatency(), IdleSleep.maxWakeLatency());
     
-    // Reset cycle counter
+    // Reset cycle counter and sleep statistics
     cycleCount = 0;
+    IdleSleep.resetStats();
   }
 
   // Track performance 
   cycleCount++;
+  
+  // Nothing else to do until the next status line or a button press.
+  // Idle sleep keeps Timer0 (millis) and the UART running. A held button
+  // makes no pin change to wake on, so stay awake while it is down: the
+  // next pass toggles again after the 300 ms delay, as it always has.
+  unsigned long sinceStatus = millis() - lastSecondCheck;
+  if (sinceStatus < 1000 && digitalRead(BUTTON_PIN) == HIGH) {
+    IdleSleep.sleepFor(1000 - sinceStatus);
+  }
 }
\ No newline at end of file
@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""
+simavr cycle benchmark runner
+
+Builds the [env:uno_bench] firmware (or the benchmark's "env") of every
+sketch listed in benchmarks.json, runs it in simavr through the avrbench harness and
+compares the cycles between CycleMarker points with the stored
+baselines in baselines/<name>.json.
+
+A marker whose mean or minimum cycle count grows by more than the
+threshold (default from benchmarks.json, in percent) fails the run with
+exit code 1. simavr is deterministic, so any change in the numbers comes
+from the firmware (or the inputs scripted in benchmarks.json).
+
+Usage:
+    python3 tools/avrbench/run_bench.py                  # build, run, compare
+    python3 tools/avrbench/run_bench.py --update         # accept current numbers
+    python3 tools/avrbench/run_bench.py --only button_debouncing --no-build
+
+A benchmark without a baseline fails: a slowdown must never pass
+unnoticed because its baseline went missing. Record baselines with
+--update (on a machine with simavr) and commit the files under
+baselines/.
+"""
+
+import argparse
+import json
+import subprocess
+import sys
+from pathlib import Path
+
+TOOL_DIR = Path(__file__).resolve().parent
+REPO_DIR = TOOL_DIR.parent.parent
+HARNESS = TOOL_DIR / ".pio" / "build" / "native" / "program"
+BASELINE_DIR = TOOL_DIR / "baselines"
+FIRMWARE_ENV = "uno_bench"
+METRICS = ("min", "mean")
+
+
+def firmware_path(project: Path, env: str) -> Path:
+    return project / ".pio" / "build" / env / "firmware.elf"
+
+
+def build(project: Path, env: str) -> Path:
+    subprocess.run(["pio", "run", "-d", str(project), "-e", env], check=True)
+    return firmware_path(project, env)
+
+
+def build_harness():
+    subprocess.run(["pio", "run", "-d", str(TOOL_DIR), "-e", "native"], check=True)
+
+
+def run_harness(firmware: Path, bench: dict) -> dict:
+    cmd = [str(HARNESS), str(firmware), "--seconds", str(bench.get("seconds", 2))]
+    for press in bench.get("press", []):
+        cmd += ["--press", press]
+    result = subprocess.run(cmd, check=True, capture_output=True, text=True)
+    return json.loads(result.stdout)
+
+
+def compare(bench: dict, result: dict, baseline: dict, threshold: float) -> bool:
+    """Print one table row per marker; returns False on a regression."""
+    ok = True
+    names = bench["markers"]
+    print(f"{bench['name']} ({result['cycles']} cycles simulated, "
+          f"marker overhead {result['marker_overhead']})")
+    print(f"  {'marker':<24}{'count':>8}{'min':>9}{'mean':>11}{'max':>9}  change")
+
+    for marker_id, name in names.items():
+        current = result["markers"].get(marker_id)
+        if current is None:
+            print(f"  {name:<24}  never reached")
+            ok = False
+            continue
+
+        change = ""
+        previous = baseline.get(marker_id) if baseline else None
+        if previous:
+            parts = []
+            for metric in METRICS:
+                old, new = previous[metric], current[metric]
+                delta = (new - old) * 100.0 / old if old else (100.0 if new else 0.0)
+                flag = ""
+                if delta > threshold:
+                    flag = " REGRESSION"
+                    ok = False
+                parts.append(f"{metric} {delta:+.1f}%{flag}")
+            change = ", ".join(parts)
+        else:
+            change = "new"
+
+        print(f"  {name:<24}{current['count']:>8}{current['min']:>9}"
+              f"{current['mean']:>11.1f}{current['max']:>9}  {change}")
+
+    if result.get("crashed"):
+        print("  firmware crashed in simavr")
+        ok = False
+    return ok
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--config", default=str(TOOL_DIR / "benchmarks.json"))
+    parser.add_argument("--only", action="append", help="run only this benchmark (repeatable)")
+    parser.add_argument("--threshold", type=float, help="allowed slowdown in percent")
+    parser.add_argument("--update", action="store_true", help="overwrite the baselines")
+    parser.add_argument("--no-build", action="store_true",
+                        help="use the firmware and harness already built")
+    args = parser.parse_args()
+
+    config = json.loads(Path(args.config).read_text())
+    threshold = args.threshold if args.threshold is not None else config["threshold_percent"]
+
+    if not args.no_build or not HARNESS.exists():
+        build_harness()
+
+    all_ok = True
+    for bench in config["benchmarks"]:
+        if args.only and bench["name"] not in args.only:
+            continue
+
+        project = REPO_DIR / bench["project"]
+        env = bench.get("env", FIRMWARE_ENV)
+        if args.no_build:
+            firmware = firmware_path(project, env)
+        else:
+            firmware = build(project, env)
+        result = run_harness(firmware, bench)
+
+        baseline_file = BASELINE_DIR / f"{bench['name']}.json"
+        baseline = None
+        if baseline_file.exists() and not args.update:
+            baseline = json.loads(baseline_file.read_text())
+
+        if not compare(bench, result, baseline, threshold):
+            all_ok = False
+
+        if args.update:
+            BASELINE_DIR.mkdir(exist_ok=True)
+            baseline_file.write_text(json.dumps(result["markers"], indent=2, sort_keys=True) + "\n")
+            print(f"  baseline written to {baseline_file.relative_to(REPO_DIR)}")
+        elif baseline is None:
+            print(f"  no baseline ({baseline_file.relative_to(REPO_DIR)}); "
+                  "record one with --update")
+            all_ok = False
+        print()
+
+    if not all_ok:
+        print(f"Cycle benchmarks FAILED (threshold {threshold}%)")
+        return 1
+    print("Cycle benchmarks passed")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,253 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <sim_avr.h>
+#include <sim_elf.h>
+#include <sim_io.h>
+#include <sim_time.h>
+#include <avr_ioport.h>
+
+/**
+ * avrbench - Cycle counts between CycleMarker points in simavr
+ *
+ * Loads an [env:uno_bench] firmware image into a simulated ATmega328P,
+ * runs it for a fixed simulated time and watches writes to GPIOR0:
+ * id (1-127) starts a marker, id | 0x80 ends it. For every marker it
+ * reports how many times it ran and the min/mean/max CPU cycles in
+ * between, as JSON on stdout. Marker 0 (CYCLE_MARK_CALIBRATE) measures
+ * the cost of the marker writes themselves, which is subtracted.
+ *
+ * Button activity can be scripted with --press, so debounce code sees
+ * real (bouncing) edges:
+ *
+ *   avrbench firmware.elf --seconds 3 --press D2,400,150,4
+ *
+ * presses PD2 every 400 ms for 150 ms, with 4 bounce toggles 0.5 ms
+ * apart at each edge. The pin idles high (pull-up, released button).
+ *
+ * Used by run_bench.py, which compares the results with the stored
+ * baselines.
+ */
+
+const avr_io_addr_t GPIOR0_ADDRESS = 0x3E;   // Data space address (I/O 0x1E)
+const uint8_t MARK_END_FLAG = 0x80;
+const uint8_t MARK_COUNT = 128;
+const uint32_t BOUNCE_SPACING_US = 500;
+
+struct MarkerStats {
+  uint64_t count;
+  uint64_t minCycles;
+  uint64_t maxCycles;
+  uint64_t totalCycles;
+  uint64_t startCycle;
+  bool open;
+};
+
+static MarkerStats markers[MARK_COUNT];
+static uint64_t unmatchedEnds = 0;
+
+// Scripted button: one event list per pin, replayed from a cycle timer
+struct PinEvent {
+  uint32_t timeUs;
+  uint8_t level;
+};
+
+struct PressScript {
+  avr_irq_t* irq;
+  std::vector<PinEvent> events;
+  size_t next;
+};
+
+static std::vector<PressScript*> scripts;
+
+static void onMarkerWrite(avr_t* avr, avr_io_addr_t, uint8_t value, void*) {
+  uint8_t id = value & ~MARK_END_FLAG;
+  MarkerStats& m = markers[id];
+
+  if (!(value & MARK_END_FLAG)) {
+    m.startCycle = avr->cycle;
+    m.open = true;
+    return;
+  }
+  if (!m.open) {
+    unmatchedEnds++;
+    return;
+  }
+
+  uint64_t elapsed = avr->cycle - m.startCycle;
+  m.open = false;
+  if (m.count == 0 || elapsed < m.minCycles) {
+    m.minCycles = elapsed;
+  }
+  if (elapsed > m.maxCycles) {
+    m.maxCycles = elapsed;
+  }
+  m.totalCycles += elapsed;
+  m.count++;
+}
+
+static avr_cycle_count_t onPressTimer(avr_t* avr, avr_cycle_count_t when, void* param) {
+  PressScript* script = (PressScript*)param;
+  uint64_t nowUs = avr_cycles_to_usec(avr, when);
+
+  while (script->next < script->events.size() &&
+         script->events[script->next].timeUs <= nowUs) {
+    avr_raise_irq(script->irq, script->events[script->next].level);
+    script->next++;
+  }
+  if (script->next >= script->events.size()) {
+    return 0;
+  }
+  return avr_usec_to_cycles(avr, script->events[script->next].timeUs);
+}
+
+// "D2,400,150,4": port, pin, period ms, hold ms, bounces per edge
+static bool parsePress(avr_t* avr, const char* spec, double seconds) {
+  char port;
+  unsigned pin, periodMs, holdMs, bounces;
+  if (sscanf(spec, "%c%u,%u,%u,%u", &port, &pin, &periodMs, &holdMs, &bounces) != 5 ||
+      pin > 7 || periodMs == 0 || holdMs >= periodMs) {
+    return false;
+  }
+
+  PressScript* script = new PressScript();
+  script->irq = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(port), pin);
+  script->next = 0;
+  if (script->irq == NULL) {
+    delete script;
+    return false;
+  }
+
+  uint64_t endUs = (uint64_t)(seconds * 1e6);
+  script->events.push_back({0, 1});
+  for (uint64_t pressUs = (uint64_t)periodMs * 1000; pressUs < endUs;
+       pressUs += (uint64_t)periodMs * 1000) {
+    uint64_t releaseUs = pressUs + (uint64_t)holdMs * 1000;
+    // Bounces alternate around the new level, then it settles
+    for (unsigned b = 0; b < bounces; b++) {
+      script->events.push_back({(uint32_t)(pressUs + b * BOUNCE_SPACING_US), (uint8_t)(b & 1)});
+    }
+    script->events.push_back({(uint32_t)(pressUs + bounces * BOUNCE_SPACING_US), 0});
+    for (unsigned b = 0; b < bounces; b++) {
+      script->events.push_back({(uint32_t)(releaseUs + b * BOUNCE_SPACING_US), (uint8_t)!(b & 1)});
+    }
+    script->events.push_back({(uint32_t)(releaseUs + bounces * BOUNCE_SPACING_US), 1});
+  }
+
+  avr_raise_irq(script->irq, 1);
+  script->next = 1;
+  if (script->events.size() > 1) {
+    avr_cycle_timer_register(avr, avr_usec_to_cycles(avr, script->events[1].timeUs),
+                             onPressTimer, script);
+  }
+  scripts.push_back(script);
+  return true;
+}
+
+static void usage() {
+  fprintf(stderr,
+          "usage: avrbench firmware.elf [--seconds S] [--mcu NAME] [--freq HZ]\n"
+          "                [--press PORTPIN,PERIOD_MS,HOLD_MS,BOUNCES]...\n");
+}
+
+int main(int argc, char** argv) {
+  const char* firmwarePath = NULL;
+  const char* mcu = "atmega328p";
+  uint32_t frequency = 16000000;
+  double seconds = 2.0;
+  std::vector<const char*> presses;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+      seconds = atof(argv[++i]);
+    } else if (!strcmp(argv[i], "--mcu") && i + 1 < argc) {
+      mcu = argv[++i];
+    } else if (!strcmp(argv[i], "--freq") && i + 1 < argc) {
+      frequency = strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "--press") && i + 1 < argc) {
+      presses.push_back(argv[++i]);
+    } else if (argv[i][0] != '-' && firmwarePath == NULL) {
+      firmwarePath = argv[i];
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  if (firmwarePath == NULL || seconds <= 0) {
+    usage();
+    return 2;
+  }
+
+  elf_firmware_t firmware;
+  memset(&firmware, 0, sizeof(firmware));
+  if (elf_read_firmware(firmwarePath, &firmware) != 0) {
+    fprintf(stderr, "avrbench: cannot read %s\n", firmwarePath);
+    return 2;
+  }
+  // Arduino images carry no .mmcu section
+  if (firmware.mmcu[0] == 0) {
+    snprintf(firmware.mmcu, sizeof(firmware.mmcu), "%s", mcu);
+  }
+  if (firmware.frequency == 0) {
+    firmware.frequency = frequency;
+  }
+
+  avr_t* avr = avr_make_mcu_by_name(firmware.mmcu);
+  if (avr == NULL) {
+    fprintf(stderr, "avrbench: unknown MCU %s\n", firmware.mmcu);
+    return 2;
+  }
+  avr_init(avr);
+  avr->log = LOG_ERROR;
+  avr_load_firmware(avr, &firmware);
+
+  avr_register_io_write(avr, GPIOR0_ADDRESS, onMarkerWrite, NULL);
+  for (const char* spec : presses) {
+    if (!parsePress(avr, spec, seconds)) {
+      fprintf(stderr, "avrbench: bad --press %s\n", spec);
+      return 2;
+    }
+  }
+
+  avr_cycle_count_t endCycle = avr_usec_to_cycles(avr, (uint64_t)(seconds * 1e6));
+  int state = cpu_Running;
+  while (avr->cycle < endCycle) {
+    state = avr_run(avr);
+    if (state == cpu_Done || state == cpu_Crashed) {
+      break;
+    }
+  }
+
+  // Cheapest calibration pair = cost of the marker writes themselves
+  uint64_t overhead = markers[0].count ? markers[0].minCycles : 0;
+
+  printf("{\n");
+  printf("  \"firmware\": \"%s\",\n", firmwarePath);
+  printf("  \"cycles\": %llu,\n", (unsigned long long)avr->cycle);
+  printf("  \"crashed\": %s,\n", state == cpu_Crashed ? "true" : "false");
+  printf("  \"marker_overhead\": %llu,\n", (unsigned long long)overhead);
+  printf("  \"unmatched_ends\": %llu,\n", (unsigned long long)unmatchedEnds);
+  printf("  \"markers\": {");
+  bool first = true;
+  for (unsigned id = 1; id < MARK_COUNT; id++) {
+    const MarkerStats& m = markers[id];
+    if (m.count == 0) {
+      continue;
+    }
+    uint64_t minCycles = m.minCycles > overhead ? m.minCycles - overhead : 0;
+    uint64_t maxCycles = m.maxCycles > overhead ? m.maxCycles - overhead : 0;
+    double mean = (double)m.totalCycles / m.count - overhead;
+    printf("%s\n    \"%u\": {\"count\": %llu, \"min\": %llu, \"mean\": %.2f, \"max\": %llu}",
+           first ? "" : ",", id, (unsigned long long)m.count,
+           (unsigned long long)minCycles, mean < 0 ? 0.0 : mean,
+           (unsigned long long)maxCycles);
+    first = false;
+  }
+  printf("\n  }\n}\n");
+
+  avr_terminate(avr);
+  return state == cpu_Crashed ? 1 : 0;
+}
@@ -0,0 +1,246 @@
+#!/usr/bin/env python3
+"""
+PatternVm assembler
+
+Turns pattern programs written in assembly (.pvasm) into PROGMEM byte
+arrays for the PatternVm library (src/libraries/PatternVm). Opcode
+numbers are read from the PatternOp enum in PatternVm.h, so the output
+always matches the interpreter it is compiled with.
+
+Source format, one instruction per line, ';' starts a comment:
+
+    program knight_rider       ; starts PROGRAM_KNIGHT_RIDER[]
+            only 0
+    top:    repeat leds-1      ; label, op and operand
+            wait 1
+            shl 1
+            next
+            ...
+            jump top
+    end                        ; PVM_END: the program starts again
+
+Operands are numbers (12, 0x55, 0b1010), labels (jump), `last` (only)
+and `leds-1` (repeat). repeat/next pairs are checked, as are jumps.
+
+Usage:
+    python3 tools/patternvm/pvasm.py patterns/BitPrograms.pvasm -o include/BitPrograms.h
+    python3 tools/patternvm/pvasm.py --list patterns/BitPrograms.pvasm
+"""
+
+import argparse
+import os
+import re
+import sys
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                      "..", "..", "src", "libraries", "PatternVm", "PatternVm.h")
+
+# Operand kind per op: None, "value" (0-255), "count" (1-255), "led",
+# "repeat" or "label"
+OPERANDS = {
+    "end": None,
+    "wait": "count",
+    "fill": "value",
+    "only": "led",
+    "and": "value",
+    "or": "value",
+    "xor": "value",
+    "shl": "count",
+    "shr": "count",
+    "rol": "count",
+    "ror": "count",
+    "inc": None,
+    "random": None,
+    "save": None,
+    "mask_saved": "value",
+    "repeat": "repeat",
+    "next": None,
+    "jump": "label",
+}
+
+MAX_DEPTH = 2
+MAX_PROGRAM = 256
+LAST_LED = 0xFF
+LEDS_MINUS_1 = 0
+
+LABEL = re.compile(r"^([A-Za-z_]\w*):\s*(.*)$")
+
+
+class AsmError(Exception):
+    pass
+
+
+def read_opcodes(header):
+    """Opcode numbers from the PatternOp enum, by mnemonic."""
+    with open(header, encoding="utf-8") as f:
+        text = f.read()
+    match = re.search(r"enum PatternOp\s*:\s*byte\s*\{(.*?)\};", text, re.S)
+    if not match:
+        raise SystemExit(f"pvasm: no PatternOp enum in {header}")
+    names = re.findall(r"^\s*PVM_(\w+)\s*,", match.group(1), re.M)
+    opcodes = {name.lower(): number for number, name in enumerate(names) if name != "OP_COUNT"}
+    if set(opcodes) != set(OPERANDS):
+        raise SystemExit(f"pvasm: {header} ops {sorted(opcodes)} do not match the assembler's")
+    return opcodes
+
+
+def parse_number(text):
+    try:
+        return int(text, 0)
+    except ValueError:
+        raise AsmError(f"bad number '{text}'")
+
+
+def operand_value(kind, text, labels):
+    if kind == "label":
+        if text not in labels:
+            raise AsmError(f"unknown label '{text}'")
+        return labels[text]
+    if kind == "led" and text == "last":
+        return LAST_LED
+    if kind == "repeat" and text == "leds-1":
+        return LEDS_MINUS_1
+    value = parse_number(text)
+    low = 1 if kind in ("count", "repeat") else 0
+    high = 254 if kind == "led" else 255
+    if not low <= value <= high:
+        raise AsmError(f"operand {value} out of range {low}-{high}")
+    return value
+
+
+def parse(path):
+    """Programs as (name, [(line, label, op, operand text)])."""
+    programs = []
+    current = None
+    with open(path, encoding="utf-8") as f:
+        for number, raw in enumerate(f, 1):
+            line = raw.split(";", 1)[0].strip()
+            if not line:
+                continue
+            where = f"{path}:{number}"
+            words = line.split()
+            if words[0] == "program":
+                if current is not None:
+                    raise AsmError(f"{where}: program '{current[0]}' has no 'end'")
+                if len(words) != 2:
+                    raise AsmError(f"{where}: expected 'program <name>'")
+                current = (words[1], [])
+                continue
+            if current is None:
+                raise AsmError(f"{where}: instruction outside a program")
+
+            label = None
+            match = LABEL.match(line)
+            if match:
+                label, line = match.group(1), match.group(2).strip()
+            words = line.split()
+            op = words[0].lower() if words else None
+            if op is not None and op not in OPERANDS:
+                raise AsmError(f"{where}: unknown op '{words[0]}'")
+            if op is not None and len(words) != (2 if OPERANDS[op] else 1):
+                raise AsmError(f"{where}: '{op}' takes {'one operand' if OPERANDS[op] else 'no operands'}")
+            current[1].append((where, label, op, words[1] if len(words) > 1 else None))
+            if op == "end":
+                programs.append(current)
+                current = None
+    if current is not None:
+        raise AsmError(f"{path}: program '{current[0]}' has no 'end'")
+    return programs
+
+
+def assemble(lines, opcodes):
+    """Bytes and a listing [(address, bytes, source)] of one program."""
+    # Pass 1: addresses
+    labels = {}
+    address = 0
+    for where, label, op, _operand in lines:
+        if label is not None:
+            if label in labels:
+                raise AsmError(f"{where}: label '{label}' defined twice")
+            labels[label] = address
+        if op is not None:
+            address += 2 if OPERANDS[op] else 1
+    if address > MAX_PROGRAM:
+        raise AsmError(f"{lines[0][0]}: program is {address} bytes, the limit is {MAX_PROGRAM}")
+
+    # Pass 2: code
+    code = []
+    listing = []
+    depth = 0
+    for where, label, op, operand in lines:
+        if op is None:
+            continue
+        if op == "repeat":
+            depth += 1
+            if depth > MAX_DEPTH:
+                raise AsmError(f"{where}: repeat blocks nest at most {MAX_DEPTH} deep")
+        elif op == "next":
+            if depth == 0:
+                raise AsmError(f"{where}: 'next' without 'repeat'")
+            depth -= 1
+        start = len(code)
+        code.append(opcodes[op])
+        if OPERANDS[op]:
+            try:
+                code.append(operand_value(OPERANDS[op], operand, labels))
+            except AsmError as error:
+                raise AsmError(f"{where}: {error}")
+        text = f"{(label + ':') if label else '':8}{op}{(' ' + operand) if operand else ''}"
+        listing.append((start, code[start:], text))
+    if depth != 0:
+        raise AsmError(f"{lines[-1][0]}: 'repeat' without 'next'")
+    return code, listing
+
+
+def emit_header(source, programs, out):
+    out.write("// Generated by tools/patternvm/pvasm.py from "
+              f"{os.path.basename(source)} - do not edit\n")
+    # BitPrograms.h -> BIT_PROGRAMS_H
+    base = re.sub(r"(?<=[a-z0-9])(?=[A-Z])", "_", os.path.basename(out.name))
+    guard = re.sub(r"\W", "_", base).upper()
+    out.write(f"#ifndef {guard}\n#define {guard}\n\n#include <PatternVm.h>\n")
+    for name, code, listing in programs:
+        out.write(f"\n// {name}: {len(code)} bytes\n")
+        out.write(f"const byte PROGRAM_{name.upper()}[] PROGMEM = {{\n")
+        for index, (_address, chunk, text) in enumerate(listing):
+            values = ", ".join(f"0x{b:02x}" for b in chunk)
+            comma = "," if index + 1 < len(listing) else ""
+            out.write(f"  {values + comma:12}  // {text}\n")
+        out.write("};\n")
+    out.write("\n#endif\n")
+
+
+def print_listing(programs):
+    for name, code, listing in programs:
+        print(f"{name} ({len(code)} bytes)")
+        for address, chunk, text in listing:
+            values = " ".join(f"{b:02x}" for b in chunk)
+            print(f"  {address:3d}  {values:6}  {text}")
+        print()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", help=".pvasm file")
+    parser.add_argument("-o", "--output", help="header to write")
+    parser.add_argument("--list", action="store_true", help="print an address listing")
+    parser.add_argument("--header", default=HEADER, help="PatternVm.h to take the opcodes from")
+    args = parser.parse_args()
+
+    opcodes = read_opcodes(args.header)
+    try:
+        programs = [(name, *assemble(lines, opcodes)) for name, lines in parse(args.source)]
+    except AsmError as error:
+        raise SystemExit(f"pvasm: {error}")
+
+    if args.list:
+        print_listing(programs)
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as out:
+            emit_header(args.source, programs, out)
+        total = sum(len(code) for _name, code, _listing in programs)
+        print(f"pvasm: {len(programs)} programs, {total} bytes -> {args.output}", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
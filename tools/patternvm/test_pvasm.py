@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""
+pvasm tests
+
+Checks that the assembler rejects broken programs with a message that
+names the line, and that the committed bit_manipulation programs still
+assemble to the header next to them.
+
+Run with:
+    python3 tools/patternvm/test_pvasm.py
+"""
+
+import os
+import tempfile
+import unittest
+
+import pvasm
+
+REPO_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..")
+BIT_PROJECT = os.path.join(REPO_DIR, "src", "phase1_setup", "cpp_fundamentals_arduino",
+                           "bit_manipulation")
+
+
+class AssemblerTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.opcodes = pvasm.read_opcodes(pvasm.HEADER)
+
+    def assemble(self, source):
+        """Bytes of every program in `source`."""
+        with tempfile.NamedTemporaryFile("w", suffix=".pvasm", delete=False) as f:
+            f.write(source)
+        try:
+            return [pvasm.assemble(lines, self.opcodes)[0] for _name, lines in pvasm.parse(f.name)]
+        finally:
+            os.unlink(f.name)
+
+    def assertRejected(self, source, message, line):
+        with self.assertRaises(pvasm.AsmError) as caught:
+            self.assemble(source)
+        self.assertIn(message, str(caught.exception))
+        self.assertIn(f".pvasm:{line}:", str(caught.exception))
+
+    def test_valid_program(self):
+        code, = self.assemble("program p\n"
+                              "        only 0\n"
+                              "top:    repeat leds-1\n"
+                              "        wait 1\n"
+                              "        shl 1\n"
+                              "        next\n"
+                              "        jump top\n"
+                              "end\n")
+        op = self.opcodes
+        self.assertEqual(code, [op["only"], 0, op["repeat"], 0, op["wait"], 1,
+                                op["shl"], 1, op["next"], op["jump"], 2, op["end"]])
+
+    def test_unknown_label(self):
+        self.assertRejected("program p\n"
+                            "top:    wait 1\n"
+                            "        jump tpo\n"
+                            "end\n", "unknown label 'tpo'", 3)
+
+    def test_label_defined_twice(self):
+        self.assertRejected("program p\n"
+                            "top:    wait 1\n"
+                            "top:    wait 2\n"
+                            "end\n", "label 'top' defined twice", 3)
+
+    def test_operand_out_of_range(self):
+        cases = [
+            ("fill 256", "operand 256 out of range 0-255"),
+            ("wait 0", "operand 0 out of range 1-255"),
+            ("shl 300", "operand 300 out of range 1-255"),
+            ("only 255", "operand 255 out of range 0-254"),
+            ("repeat -1", "operand -1 out of range 1-255"),
+        ]
+        for text, message in cases:
+            with self.subTest(text):
+                self.assertRejected(f"program p\n        {text}\nend\n", message, 2)
+
+    def test_bad_number(self):
+        self.assertRejected("program p\n        fill 0x5g\nend\n", "bad number '0x5g'", 2)
+
+    def test_next_without_repeat(self):
+        self.assertRejected("program p\n"
+                            "        wait 1\n"
+                            "        next\n"
+                            "end\n", "'next' without 'repeat'", 3)
+
+    def test_repeat_without_next(self):
+        self.assertRejected("program p\n"
+                            "        repeat 3\n"
+                            "        wait 1\n"
+                            "end\n", "'repeat' without 'next'", 4)
+
+    def test_extra_next_after_balanced_block(self):
+        self.assertRejected("program p\n"
+                            "        repeat 3\n"
+                            "        wait 1\n"
+                            "        next\n"
+                            "        next\n"
+                            "end\n", "'next' without 'repeat'", 5)
+
+    def test_nesting_at_the_limit(self):
+        code, = self.assemble("program p\n"
+                              "        repeat 2\n"
+                              "        repeat 3\n"
+                              "        wait 1\n"
+                              "        next\n"
+                              "        next\n"
+                              "end\n")
+        self.assertEqual(len(code), 9)
+
+    def test_nesting_too_deep(self):
+        self.assertRejected("program p\n"
+                            "        repeat 2\n"
+                            "        repeat 2\n"
+                            "        repeat 2\n"
+                            "        wait 1\n"
+                            "        next\n"
+                            "        next\n"
+                            "        next\n"
+                            "end\n", f"nest at most {pvasm.MAX_DEPTH} deep", 4)
+
+    def test_unknown_op(self):
+        self.assertRejected("program p\n        blink 1\nend\n", "unknown op 'blink'", 2)
+
+    def test_missing_end(self):
+        with self.assertRaises(pvasm.AsmError) as caught:
+            self.assemble("program p\n        wait 1\n")
+        self.assertIn("program 'p' has no 'end'", str(caught.exception))
+
+    def test_bit_programs_match_header(self):
+        source = os.path.join(BIT_PROJECT, "patterns", "BitPrograms.pvasm")
+        header = os.path.join(BIT_PROJECT, "include", "BitPrograms.h")
+        programs = [(name, *pvasm.assemble(lines, self.opcodes))
+                    for name, lines in pvasm.parse(source)]
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "BitPrograms.h")
+            with open(path, "w", encoding="utf-8") as out:
+                pvasm.emit_header(source, programs, out)
+            with open(path, encoding="utf-8") as generated, open(header, encoding="utf-8") as committed:
+                self.assertEqual(generated.read(), committed.read(),
+                                 "include/BitPrograms.h is out of date; re-run pvasm")
+
+
+if __name__ == "__main__":
+    unittest.main()
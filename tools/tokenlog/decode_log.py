@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+"""
+TokenLog host decoder
+
+Reads the byte stream from a board (serial port or a captured file),
+finds the COBS-framed TokenLog records, checks their CRC and prints the
+rebuilt text with a running timestamp. Anything that is not a valid
+record (plain Serial.print text) is passed through unchanged.
+
+Usage:
+    python3 tools/tokenlog/decode_log.py --db .pio/build/uno/tokens.csv --port /dev/ttyACM0
+    python3 tools/tokenlog/decode_log.py --db tokens.csv --file capture.bin
+"""
+
+import argparse
+import re
+import sys
+
+from tokenlog_common import load_db
+
+SPEC = re.compile(r"%(%|[-+ #0]*\d*(?:\.\d+)?(?:hh|h|ll|l)?([diuxXcs]))")
+
+
+def cobs_decode(data: bytes) -> bytes:
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data) + 1:
+            raise ValueError("bad COBS code")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def crc8(data: bytes) -> int:
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+class Reader:
+    def __init__(self, data: bytes):
+        self.data = data
+        self.pos = 0
+
+    def varint(self) -> int:
+        value = 0
+        shift = 0
+        while True:
+            if self.pos >= len(self.data):
+                raise ValueError("record truncated")
+            b = self.data[self.pos]
+            self.pos += 1
+            value |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                return value
+
+    def signed(self) -> int:
+        raw = self.varint()
+        return (raw >> 1) ^ -(raw & 1)
+
+    def string(self) -> str:
+        length = self.data[self.pos]
+        self.pos += 1
+        text = self.data[self.pos:self.pos + length]
+        self.pos += length
+        return text.decode("latin-1")
+
+
+def render(fmt: str, reader: Reader) -> str:
+    def substitute(match):
+        if match.group(1) == "%":
+            return "%"
+        conv = match.group(2)
+        spec = re.sub(r"(hh|h|ll|l)", "", match.group(0))
+        if conv == "s":
+            return spec % reader.string()
+        value = reader.signed()
+        if conv in "uxX" and value < 0:
+            # Unsigned arguments travel as signed 32-bit (64-bit for ll, and
+            # for long in host builds: anything below the 32-bit range)
+            wide = "ll" in match.group(0) or value < -(1 << 31)
+            value &= 0xFFFFFFFFFFFFFFFF if wide else 0xFFFFFFFF
+        if conv == "c":
+            return chr(value & 0xFF)
+        return spec.replace("i", "d") % value
+    return SPEC.sub(substitute, fmt)
+
+
+class Decoder:
+    def __init__(self, table):
+        self.table = table
+        self.clock_ms = 0
+        self.records = 0
+        self.record_bytes = 0
+        self.text_bytes = 0
+
+    def frame(self, chunk: bytes) -> str:
+        """Decode one 0x00-delimited chunk into printable text."""
+        try:
+            record = cobs_decode(chunk)
+            if len(record) < 4 or crc8(record[:-1]) != record[-1]:
+                raise ValueError("CRC mismatch")
+            token = record[0] | (record[1] << 8)
+            reader = Reader(record[2:-1])
+            self.clock_ms += reader.varint()
+            fmt = self.table.get(token)
+            if fmt is None:
+                text = f"<unknown token 0x{token:04x}>"
+            else:
+                text = render(fmt, reader)
+            self.records += 1
+            self.record_bytes += len(chunk) + 1
+            return f"[{self.clock_ms / 1000:10.3f}] {text}\n"
+        except (ValueError, IndexError, TypeError):
+            # Not a record - plain text printed by the sketch
+            self.text_bytes += len(chunk)
+            return chunk.decode("latin-1")
+
+    def feed(self, data: bytes, pending: bytearray, out):
+        pending += data
+        while True:
+            end = pending.find(0)
+            if end < 0:
+                break
+            chunk = bytes(pending[:end])
+            del pending[:end + 1]
+            if chunk:
+                out.write(self.frame(chunk))
+        out.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--db", required=True, help="tokens.csv written by extract_tokens.py")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="serial port to read")
+    source.add_argument("--file", help="captured byte stream to read")
+    parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    decoder = Decoder(load_db(args.db))
+    pending = bytearray()
+
+    if args.file:
+        with open(args.file, "rb") as f:
+            decoder.feed(f.read() + b"\0", pending, sys.stdout)
+        print(f"\n{decoder.records} records in {decoder.record_bytes} bytes, "
+              f"{decoder.text_bytes} bytes of plain text", file=sys.stderr)
+        return
+
+    import serial  # pyserial, only needed for live capture
+    with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+        try:
+            while True:
+                decoder.feed(port.read(256), pending, sys.stdout)
+        except KeyboardInterrupt:
+            pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""
+TokenLog format string extractor
+
+Finds every TLOG("format", ...) call in the given source directories,
+computes its message ID and writes the ID -> format table used by
+decode_log.py. Fails if two different formats hash to the same ID.
+
+Usage:
+    python3 tools/tokenlog/extract_tokens.py -o tokens.csv src include ../../libraries
+"""
+
+import argparse
+import csv
+import os
+import re
+import sys
+
+from tokenlog_common import token_hash, unescape_c
+
+SOURCE_EXTENSIONS = (".c", ".cpp", ".h", ".hpp", ".ino")
+
+# TLOG( followed by one or more adjacent string literals
+TLOG_CALL = re.compile(r'\bTLOG\s*\(\s*((?:"(?:[^"\\\n]|\\.)*"\s*)+)')
+STRING_PART = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+
+
+def source_files(paths):
+    for root_path in paths:
+        if os.path.isfile(root_path):
+            yield root_path
+            continue
+        for root, _dirs, files in os.walk(root_path):
+            if ".pio" in root.split(os.sep):
+                continue
+            for name in sorted(files):
+                if name.endswith(SOURCE_EXTENSIONS):
+                    yield os.path.join(root, name)
+
+
+def find_tokens(paths):
+    for path in source_files(paths):
+        with open(path, encoding="utf-8", errors="replace") as f:
+            text = f.read()
+        for match in TLOG_CALL.finditer(text):
+            fmt = "".join(unescape_c(p) for p in STRING_PART.findall(match.group(1)))
+            line = text.count("\n", 0, match.start()) + 1
+            yield fmt, f"{path}:{line}"
+
+
+def build_table(paths):
+    table = {}
+    for fmt, where in find_tokens(paths):
+        token = token_hash(fmt.encode("utf-8"))
+        if token in table and table[token][0] != fmt:
+            raise SystemExit(
+                f"TokenLog ID collision 0x{token:04x}: {table[token][0]!r} ({table[token][1]}) "
+                f"and {fmt!r} ({where}) - reword one of them")
+        table.setdefault(token, (fmt, where))
+    return table
+
+
+def write_table(table, output):
+    with open(output, "w", newline="", encoding="utf-8") as f:
+        writer = csv.writer(f)
+        writer.writerow(["id", "format", "location"])
+        for token in sorted(table):
+            fmt, where = table[token]
+            writer.writerow([f"{token:04x}", fmt, where])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-o", "--output", default="tokens.csv", help="token table to write")
+    parser.add_argument("paths", nargs="+", help="source files or directories to scan")
+    args = parser.parse_args()
+
+    table = build_table(args.paths)
+    write_table(table, args.output)
+    print(f"TokenLog: {len(table)} format strings -> {args.output}", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,35 @@
+"""
+PlatformIO pre-build script: regenerate the TokenLog table on every build
+
+Add to a project's platformio.ini:
+    extra_scripts = pre:<path to>/tools/tokenlog/pio_tokens.py
+
+Scans the project's src/, include/ and lib_extra_dirs and writes
+tokens.csv next to the firmware in .pio/build/<env>/.
+"""
+
+import os
+import sys
+
+Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+
+project_dir = env.subst("$PROJECT_DIR")  # noqa: F821
+
+# SCons scripts have no __file__: find this directory from extra_scripts
+for script in env.GetProjectOption("extra_scripts", []):  # noqa: F821
+    script_path = script.split(":", 1)[-1]
+    if script_path.endswith("pio_tokens.py"):
+        sys.path.insert(0, os.path.dirname(os.path.join(project_dir, script_path)))
+
+from extract_tokens import build_table, write_table  # noqa: E402
+
+scan = [env.subst("$PROJECT_SRC_DIR"), env.subst("$PROJECT_INCLUDE_DIR")]  # noqa: F821
+for lib_dir in env.GetProjectOption("lib_extra_dirs", []):  # noqa: F821
+    scan.append(os.path.normpath(os.path.join(project_dir, lib_dir)))
+
+build_dir = env.subst("$BUILD_DIR")  # noqa: F821
+os.makedirs(build_dir, exist_ok=True)
+output = os.path.join(build_dir, "tokens.csv")
+table = build_table([p for p in scan if os.path.isdir(p)])
+write_table(table, output)
+print(f"TokenLog: {len(table)} format strings -> {output}")
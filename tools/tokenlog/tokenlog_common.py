@@ -0,0 +1,51 @@
+"""
+Shared helpers for the TokenLog tools: the message ID hash (must match
+tokenHash() in src/libraries/TokenLog/TokenLog.h) and the token database.
+"""
+
+import csv
+import re
+
+FNV_OFFSET = 2166136261
+FNV_PRIME = 16777619
+
+
+def token_hash(text: bytes) -> int:
+    """32-bit FNV-1a folded to 16 bits, same as the firmware."""
+    h = FNV_OFFSET
+    for b in text:
+        h = ((h ^ b) * FNV_PRIME) & 0xFFFFFFFF
+    return ((h >> 16) ^ (h & 0xFFFF)) & 0xFFFF
+
+
+_ESCAPES = {"n": "\n", "t": "\t", "r": "\r", "\\": "\\", '"': '"', "'": "'", "0": "\0"}
+
+
+def unescape_c(literal: str) -> str:
+    """Turn the body of a C string literal into its actual characters."""
+    out = []
+    i = 0
+    while i < len(literal):
+        c = literal[i]
+        if c == "\\" and i + 1 < len(literal):
+            nxt = literal[i + 1]
+            if nxt == "x":
+                m = re.match(r"[0-9a-fA-F]+", literal[i + 2:])
+                out.append(chr(int(m.group(0), 16)))
+                i += 2 + len(m.group(0))
+                continue
+            out.append(_ESCAPES.get(nxt, nxt))
+            i += 2
+            continue
+        out.append(c)
+        i += 1
+    return "".join(out)
+
+
+def load_db(path):
+    """Read tokens.csv into {id: format}."""
+    table = {}
+    with open(path, newline="", encoding="utf-8") as f:
+        for row in csv.DictReader(f):
+            table[int(row["id"], 16)] = row["format"]
+    return table
@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""
+Wave table generator for src/libraries/WaveTable/WaveTable.cpp
+
+Prints the PROGMEM lookup tables used by the WaveTable library so they
+can be pasted back into WaveTable.cpp if the curves ever need changing.
+
+Usage:
+    python3 tools/wavetable/gen_wavetables.py > tables.txt
+"""
+
+import math
+
+TABLE_SIZE = 256
+GAMMA = 2.2
+
+
+def sine8():
+    # Full sine period scaled to 0-255 (midpoint 127.5)
+    return [min(255, max(0, round(127.5 + 127.5 * math.sin(2 * math.pi * i / TABLE_SIZE))))
+            for i in range(TABLE_SIZE)]
+
+
+def sine16():
+    # Full sine period scaled to 0-65535 (midpoint 32767.5)
+    return [min(65535, max(0, round(32767.5 + 32767.5 * math.sin(2 * math.pi * i / TABLE_SIZE))))
+            for i in range(TABLE_SIZE)]
+
+
+def triangle8():
+    # Ramp up over the first half of the period, down over the second
+    return [i * 2 if i < 128 else (255 - i) * 2 + 1 for i in range(TABLE_SIZE)]
+
+
+def gamma8():
+    # Perceptual brightness correction for LEDs driven by PWM
+    return [round(255 * (i / 255) ** GAMMA) for i in range(TABLE_SIZE)]
+
+
+def emit(name, ctype, values, per_line, width):
+    print(f"const {ctype} {name}[WAVE_TABLE_SIZE] PROGMEM = {{")
+    for start in range(0, len(values), per_line):
+        chunk = values[start:start + per_line]
+        line = ", ".join(f"{v:{width}d}" for v in chunk)
+        comma = "," if start + per_line < len(values) else ""
+        print(f"  {line}{comma}")
+    print("};")
+    print()
+
+
+if __name__ == "__main__":
+    emit("WAVE_SINE8", "uint8_t", sine8(), 16, 3)
+    emit("WAVE_SINE16", "uint16_t", sine16(), 8, 5)
+    emit("WAVE_TRIANGLE8", "uint8_t", triangle8(), 16, 3)
+    emit("WAVE_GAMMA8", "uint8_t", gamma8(), 16, 3)
@@ -0,0 +1,97 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+
+#include <WaveTable.h>
+
+/**
+ * Fade Pattern Benchmark (host)
+ *
+ * Compares the cost per LED of the original LedPatterns::runFadePattern()
+ * math (float divide, multiply and sin()) against the WaveTable phase
+ * accumulator version.
+ *
+ * On x86 the time stamp counter gives cycles directly; elsewhere the
+ * result is reported in nanoseconds. Host numbers only show the ratio -
+ * on the ATmega328P the float path is far more expensive because sin()
+ * is done in software.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+static inline uint64_t benchNow() { return __rdtsc(); }
+#else
+#define BENCH_UNIT "ns"
+static inline uint64_t benchNow() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+const uint8_t LED_COUNT = 16;
+const uint32_t STEPS = 200000;
+
+// Written by both loops so the compiler cannot remove the work
+volatile uint8_t sink[LED_COUNT];
+
+// Original per-step float math from LedPatterns::runFadePattern()
+static void runFloatFade(uint8_t patternStep) {
+  uint8_t angle = patternStep % 256;
+  for (uint8_t i = 0; i < LED_COUNT; i++) {
+    uint8_t ledAngle = (angle + (i * (255 / LED_COUNT))) % 256;
+    float radians = (ledAngle / 255.0) * 2 * M_PI;
+    sink[i] = (sin(radians) + 1) * 127;
+  }
+}
+
+// Wave table version: phase offsets are computed once up front
+static uint16_t fadePhase[LED_COUNT];
+
+static void runTableFade(WaveShape shape, bool gammaCorrect) {
+  for (uint8_t i = 0; i < LED_COUNT; i++) {
+    uint8_t level = waveSample8(shape, fadePhase[i]);
+    if (gammaCorrect) {
+      level = gamma8(level);
+    }
+    fadePhase[i] += WAVE_PHASE_ONE_STEP;
+    sink[i] = level;
+  }
+}
+
+static double perLed(uint64_t elapsed) {
+  return (double)elapsed / ((double)STEPS * LED_COUNT);
+}
+
+int main() {
+  for (uint8_t i = 0; i < LED_COUNT; i++) {
+    fadePhase[i] = wavePhaseOffset(i, LED_COUNT);
+  }
+
+  uint64_t start = benchNow();
+  for (uint32_t step = 0; step < STEPS; step++) {
+    runFloatFade((uint8_t)step);
+  }
+  double floatCost = perLed(benchNow() - start);
+
+  start = benchNow();
+  for (uint32_t step = 0; step < STEPS; step++) {
+    runTableFade(WAVE_SINE, false);
+  }
+  double tableCost = perLed(benchNow() - start);
+
+  start = benchNow();
+  for (uint32_t step = 0; step < STEPS; step++) {
+    runTableFade(WAVE_SINE, true);
+  }
+  double gammaCost = perLed(benchNow() - start);
+
+  printf("Fade pattern cost per LED (%u LEDs, %lu steps)\n",
+         (unsigned)LED_COUNT, (unsigned long)STEPS);
+  printf("  float sin():        %8.2f %s\n", floatCost, BENCH_UNIT);
+  printf("  sine table:         %8.2f %s\n", tableCost, BENCH_UNIT);
+  printf("  sine table + gamma: %8.2f %s\n", gammaCost, BENCH_UNIT);
+  printf("  speedup (table):    %8.1fx\n", floatCost / tableCost);
+  return 0;
+}